@@ -39,6 +39,79 @@ extern char **environ;
 #  define _PAPPL_LOOKUP_STRING(bit,strings) _papplLookupString(bit, sizeof(strings) / sizeof(strings[0]), strings)
 #  define _PAPPL_LOOKUP_VALUE(keyword,strings) _papplLookupValue(keyword, sizeof(strings) / sizeof(strings[0]), strings)
 
+// Requested attribute names and IDs, which must be sorted by name...
+#  define _PAPPL_ATTRS \
+  _PAPPL_ATTR(COPIES_SUPPORTED, "copies-supported")                                       \
+  _PAPPL_ATTR(DATE_TIME_AT_COMPLETED, "date-time-at-completed")                           \
+  _PAPPL_ATTR(DATE_TIME_AT_CREATION, "date-time-at-creation")                             \
+  _PAPPL_ATTR(DATE_TIME_AT_PROCESSING, "date-time-at-processing")                         \
+  _PAPPL_ATTR(DOCUMENT_FORMAT, "document-format")                                         \
+  _PAPPL_ATTR(JOB_ID, "job-id")                                                           \
+  _PAPPL_ATTR(JOB_IMPRESSIONS, "job-impressions")                                         \
+  _PAPPL_ATTR(JOB_IMPRESSIONS_COMPLETED, "job-impressions-completed")                     \
+  _PAPPL_ATTR(JOB_NAME, "job-name")                                                       \
+  _PAPPL_ATTR(JOB_ORIGINATING_USER_NAME, "job-originating-user-name")                     \
+  _PAPPL_ATTR(JOB_PRINTER_UP_TIME, "job-printer-up-time")                                 \
+  _PAPPL_ATTR(JOB_PRINTER_URI, "job-printer-uri")                                         \
+  _PAPPL_ATTR(JOB_STATE, "job-state")                                                     \
+  _PAPPL_ATTR(JOB_STATE_MESSAGE, "job-state-message")                                     \
+  _PAPPL_ATTR(JOB_STATE_REASONS, "job-state-reasons")                                     \
+  _PAPPL_ATTR(JOB_URI, "job-uri")                                                         \
+  _PAPPL_ATTR(JOB_UUID, "job-uuid")                                                       \
+  _PAPPL_ATTR(MEDIA_COL_DATABASE, "media-col-database")                                   \
+  _PAPPL_ATTR(PRINTER_CURRENT_TIME, "printer-current-time")                               \
+  _PAPPL_ATTR(PRINTER_DNS_SD_NAME, "printer-dns-sd-name")                                 \
+  _PAPPL_ATTR(PRINTER_FIRMWARE_NAME, "printer-firmware-name")                             \
+  _PAPPL_ATTR(PRINTER_FIRMWARE_PATCHES, "printer-firmware-patches")                       \
+  _PAPPL_ATTR(PRINTER_FIRMWARE_STRING_VERSION, "printer-firmware-string-version")         \
+  _PAPPL_ATTR(PRINTER_FIRMWARE_VERSION, "printer-firmware-version")                       \
+  _PAPPL_ATTR(PRINTER_ICONS, "printer-icons")                                             \
+  _PAPPL_ATTR(PRINTER_IMPRESSIONS_COMPLETED, "printer-impressions-completed")             \
+  _PAPPL_ATTR(PRINTER_IS_ACCEPTING_JOBS, "printer-is-accepting-jobs")                     \
+  _PAPPL_ATTR(PRINTER_MORE_INFO, "printer-more-info")                                     \
+  _PAPPL_ATTR(PRINTER_STATE, "printer-state")                                             \
+  _PAPPL_ATTR(PRINTER_STATE_CHANGE_DATE_TIME, "printer-state-change-date-time")           \
+  _PAPPL_ATTR(PRINTER_STATE_CHANGE_TIME, "printer-state-change-time")                     \
+  _PAPPL_ATTR(PRINTER_STATE_MESSAGE, "printer-state-message")                             \
+  _PAPPL_ATTR(PRINTER_STATE_REASONS, "printer-state-reasons")                             \
+  _PAPPL_ATTR(PRINTER_STRINGS_LANGUAGES_SUPPORTED, "printer-strings-languages-supported") \
+  _PAPPL_ATTR(PRINTER_STRINGS_URI, "printer-strings-uri")                                 \
+  _PAPPL_ATTR(PRINTER_SUPPLY_INFO_URI, "printer-supply-info-uri")                         \
+  _PAPPL_ATTR(PRINTER_UP_TIME, "printer-up-time")                                         \
+  _PAPPL_ATTR(PRINTER_URI_SUPPORTED, "printer-uri-supported")                             \
+  _PAPPL_ATTR(PRINTER_WIFI_SSID, "printer-wifi-ssid")                                     \
+  _PAPPL_ATTR(PRINTER_WIFI_STATE, "printer-wifi-state")                                   \
+  _PAPPL_ATTR(PRINTER_XRI_SUPPORTED, "printer-xri-supported")                             \
+  _PAPPL_ATTR(QUEUED_JOB_COUNT, "queued-job-count")                                       \
+  _PAPPL_ATTR(SYSTEM_CONFIG_CHANGE_DATE_TIME, "system-config-change-date-time")           \
+  _PAPPL_ATTR(SYSTEM_CONFIG_CHANGE_TIME, "system-config-change-time")                     \
+  _PAPPL_ATTR(SYSTEM_CONFIGURED_PRINTERS, "system-configured-printers")                   \
+  _PAPPL_ATTR(SYSTEM_CONTACT_COL, "system-contact-col")                                   \
+  _PAPPL_ATTR(SYSTEM_CURRENT_TIME, "system-current-time")                                 \
+  _PAPPL_ATTR(SYSTEM_DEFAULT_PRINTER_ID, "system-default-printer-id")                     \
+  _PAPPL_ATTR(SYSTEM_FIRMWARE_NAME, "system-firmware-name")                               \
+  _PAPPL_ATTR(SYSTEM_FIRMWARE_PATCHES, "system-firmware-patches")                         \
+  _PAPPL_ATTR(SYSTEM_FIRMWARE_STRING_VERSION, "system-firmware-string-version")           \
+  _PAPPL_ATTR(SYSTEM_FIRMWARE_VERSION, "system-firmware-version")                         \
+  _PAPPL_ATTR(SYSTEM_GEO_LOCATION, "system-geo-location")                                 \
+  _PAPPL_ATTR(SYSTEM_LOCATION, "system-location")                                         \
+  _PAPPL_ATTR(SYSTEM_NAME, "system-name")                                                 \
+  _PAPPL_ATTR(SYSTEM_ORGANIZATION, "system-organization")                                 \
+  _PAPPL_ATTR(SYSTEM_ORGANIZATIONAL_UNIT, "system-organizational-unit")                   \
+  _PAPPL_ATTR(SYSTEM_STATE, "system-state")                                               \
+  _PAPPL_ATTR(SYSTEM_STATE_CHANGE_DATE_TIME, "system-state-change-date-time")             \
+  _PAPPL_ATTR(SYSTEM_STATE_CHANGE_TIME, "system-state-change-time")                       \
+  _PAPPL_ATTR(SYSTEM_STATE_REASONS, "system-state-reasons")                               \
+  _PAPPL_ATTR(SYSTEM_UP_TIME, "system-up-time")                                           \
+  _PAPPL_ATTR(SYSTEM_UUID, "system-uuid")                                                 \
+  _PAPPL_ATTR(SYSTEM_XRI_SUPPORTED, "system-xri-supported")                               \
+  _PAPPL_ATTR(TIME_AT_COMPLETED, "time-at-completed")                                     \
+  _PAPPL_ATTR(TIME_AT_CREATION, "time-at-creation")                                       \
+  _PAPPL_ATTR(TIME_AT_PROCESSING, "time-at-processing")                                   \
+  _PAPPL_ATTR(URI_AUTHENTICATION_SUPPORTED, "uri-authentication-supported")
+
+#  define _PAPPL_REQUESTED(ra,id) (!(ra) || ((ra)->ids[(id) / 8] & (1 << ((id) & 7))))
+
 #  ifndef HAVE_STRLCPY
 #    define strlcpy(dst,src,dstsize) _pappl_strlcpy(dst,src,dstsize)
 #  endif // !HAVE_STRLCPY
@@ -48,9 +121,24 @@ extern char **environ;
 // Types and structures...
 //
 
+typedef enum _pappl_attr_id_e		// Requested attribute IDs
+{
+#  define _PAPPL_ATTR(id,name) _PAPPL_ATTR_##id,
+  _PAPPL_ATTRS
+#  undef _PAPPL_ATTR
+  _PAPPL_ATTR_MAX			// Number of attribute IDs
+} _pappl_attr_id_t;
+
+typedef struct _pappl_ra_s		// Compiled "requested-attributes" values
+{
+  cups_array_t		*names;			// Sorted attribute names
+  unsigned char		ids[(_PAPPL_ATTR_MAX + 7) / 8];
+						// Bitset of requested attribute IDs
+} _pappl_ra_t;
+
 typedef struct _pappl_ipp_filter_s	// Attribute filter
 {
-  cups_array_t		*ra;			// Requested attributes
+  _pappl_ra_t		*ra;			// Requested attributes
   ipp_tag_t		group_tag;		// Group to copy
 } _pappl_ipp_filter_t;
 
@@ -71,7 +159,10 @@ extern size_t		_pappl_strlcpy(char *dst, const char *src, size_t dstsize) _PAPPL
 #  endif // !HAVE_STRLCPY
 extern ipp_t		*_papplContactExport(pappl_contact_t *contact) _PAPPL_PRIVATE;
 extern void		_papplContactImport(ipp_t *col, pappl_contact_t *contact) _PAPPL_PRIVATE;
-extern void		_papplCopyAttributes(ipp_t *to, ipp_t *from, cups_array_t *ra, ipp_tag_t group_tag, int quickcopy) _PAPPL_PRIVATE;
+extern void		_papplCopyAttributes(ipp_t *to, ipp_t *from, _pappl_ra_t *ra, ipp_tag_t group_tag, int quickcopy) _PAPPL_PRIVATE;
+extern bool		_papplCreateRequested(ipp_t *request, _pappl_ra_t **ra) _PAPPL_PRIVATE;
+extern bool		_papplCreateRequestedNames(size_t num_names, const char * const *names, _pappl_ra_t **ra) _PAPPL_PRIVATE;
+extern void		_papplDeleteRequested(_pappl_ra_t *ra) _PAPPL_PRIVATE;
 extern unsigned		_papplGetRand(void) _PAPPL_PRIVATE;
 extern const char	*_papplLookupString(unsigned bit, size_t num_strings, const char * const *strings) _PAPPL_PRIVATE;
 extern unsigned		_papplLookupValue(const char *keyword, size_t num_strings, const char * const *strings) _PAPPL_PRIVATE;
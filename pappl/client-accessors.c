@@ -39,6 +39,7 @@ papplClientGetCSRFToken(
     size_t         bufsize)		// I - Size of string buffer
 {
   char		session_key[65],	// Current session key
+		addrname[256],		// Client address
 		csrf_data[1024];	// CSRF data to hash
   unsigned char	csrf_sum[32];		// SHA2-256 sum of data
 
@@ -51,10 +52,16 @@ papplClientGetCSRFToken(
     return (NULL);
   }
 
-  snprintf(csrf_data, sizeof(csrf_data), "%s:%s", papplSystemGetSessionKey(client->system, session_key, sizeof(session_key)), client->hostname);
+  // Use the numeric address since the hostname can change once it is resolved...
+  httpAddrString(httpGetAddress(client->http), addrname, sizeof(addrname));
+
+  snprintf(csrf_data, sizeof(csrf_data), "%s:%s", papplSystemGetSessionKey(client->system, session_key, sizeof(session_key)), addrname);
   cupsHashData("sha2-256", csrf_data, strlen(csrf_data), csrf_sum, sizeof(csrf_sum));
   cupsHashString(csrf_sum, sizeof(csrf_sum), buffer, bufsize);
 
+  // Don't compress a response that may contain the token...
+  client->csrf_used = true;
+
   return (buffer);
 }
 
@@ -104,6 +111,10 @@ http_t *				// O - HTTP connection
 papplClientGetHTTP(
     pappl_client_t *client)		// I - Client
 {
+  // Send any buffered HTML so that writes to the connection stay in order...
+  if (client && client->html_buffered)
+    _papplClientFlushHTML(client, false);
+
   return (client ? client->http : NULL);
 }
 
@@ -39,6 +39,8 @@ typedef struct _pappl_authdata_s	// PAM authentication data
 //
 
 static int	pappl_authenticate_user(pappl_client_t *client, const char *username, const char *password);
+static void	pappl_cache_add(pappl_system_t *system, const unsigned char *hash, const char *username, http_status_t status);
+static bool	pappl_cache_find(pappl_system_t *system, const unsigned char *hash, char *username, size_t usersize, http_status_t *status);
 #ifdef HAVE_LIBPAM
 static int	pappl_pam_func(int num_msg, const struct pam_message **msg, struct pam_response **resp, _pappl_authdata_t *data);
 #endif // HAVE_LIBPAM
@@ -91,6 +93,8 @@ papplClientIsAuthorized(
       int	userlen = sizeof(username);
 					// Length of username:password
       struct passwd *user;		// User information
+      unsigned char hash[32];		// Salted hash of credentials
+      http_status_t status;		// Authorization status
       int	num_groups;		// Number of autbenticated groups, if any
 #  ifdef __APPLE__
       int	groups[32];		// Authenticated groups, if any
@@ -103,6 +107,25 @@ papplClientIsAuthorized(
         ;				// Skip whitespace
 
       httpDecode64_2(username, &userlen, authorization);
+
+      // See if we have recently authenticated these credentials...
+      if (userlen > 0)
+      {
+        unsigned char	temp[sizeof(client->system->auth_salt) + sizeof(username)];
+					// Salted credentials
+
+        memcpy(temp, client->system->auth_salt, sizeof(client->system->auth_salt));
+        memcpy(temp + sizeof(client->system->auth_salt), username, (size_t)userlen);
+	cupsHashData("sha2-256", temp, sizeof(client->system->auth_salt) + (size_t)userlen, hash, sizeof(hash));
+	memset(temp, 0, sizeof(temp));
+
+        if (pappl_cache_find(client->system, hash, client->username, sizeof(client->username), &status))
+        {
+          papplLogClient(client, PAPPL_LOGLEVEL_DEBUG, "Authenticated as \"%s\" using cached Basic credentials.", client->username);
+          return (status);
+	}
+      }
+
       if ((password = strchr(username, ':')) != NULL)
       {
 	*password++ = '\0';
@@ -129,6 +152,8 @@ papplClientIsAuthorized(
 	    }
 
             // Check group membership...
+            status = HTTP_STATUS_CONTINUE;
+
             if (client->system->admin_gid != (gid_t)-1)
             {
               if (user->pw_gid != client->system->admin_gid)
@@ -144,13 +169,18 @@ papplClientIsAuthorized(
                 if (i >= num_groups)
                 {
                   // Not in the admin group, access is forbidden...
-                  return (HTTP_STATUS_FORBIDDEN);
+                  status = HTTP_STATUS_FORBIDDEN;
 		}
               }
             }
 
-            // If we get this far, authentication and authorization are good...
-            return (HTTP_STATUS_CONTINUE);
+            // Remember the decision so that following requests don't need
+            // another PAM conversation...
+            pappl_cache_add(client->system, hash, username, status);
+
+            // If we get this far with HTTP_STATUS_CONTINUE, authentication and
+            // authorization are good...
+            return (status);
 	  }
 	  else
 	  {
@@ -181,6 +211,23 @@ papplClientIsAuthorized(
 }
 
 
+//
+// '_papplSystemFlushAuthCache()' - Forget all cached Basic credentials.
+//
+// This function is called whenever the administrative group changes so that
+// the next request from each user is authorized against the new group.
+//
+
+void
+_papplSystemFlushAuthCache(
+    pappl_system_t *system)		// I - System
+{
+  pthread_mutex_lock(&system->auth_mutex);
+  memset(system->auth_cache, 0, sizeof(system->auth_cache));
+  pthread_mutex_unlock(&system->auth_mutex);
+}
+
+
 //
 // 'pappl_authenticate_user()' - Validate a username + password combination.
 //
@@ -249,6 +296,82 @@ pappl_authenticate_user(
 }
 
 
+//
+// 'pappl_cache_add()' - Add an authorization result to the credential cache.
+//
+// The oldest (or an expired) entry is replaced when the cache is full.
+//
+
+static void
+pappl_cache_add(
+    pappl_system_t      *system,	// I - System
+    const unsigned char *hash,		// I - Salted hash of credentials
+    const char          *username,	// I - Authenticated username
+    http_status_t       status)		// I - Authorization result
+{
+  _pappl_authcache_t	*entry,		// Current entry
+			*oldest;	// Entry to replace
+
+
+  pthread_mutex_lock(&system->auth_mutex);
+
+  for (entry = system->auth_cache, oldest = entry; entry < (system->auth_cache + _PAPPL_MAX_AUTH_CACHE); entry ++)
+  {
+    if (!memcmp(entry->hash, hash, sizeof(entry->hash)))
+    {
+      oldest = entry;
+      break;
+    }
+    else if (entry->expire < oldest->expire)
+      oldest = entry;
+  }
+
+  memcpy(oldest->hash, hash, sizeof(oldest->hash));
+  strlcpy(oldest->username, username, sizeof(oldest->username));
+  oldest->status = status;
+  oldest->expire = time(NULL) + _PAPPL_AUTH_CACHE_TTL;
+
+  pthread_mutex_unlock(&system->auth_mutex);
+}
+
+
+//
+// 'pappl_cache_find()' - Look up credentials in the credential cache.
+//
+
+static bool				// O - `true` if found, `false` otherwise
+pappl_cache_find(
+    pappl_system_t      *system,	// I - System
+    const unsigned char *hash,		// I - Salted hash of credentials
+    char                *username,	// I - Username buffer
+    size_t              usersize,	// I - Size of username buffer
+    http_status_t       *status)	// O - Authorization result
+{
+  _pappl_authcache_t	*entry;		// Current entry
+  time_t		curtime = time(NULL);
+					// Current time
+  bool			ret = false;	// Return value
+
+
+  pthread_mutex_lock(&system->auth_mutex);
+
+  for (entry = system->auth_cache; entry < (system->auth_cache + _PAPPL_MAX_AUTH_CACHE); entry ++)
+  {
+    if (entry->expire > curtime && !memcmp(entry->hash, hash, sizeof(entry->hash)))
+    {
+      strlcpy(username, entry->username, usersize);
+      *status = entry->status;
+      ret     = true;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&system->auth_mutex);
+
+  return (ret);
+}
+
+
 #ifdef HAVE_LIBPAM
 //
 // 'pappl_pam_func()' - PAM conversation function.
@@ -42,11 +42,17 @@ struct _pappl_client_s			// Client data
   int			host_port;		// Port number from Host: header
   http_addr_t		addr;			// Client address
   char			hostname[256];		// Client hostname
+  bool			lookup_hostname;	// Look up hostname after connection closes?
   char			username[256];		// Authenticated username, if any
   pappl_printer_t	*printer;		// Printer, if any
   pappl_job_t		*job;			// Job, if any
   int			num_files;		// Number of temporary files
   char			*files[10];		// Temporary files
+  bool			csrf_used;		// Response includes the CSRF token?
+  bool			html_buffered;		// Buffering HTML output?
+  char			*html;			// HTML output buffer
+  size_t		html_used,		// Bytes in HTML output buffer
+			html_size;		// Size of HTML output buffer
 };
 
 
@@ -59,6 +65,7 @@ extern pappl_client_t	*_papplClientCreate(pappl_system_t *system, int sock) _PAP
 extern char		*_papplClientCreateTempFile(pappl_client_t *client, const void *data, size_t datasize) _PAPPL_PRIVATE;
 extern void		_papplClientDelete(pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplClientFlushDocumentData(pappl_client_t *client) _PAPPL_PRIVATE;
+extern bool		_papplClientFlushHTML(pappl_client_t *client, bool finish) _PAPPL_PRIVATE;
 extern bool		_papplClientHaveDocumentData(pappl_client_t *client) _PAPPL_PRIVATE;
 extern bool		_papplClientProcessHTTP(pappl_client_t *client) _PAPPL_PRIVATE;
 extern bool		_papplClientProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
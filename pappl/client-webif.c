@@ -16,6 +16,13 @@
 #include <math.h>
 
 
+//
+// Local functions...
+//
+
+static void	html_write(pappl_client_t *client, const char *data, size_t datalen);
+
+
 //
 // 'papplClientGetCookie()' - Get a cookie from the client.
 //
@@ -586,14 +593,14 @@ papplClientHTMLEscape(
     if (*s == '&' || *s == '<' || *s == '\"')
     {
       if (s > start)
-        httpWrite2(client->http, start, (size_t)(s - start));
+        html_write(client, start, (size_t)(s - start));
 
       if (*s == '&')
-        httpWrite2(client->http, "&amp;", 5);
+        html_write(client, "&amp;", 5);
       else if (*s == '<')
-        httpWrite2(client->http, "&lt;", 4);
+        html_write(client, "&lt;", 4);
       else
-        httpWrite2(client->http, "&quot;", 6);
+        html_write(client, "&quot;", 6);
 
       start = s + 1;
     }
@@ -602,15 +609,15 @@ papplClientHTMLEscape(
   }
 
   if (s > start)
-    httpWrite2(client->http, start, (size_t)(s - start));
+    html_write(client, start, (size_t)(s - start));
 }
 
 
 //
 // 'papplClientHTMLFooter()' - Show the web interface footer.
 //
-// This function sends the standard web interface footer followed by a
-// trailing 0-length chunk to finish the current HTTP response.  Use the
+// This function sends the standard web interface footer and finishes the
+// current HTTP response.  Use the
 // @link papplSystemSetFooterHTML@ function to add any custom HTML needed in
 // the footer.
 //
@@ -638,7 +645,11 @@ papplClientHTMLFooter(
   papplClientHTMLPuts(client,
 		      "  </body>\n"
 		      "</html>\n");
-  httpWrite2(client->http, "", 0);
+
+  if (client->html_buffered)
+    _papplClientFlushHTML(client, true);
+  else
+    httpWrite2(client->http, "", 0);
 }
 
 
@@ -1010,14 +1021,14 @@ papplClientHTMLPrintf(
     if (*format == '%')
     {
       if (format > start)
-        httpWrite2(client->http, start, (size_t)(format - start));
+        html_write(client, start, (size_t)(format - start));
 
       tptr    = tformat;
       *tptr++ = *format++;
 
       if (*format == '%')
       {
-        httpWrite2(client->http, "%", 1);
+        html_write(client, "%", 1);
         format ++;
 	start = format;
 	continue;
@@ -1124,7 +1135,7 @@ papplClientHTMLPrintf(
 
 	    snprintf(temp, sizeof(temp), tformat, va_arg(ap, double));
 
-            httpWrite2(client->http, temp, strlen(temp));
+            html_write(client, temp, strlen(temp));
 	    break;
 
         case 'B' : // Integer formats
@@ -1148,7 +1159,7 @@ papplClientHTMLPrintf(
 	    else
 	      snprintf(temp, sizeof(temp), tformat, va_arg(ap, int));
 
-            httpWrite2(client->http, temp, strlen(temp));
+            html_write(client, temp, strlen(temp));
 	    break;
 
 	case 'p' : // Pointer value
@@ -1157,7 +1168,7 @@ papplClientHTMLPrintf(
 
 	    snprintf(temp, sizeof(temp), tformat, va_arg(ap, void *));
 
-            httpWrite2(client->http, temp, strlen(temp));
+            html_write(client, temp, strlen(temp));
 	    break;
 
         case 'c' : // Character or character array
@@ -1184,7 +1195,7 @@ papplClientHTMLPrintf(
   }
 
   if (format > start)
-    httpWrite2(client->http, start, (size_t)(format - start));
+    html_write(client, start, (size_t)(format - start));
 
   va_end(ap);
 }
@@ -1243,7 +1254,7 @@ papplClientHTMLPuts(
     const char     *s)			// I - String
 {
   if (client && s && *s)
-    httpWrite2(client->http, s, strlen(s));
+    html_write(client, s, strlen(s));
 }
 
 
@@ -1359,3 +1370,45 @@ papplClientSetCookie(
     httpSetCookie(client->http, buffer);
   }
 }
+
+
+//
+// 'html_write()' - Write HTML output, buffering as needed.
+//
+
+static void
+html_write(pappl_client_t *client,	// I - Client
+           const char     *data,	// I - Data to write
+           size_t         datalen)	// I - Length of data
+{
+  if (client->html_buffered)
+  {
+    if ((client->html_used + datalen) > client->html_size)
+    {
+      // Grow the buffer, which is reused for following requests on this
+      // connection...
+      size_t	newsize = client->html_size ? client->html_size : 65536;
+					// New buffer size
+      char	*newhtml;		// New buffer
+
+      while (newsize < (client->html_used + datalen))
+        newsize *= 2;
+
+      if ((newhtml = realloc(client->html, newsize)) == NULL)
+      {
+        // Out of memory, send what we have and stop buffering...
+        _papplClientFlushHTML(client, false);
+        httpWrite2(client->http, data, datalen);
+        return;
+      }
+
+      client->html      = newhtml;
+      client->html_size = newsize;
+    }
+
+    memcpy(client->html + client->html_used, data, datalen);
+    client->html_used += datalen;
+  }
+  else
+    httpWrite2(client->http, data, datalen);
+}
@@ -19,7 +19,11 @@
 // Local functions...
 //
 
-static bool	eval_if_modified(pappl_client_t *client, _pappl_resource_t *r);
+static bool	eval_if_modified(pappl_client_t *client, _pappl_resource_t *r, time_t last_modified, size_t length);
+static const char *get_content_encoding(pappl_client_t *client, const char *type, size_t length);
+static const char *get_page_encoding(pappl_client_t *client, const char *type, size_t length);
+static bool	lookup_hostname(pappl_system_t *system, http_addr_t *addr, char *name, size_t namesize);
+static void	resolve_hostname(pappl_system_t *system, http_addr_t *addr);
 
 
 //
@@ -82,8 +86,13 @@ _papplClientCreate(
     return (NULL);
   }
 
+  // Get the numeric address (libcups does not do any lookups here) and use a
+  // cached hostname if we have one...
   httpGetHostname(client->http, client->hostname, sizeof(client->hostname));
 
+  if ((system->options & PAPPL_SOPTIONS_HOSTNAME_LOOKUPS) && !lookup_hostname(system, httpGetAddress(client->http), client->hostname, sizeof(client->hostname)))
+    client->lookup_hostname = true;
+
   papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Accepted connection from '%s'.", client->hostname);
 
   return (client);
@@ -164,10 +173,58 @@ _papplClientDelete(
   ippDelete(client->request);
   ippDelete(client->response);
 
+  free(client->html);
   free(client);
 }
 
 
+//
+// '_papplClientFlushHTML()' - Send buffered HTML output.
+//
+// When "finish" is `true` the response is completed, using a Content-Length
+// unless the page is compressed.  Otherwise the response header and buffered
+// output are sent using chunking so that more data can be written.
+//
+
+bool					// O - `true` on success, `false` on failure
+_papplClientFlushHTML(
+    pappl_client_t *client,		// I - Client
+    bool           finish)		// I - Finish the response?
+{
+  const char	*encoding;		// Content-Encoding, if any
+  size_t	length;			// Content-Length or `0` for chunked
+  bool		ret;			// Return value
+
+
+  if (!client->html_buffered)
+    return (true);
+
+  encoding = finish ? get_page_encoding(client, "text/html", client->html_used) : NULL;
+  length   = (finish && !encoding) ? client->html_used : 0;
+
+  // Send the header while still buffered so that papplClientRespond doesn't
+  // start buffering again...
+  ret = papplClientRespond(client, HTTP_STATUS_OK, encoding, "text/html", 0, length);
+
+  client->html_buffered = false;
+
+  if (!ret)
+    return (false);
+
+  if (client->html_used > 0 && httpWrite2(client->http, client->html, client->html_used) < 0)
+    return (false);
+
+  client->html_used = 0;
+
+  if (!finish)
+    return (true);
+  else if (length)
+    return (httpFlushWrite(client->http) >= 0);
+  else
+    return (httpWrite2(client->http, "", 0) >= 0);
+}
+
+
 //
 // '_papplClientProcessHTTP()' - Process a HTTP request.
 //
@@ -188,6 +245,7 @@ _papplClientProcessHTTP(
   int			port;		// Port number
   char			*ptr;		// Pointer into string
   _pappl_resource_t	*resource;	// Current resource
+  void			*cbdata;	// Resource callback data
   static const char * const http_states[] =
   {					// Strings for logging HTTP method
     "WAITING",
@@ -213,9 +271,12 @@ _papplClientProcessHTTP(
   ippDelete(client->request);
   ippDelete(client->response);
 
-  client->request   = NULL;
-  client->response  = NULL;
-  client->operation = HTTP_STATE_WAITING;
+  client->request       = NULL;
+  client->response      = NULL;
+  client->operation     = HTTP_STATE_WAITING;
+  client->csrf_used     = false;
+  client->html_buffered = false;
+  client->html_used     = 0;
 
   // Read a request from the connection...
   while ((http_state = httpReadRequest(client->http, uri, sizeof(uri))) == HTTP_STATE_WAITING)
@@ -355,12 +416,42 @@ _papplClientProcessHTTP(
 
     case HTTP_STATE_HEAD :
         // See if we have a matching resource to serve...
-        if ((resource = _papplSystemFindResource(client->system, client->uri)) != NULL)
+        if ((resource = _papplSystemFindResource(client->system, client->uri, &cbdata)) != NULL)
         {
-          if (eval_if_modified(client, resource))
-	    return (papplClientRespond(client, HTTP_STATUS_OK, NULL, resource->format, resource->last_modified, 0));
+	  time_t	last_modified;	// Last modified time
+	  size_t	length;		// Length
+
+          // Revalidate external files so that HEAD reports the same modification
+          // time as GET...
+          if (!resource->cb && resource->filename)
+          {
+	    int		fd;		// Resource file descriptor
+	    struct stat	fileinfo;	// File information
+
+            if ((fd = _papplResourceOpenFile(resource)) < 0)
+	      return (papplClientRespond(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0, 0));
+
+            if (fstat(fd, &fileinfo))
+            {
+              close(fd);
+              return (false);
+            }
+
+            close(fd);
+
+            last_modified = fileinfo.st_mtime;
+            length        = (size_t)fileinfo.st_size;
+          }
+          else
+          {
+            last_modified = resource->last_modified;
+            length        = resource->length;
+          }
+
+          if (eval_if_modified(client, resource, last_modified, length))
+	    return (papplClientRespond(client, HTTP_STATUS_OK, NULL, resource->format, last_modified, 0));
           else
-            return (papplClientRespond(client, HTTP_STATUS_NOT_MODIFIED, NULL, NULL, resource->last_modified, 0));
+            return (papplClientRespond(client, HTTP_STATUS_NOT_MODIFIED, NULL, NULL, last_modified, 0));
 	}
 
         // If we get here the resource wasn't found...
@@ -368,50 +459,101 @@ _papplClientProcessHTTP(
 
     case HTTP_STATE_GET :
         // See if we have a matching resource to serve...
-        if ((resource = _papplSystemFindResource(client->system, client->uri)) != NULL)
+        if ((resource = _papplSystemFindResource(client->system, client->uri, &cbdata)) != NULL)
         {
-          if (!eval_if_modified(client, resource))
+	  int		fd = -1;	// Resource file descriptor
+	  struct stat	fileinfo;	// File information
+
+          // Open external files first so that the length and modification
+          // time are current...
+          if (!resource->cb && resource->filename)
+          {
+            if ((fd = _papplResourceOpenFile(resource)) < 0)
+	      return (papplClientRespond(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0, 0));
+
+            if (fstat(fd, &fileinfo))
+            {
+	      close(fd);
+	      return (false);
+            }
+          }
+          else
+          {
+            fileinfo.st_mtime = resource->last_modified;
+            fileinfo.st_size  = (off_t)resource->length;
+          }
+
+          if (!eval_if_modified(client, resource, fileinfo.st_mtime, (size_t)fileinfo.st_size))
           {
-            return (papplClientRespond(client, HTTP_STATUS_NOT_MODIFIED, NULL, NULL, resource->last_modified, 0));
+            if (fd >= 0)
+              close(fd);
+
+            return (papplClientRespond(client, HTTP_STATUS_NOT_MODIFIED, NULL, NULL, fileinfo.st_mtime, 0));
           }
           else if (resource->cb)
           {
-            // Send output of a callback...
-            return ((resource->cb)(client, resource->cbdata));
+            // Send output of a callback, finishing any buffered HTML page...
+            bool ret = (resource->cb)(client, cbdata);
+					// Return value
+
+            return (_papplClientFlushHTML(client, true) && ret);
 	  }
-	  else if (resource->filename)
+	  else if (fd >= 0)
 	  {
-	    // Send an external file...
-	    int		fd;		// Resource file descriptor
-	    char	buffer[8192];	// Copy buffer
-	    ssize_t	bytes;		// Bytes read/written
-
-            if ((fd = open(resource->filename, O_RDONLY)) >= 0)
+	    // Send an external file with a Content-Length so that the client
+	    // can reuse the connection without chunking...
+	    const char	*encoding;	// Content-Encoding, if any
+	    char	buffer[65536];	// Copy buffer
+	    ssize_t	bytes;		// Bytes read
+	    off_t	offset,		// Offset in file
+			length;		// Length of file
+
+            // Compressed content is chunked since the final length is not
+            // known in advance...
+            encoding = get_content_encoding(client, resource->format, (size_t)fileinfo.st_size);
+
+            if (!papplClientRespond(client, HTTP_STATUS_OK, encoding, resource->format, fileinfo.st_mtime, encoding ? 0 : (size_t)fileinfo.st_size))
 	    {
-	      if (!papplClientRespond(client, HTTP_STATUS_OK, NULL, resource->format, resource->last_modified, 0))
-	      {
-	        close(fd);
-		return (false);
-	      }
-
-              while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
-                httpWrite2(client->http, buffer, (size_t)bytes);
+	      close(fd);
+	      return (false);
+	    }
 
+            for (offset = 0, length = fileinfo.st_size; offset < length; offset += bytes)
+            {
+              // Use pread since the cached file descriptor is shared...
+              if ((bytes = pread(fd, buffer, (size_t)(length - offset) < sizeof(buffer) ? (size_t)(length - offset) : sizeof(buffer), offset)) <= 0 || httpWrite2(client->http, buffer, (size_t)bytes) < 0)
+              {
+                // File was truncated or the client went away...
+                close(fd);
+                return (false);
+              }
+            }
+
+	    if (encoding)
 	      httpWrite2(client->http, "", 0);
+	    else
+	      httpFlushWrite(client->http);
 
-	      close(fd);
+	    close(fd);
 
-	      return (true);
-	    }
+	    return (true);
 	  }
 	  else
 	  {
 	    // Send a static resource file...
-	    if (!papplClientRespond(client, HTTP_STATUS_OK, NULL, resource->format, resource->last_modified, resource->length))
+	    const char	*encoding = get_content_encoding(client, resource->format, resource->length);
+					// Content-Encoding, if any
+
+	    if (!papplClientRespond(client, HTTP_STATUS_OK, encoding, resource->format, resource->last_modified, encoding ? 0 : resource->length))
 	      return (false);
 
 	    httpWrite2(client->http, (const char *)resource->data, resource->length);
-	    httpFlushWrite(client->http);
+
+	    if (encoding)
+	      httpWrite2(client->http, "", 0);
+	    else
+	      httpFlushWrite(client->http);
+
 	    return (true);
 	  }
 	}
@@ -438,13 +580,17 @@ _papplClientProcessHTTP(
 	  // Now that we have the IPP request, process the request...
 	  return (_papplClientProcessIPP(client));
 	}
-	else if ((resource = _papplSystemFindResource(client->system, client->uri)) != NULL)
+	else if ((resource = _papplSystemFindResource(client->system, client->uri, &cbdata)) != NULL)
         {
 	  // Serve a matching resource...
           if (resource->cb)
           {
-            // Handle a post request through the callback...
-            return ((resource->cb)(client, resource->cbdata));
+            // Handle a post request through the callback, finishing any
+            // buffered HTML page...
+            bool ret = (resource->cb)(client, cbdata);
+					// Return value
+
+            return (_papplClientFlushHTML(client, true) && ret);
           }
           else
           {
@@ -485,6 +631,12 @@ _papplClientProcessHTTP(
 // Use the @link papplClientRespondRedirect@ when you need to redirect the
 // client to another page.
 //
+// When the `PAPPL_SOPTIONS_WEB_COMPRESS` system option is set, successful
+// variable-length text responses are compressed when the client supports it
+// unless a "content_encoding" value is specified.  HTML pages are buffered
+// until the page is complete and then sent with a single write, and are only
+// compressed if they don't contain the CSRF token.
+//
 
 bool					// O - `true` on success, `false` on failure
 papplClientRespond(
@@ -498,6 +650,24 @@ papplClientRespond(
   char	message[1024];			// Text message
 
 
+  if (client->html_buffered && (code != HTTP_STATUS_OK || !type || strcmp(type, "text/html")))
+  {
+    // A different response replaces the buffered HTML page...
+    client->html_buffered = false;
+    client->html_used     = 0;
+  }
+  else if (code == HTTP_STATUS_OK && !content_encoding && type && !strcmp(type, "text/html") && !length && !client->html_buffered && !client->response && (client->operation == HTTP_STATE_GET || client->operation == HTTP_STATE_POST))
+  {
+    // Collect the HTML page so that it can be sent with a Content-Length and
+    // a single write...
+    client->html_buffered = true;
+    client->html_used     = 0;
+    return (true);
+  }
+
+  if (!content_encoding && code == HTTP_STATUS_OK && !length && type && strcmp(type, "text/html"))
+    content_encoding = get_page_encoding(client, type, 0);
+
   if (type)
     papplLogClient(client, PAPPL_LOGLEVEL_INFO, "%s %s %d", httpStatus(code), type, (int)length);
   else
@@ -674,8 +844,30 @@ _papplClientRun(
     _papplClientCleanTempFiles(client);
   }
 
-  // Close the conection to the client and return...
-  _papplClientDelete(client);
+  // Close the conection to the client...
+  if (client->lookup_hostname)
+  {
+    // Look up the client's hostname for future connections once this one is
+    // closed so that the resolver never delays a request...
+    pappl_system_t	*system = client->system;
+					// System
+    http_addr_t		addr = *httpGetAddress(client->http);
+					// Client address
+
+    // Count the lookup before deleting the client so papplSystemDelete
+    // waits for it...
+    pthread_mutex_lock(&system->hostnames_mutex);
+    system->hostnames_lookups ++;
+    pthread_mutex_unlock(&system->hostnames_mutex);
+
+    _papplClientDelete(client);
+
+    resolve_hostname(system, &addr);
+  }
+  else
+  {
+    _papplClientDelete(client);
+  }
 
   return (NULL);
 }
@@ -688,7 +880,9 @@ _papplClientRun(
 static bool				// O - `true` if modified, `false` otherwise
 eval_if_modified(
     pappl_client_t    *client,		// I - Client
-    _pappl_resource_t *r)		// I - Resource
+    _pappl_resource_t *r,		// I - Resource
+    time_t            last_modified,	// I - Last modified time of resource
+    size_t            length)		// I - Length of resource
 {
   const char	*ptr;			// Pointer into field
   time_t	date = 0;		// Time/date value
@@ -735,5 +929,159 @@ eval_if_modified(
   }
 
   // Return the evaluation based on the last modified date, time, and size...
-  return ((size != 0 && size != (off_t)r->length) || (date != 0 && date < r->last_modified) || (size == 0 && date == 0));
+  return ((size != 0 && size != (off_t)length) || (date != 0 && date < last_modified) || (size == 0 && date == 0));
+}
+
+
+//
+// 'get_content_encoding()' - Get the Content-Encoding to use for a response.
+//
+// Only text-based content that is large enough to benefit from compression
+// is compressed.  The compression itself is done by libcups when the
+// Content-Encoding field is set for a response.
+//
+
+static const char *			// O - Content-Encoding value or `NULL` for none
+get_content_encoding(
+    pappl_client_t *client,		// I - Client
+    const char     *type,		// I - MIME media type
+    size_t         length)		// I - Length of content or `0` for variable-length
+{
+  if (!type || (length > 0 && length < 1024))
+    return (NULL);
+
+  if (strncmp(type, "text/", 5) && strcmp(type, "application/javascript") && strcmp(type, "application/json") && strcmp(type, "image/svg+xml"))
+    return (NULL);
+
+  return (httpGetContentEncoding(client->http));
+}
+
+
+//
+// 'get_page_encoding()' - Get the Content-Encoding to use for a dynamic page.
+//
+// Dynamic pages are only compressed when the system allows it and the page
+// does not contain the CSRF token, since compressing a secret together with
+// values echoed from the request allows it to be recovered from the response
+// lengths (the "BREACH" attack).
+//
+
+static const char *			// O - Content-Encoding value or `NULL` for none
+get_page_encoding(
+    pappl_client_t *client,		// I - Client
+    const char     *type,		// I - MIME media type
+    size_t         length)		// I - Length of content or `0` for variable-length
+{
+  if (!(client->system->options & PAPPL_SOPTIONS_WEB_COMPRESS) || client->csrf_used)
+    return (NULL);
+  else
+    return (get_content_encoding(client, type, length));
+}
+
+
+//
+// 'lookup_hostname()' - Look up a client hostname in the cache.
+//
+
+static bool				// O - `true` if found, `false` otherwise
+lookup_hostname(
+    pappl_system_t *system,		// I - System
+    http_addr_t    *addr,		// I - Client address
+    char           *name,		// I - Hostname buffer
+    size_t         namesize)		// I - Size of hostname buffer
+{
+  _pappl_hostname_t	*host;		// Current hostname
+  time_t		curtime = time(NULL);
+					// Current time
+  bool			ret = false;	// Return value
+
+
+  if (!addr || httpAddrFamily(addr) == AF_LOCAL || httpAddrLocalhost(addr))
+    return (true);
+
+  pthread_mutex_lock(&system->hostnames_mutex);
+
+  for (host = system->hostnames; host < (system->hostnames + _PAPPL_MAX_HOSTNAMES); host ++)
+  {
+    if (host->expire > curtime && httpAddrEqual(&host->addr, addr))
+    {
+      if (host->name[0])
+        strlcpy(name, host->name, namesize);
+
+      host->used = ++ system->hostnames_used;
+      ret        = true;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&system->hostnames_mutex);
+
+  return (ret);
+}
+
+
+//
+// 'resolve_hostname()' - Look up a client hostname and add it to the cache.
+//
+// A placeholder entry is added before doing the lookup so that concurrent
+// connections from the same address do not start their own lookups.  The
+// caller counts the lookup in "hostnames_lookups", which is released here.
+//
+
+static void
+resolve_hostname(
+    pappl_system_t *system,		// I - System
+    http_addr_t    *addr)		// I - Client address
+{
+  _pappl_hostname_t	*host,		// Current hostname
+			*oldest;	// Least recently used hostname
+  time_t		curtime = time(NULL);
+					// Current time
+  char			name[256];	// Hostname
+
+
+  // Add a placeholder, replacing the least recently used entry...
+  pthread_mutex_lock(&system->hostnames_mutex);
+
+  for (host = system->hostnames, oldest = host; host < (system->hostnames + _PAPPL_MAX_HOSTNAMES); host ++)
+  {
+    if (host->expire > curtime && httpAddrEqual(&host->addr, addr))
+    {
+      // Already resolved or being resolved...
+      system->hostnames_lookups --;
+      pthread_cond_broadcast(&system->hostnames_cond);
+      pthread_mutex_unlock(&system->hostnames_mutex);
+      return;
+    }
+    else if (host->expire <= curtime)
+    {
+      if (oldest->expire > curtime)
+        oldest = host;
+    }
+    else if (oldest->expire > curtime && host->used < oldest->used)
+    {
+      oldest = host;
+    }
+  }
+
+  oldest->addr    = *addr;
+  oldest->name[0] = '\0';
+  oldest->expire  = curtime + _PAPPL_HOSTNAME_TTL;
+  oldest->used    = ++ system->hostnames_used;
+
+  pthread_mutex_unlock(&system->hostnames_mutex);
+
+  // Do the lookup without holding the lock...
+  httpAddrLookup(addr, name, sizeof(name));
+
+  // Save the name, unless the entry has been reused in the meantime...
+  pthread_mutex_lock(&system->hostnames_mutex);
+
+  if (httpAddrEqual(&oldest->addr, addr))
+    strlcpy(oldest->name, name, sizeof(oldest->name));
+
+  system->hostnames_lookups --;
+  pthread_cond_broadcast(&system->hostnames_cond);
+
+  pthread_mutex_unlock(&system->hostnames_mutex);
 }
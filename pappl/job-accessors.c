@@ -51,6 +51,9 @@ static const char * const pappl_jreasons[] =
 // This function gets the named IPP attribute from a job.  The returned
 // attribute can be examined using the `ippGetXxx` functions.
 //
+// > Note: The attributes of completed jobs are freed 60 seconds after the job
+// > completes, after which this function returns `NULL`.
+//
 
 ipp_attribute_t *			// O - Attribute or `NULL` if not found
 papplJobGetAttribute(pappl_job_t *job,	// I - Job
@@ -60,6 +63,8 @@ papplJobGetAttribute(pappl_job_t *job,	// I - Job
 
   if (job)
   {
+    _papplJobLoadAttributes(job);
+
     pthread_rwlock_rdlock(&job->rwlock);
     attr = ippFindAttribute(job->attrs, name, IPP_TAG_ZERO);
     pthread_rwlock_unlock(&job->rwlock);
@@ -462,5 +467,7 @@ _papplJobSetState(pappl_job_t  *job,	// I - Job
         job->state_reasons |= PAPPL_JREASON_JOB_COMPLETED_WITH_WARNINGS;
     }
     pthread_rwlock_unlock(&job->rwlock);
+
+    _papplPrinterAddEvent(job->printer, job, state >= IPP_JSTATE_CANCELED ? _PAPPL_EVENT_JOB_COMPLETED | _PAPPL_EVENT_JOB_STATE_CHANGED : _PAPPL_EVENT_JOB_STATE_CHANGED);
   }
 }
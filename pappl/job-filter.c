@@ -13,6 +13,7 @@
 
 #include "pappl.h"
 #include "job-private.h"
+#include "printer-private.h"
 #ifdef HAVE_LIBJPEG
 #  include <setjmp.h>
 #  include <jpeglib.h>
@@ -22,6 +23,13 @@
 #endif // HAVE_LIBPNG
 
 
+//
+// Local constants...
+//
+
+#define _PAPPL_IMAGE_BAND	32	// Number of rotated rows per band
+
+
 //
 // Local types...
 //
@@ -35,14 +43,71 @@ typedef struct _pappl_jpeg_err_s	// JPEG error manager extension
 } _pappl_jpeg_err_t;
 #endif // HAVE_LIBJPEG
 
+#ifdef HAVE_LIBPNG
+typedef struct _pappl_png_stream_s	// PNG streaming data
+{
+  pappl_job_t	*job;				// Job
+  png_structp	pp;				// PNG read data
+  png_infop	info;				// PNG image information
+  int		width,				// Width in columns
+		depth,				// Output bytes per pixel
+		channels;			// Decoded channels per pixel
+  unsigned char	*buffer;			// Decoded row with alpha
+} _pappl_png_stream_t;
+#endif // HAVE_LIBPNG
+
+typedef bool (*_pappl_image_cb_t)(void *data, unsigned char *row);
+					// Read the next image row
+
+typedef struct _pappl_image_stream_s	// Streamed image data
+{
+  _pappl_image_cb_t	cb;			// Read row callback
+  void			*cb_data;		// Callback data
+  size_t		rowsize;		// Bytes per row
+  int			numrows,		// Number of rows in window
+			nextrow;		// Next row to read
+  unsigned char		*rows;			// Window of most recent rows
+} _pappl_image_stream_t;
+
+typedef struct _pappl_image_coef_s	// Image resampling coefficients
+{
+  int		count,				// Number of scaled pixels
+		maxtaps,			// Maximum taps per scaled pixel
+		*first,				// First source pixel for each scaled pixel
+		*ntaps;				// Number of taps for each scaled pixel
+  unsigned	*weights;			// Weights (4096 = 1.0), "maxtaps" per scaled pixel
+} _pappl_image_coef_t;
+
+typedef struct _pappl_image_layout_s	// Image layout on the page
+{
+  int		ileft,				// Imageable left margin
+		itop,				// Imageable top margin
+		iwidth,				// Imageable width
+		iheight,			// Imageable length/height
+		xsize,				// Scaled width
+		ysize;				// Scaled height
+} _pappl_image_layout_t;
+
 
 //
 // Local functions...
 //
 
+static bool	filter_image(pappl_job_t *job, pappl_device_t *device, pappl_pr_options_t *options, const unsigned char *pixels, _pappl_image_stream_t *stream, int width, int height, int depth, int ppi, bool smoothing);
+static bool	image_coefficients(_pappl_image_coef_t *coef, int src, int dst, int first, int count, bool reverse);
+static bool	image_layout(pappl_job_t *job, pappl_pr_options_t *options, int width, int height, int *ppi, _pappl_image_layout_t *layout);
+static void	image_rotate(const unsigned char *pixels, int width, int height, int depth, ipp_orient_t orientation, const int *rows, int count, const int *xmap, int xcount, unsigned char *band);
+static const unsigned char *image_row(_pappl_image_stream_t *stream, int y);
 #ifdef HAVE_LIBJPEG
 static void	jpeg_error_handler(j_common_ptr p) _PAPPL_NORETURN;
+static bool	jpeg_read_row(j_decompress_ptr dinfo, unsigned char *row);
 #endif // HAVE_LIBJPEG
+#ifdef HAVE_LIBPNG
+static void	png_error_handler(png_structp pp, png_const_charp message) _PAPPL_NORETURN;
+static bool	png_read_row_cb(_pappl_png_stream_t *png, unsigned char *row);
+static int	png_stream_image(pappl_job_t *job, pappl_device_t *device, pappl_pr_options_t *options, int ppi);
+static void	png_warning_handler(png_structp pp, png_const_charp message);
+#endif // HAVE_LIBPNG
 
 
 //
@@ -72,260 +137,517 @@ papplJobFilterImage(
     int                 ppi,		// I - Pixels per inch (`0` for unknown)
     bool		smoothing)	// I - `true` to smooth/interpolate the image, `false` for nearest-neighbor sampling
 {
-  bool			started = false;// Have we started the job?
-  int			i;		// Looping var
-  pappl_pr_driver_data_t driver_data;	// Printer driver data
-  const unsigned char	*dither;	// Dither line
-  int			ileft,		// Imageable left margin
-			itop,		// Imageable top margin
-			iwidth,		// Imageable width
-			iheight;	// Imageable length/height
-  unsigned char		white,		// White color
-			*line = NULL,	// Output line
-			*lineptr,	// Pointer in line
-			byte,		// Byte in line
-			bit;		// Current bit
-  const unsigned char	*pixbase,	// Pointer to first pixel
-			*pixptr;	// Pointer into image
-  int			img_width,	// Rotated image width
-			img_height,	// Rotated image height
-			x,		// X position
-			xsize,		// Scaled width
-			xstart,		// X start position
-			xend,		// X end position
-			y,		// Y position
-			ysize,		// Scaled height
-			ystart,		// Y start position
-			yend;		// Y end position
-  int			xdir,		// X direction
-			xerr,		// X error accumulator
-			xmod,		// X modulus
-			xstep,		// X step
-			ydir;		// Y direction
+  return (filter_image(job, device, options, pixels, NULL, width, height, depth, ppi, smoothing));
+}
 
 
-  // TODO: Implement interpolation (Issue #64)
-  (void)smoothing;
+//
+// '_papplJobFilterJPEG()' - Filter a JPEG image file.
+//
 
-  // Images contain a single page/impression...
-  papplJobSetImpressions(job, 1);
+#ifdef HAVE_LIBJPEG
+bool
+_papplJobFilterJPEG(
+    pappl_job_t    *job,		// I - Job
+    pappl_device_t *device,		// I - Device
+    void           *data)		// I - Filter data (unused)
+{
+  const char		*filename;	// JPEG filename
+  FILE			*fp;		// JPEG file
+  pappl_pr_options_t	*options = NULL;// Job options
+  struct jpeg_decompress_struct	dinfo;	// Decompressor info
+  int			ppi;		// Pixels per inch
+  _pappl_image_layout_t	layout;		// Image layout
+  _pappl_image_stream_t	stream;		// Image stream
+  int			xscale,		// Horizontal scale (N/8)
+			yscale;		// Vertical scale (N/8)
+  _pappl_jpeg_err_t	jerr;		// Error handler info
+  unsigned char		*pixels = NULL;	// Image pixels
+  JSAMPROW		row;		// Sample row pointer
+  bool			ret = false;	// Return value
 
-  if (options->print_scaling == PAPPL_SCALING_FILL)
+
+  (void)data;
+
+  // Open the JPEG file...
+  filename = papplJobGetFilename(job);
+  if ((fp = fopen(filename, "rb")) == NULL)
   {
-    // Scale to fill the entire media area...
-    ileft   = 0;
-    itop    = 0;
-    iwidth  = (int)options->header.cupsWidth;
-    iheight = (int)options->header.cupsHeight;
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, strerror(errno));
+    return (false);
   }
-  else
+
+  // Read the image header...
+  jpeg_std_error(&jerr.jerr);
+  jerr.jerr.error_exit = jpeg_error_handler;
+
+  if (setjmp(jerr.retbuf))
   {
-    // Scale/center within the margins...
-    ileft   = options->media.left_margin * options->printer_resolution[0] / 2540;
-    itop    = options->media.top_margin * options->printer_resolution[1] / 2540;
-    iwidth  = (int)options->header.cupsWidth - (options->media.left_margin + options->media.right_margin) * options->printer_resolution[0] / 2540;
-    iheight = (int)options->header.cupsHeight - (options->media.bottom_margin + options->media.top_margin) * options->printer_resolution[1] / 2540;
+    // JPEG library errors are directed to this point...
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, jerr.message);
+    ret = false;
+    goto finish_jpeg;
   }
 
-  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ileft=%d, itop=%d, iwidth=%d, iheight=%d", ileft, itop, iwidth, iheight);
+  dinfo.err = (struct jpeg_error_mgr *)&jerr;
+  jpeg_create_decompress(&dinfo);
+  jpeg_stdio_src(&dinfo, fp);
+  dinfo.client_data = job;
+  jpeg_read_header(&dinfo, TRUE);
 
-  if (iwidth <= 0 || iheight <= 0)
+  if (dinfo.X_density != dinfo.Y_density)
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Invalid media size");
-    return (false);
+    papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unsupported non-square JPEG resolution %ux%u%s, using default.", dinfo.X_density, dinfo.Y_density, dinfo.density_unit == 1 ? "dpi" : dinfo.density_unit == 2 ? "dpcm" : "???");
+    ppi = 0;
   }
-
-  // Figure out the scaling and rotation of the image...
-  if (options->orientation_requested == IPP_ORIENT_NONE)
+  else
   {
-    if (width > height && options->header.cupsWidth < options->header.cupsHeight)
-    {
-      options->orientation_requested = IPP_ORIENT_LANDSCAPE;
-      papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Auto-orientation: landscape");
-    }
-    else
+    switch (dinfo.density_unit)
     {
-      options->orientation_requested = IPP_ORIENT_PORTRAIT;
-      papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Auto-orientation: portrait");
+      default :
+      case 0 : // Unknown units
+          ppi = 0;
+          break;
+      case 1 : // Dots-per-inch
+          ppi = dinfo.X_density;
+          break;
+      case 2 : // Dots-per-centimeter
+          ppi = dinfo.X_density * 254 / 100;
+          break;
     }
   }
 
-  if (options->print_scaling == PAPPL_SCALING_AUTO || options->print_scaling == PAPPL_SCALING_AUTO_FIT)
+  // Get job options and request the image data in the format we need...
+  options = papplJobCreatePrintOptions(job, 1, dinfo.num_components > 1);
+
+  if (image_layout(job, options, (int)dinfo.image_width, (int)dinfo.image_height, &ppi, &layout))
   {
-    if (ppi <= 0)
-    {
-      // No resolution information, so just force scaling the image to fit/fill
-      xsize = iwidth + 1;
-      ysize = iheight + 1;
-    }
-    else if (options->orientation_requested == IPP_ORIENT_PORTRAIT || options->orientation_requested == IPP_ORIENT_REVERSE_PORTRAIT)
+    // Let libjpeg decode at the smallest scale (N/8) that still provides
+    // at least one image pixel per device pixel...
+    if (options->orientation_requested == IPP_ORIENT_LANDSCAPE || options->orientation_requested == IPP_ORIENT_REVERSE_LANDSCAPE)
     {
-      xsize = width * options->printer_resolution[0] / ppi;
-      ysize = height * options->printer_resolution[1] / ppi;
+      xscale = (8 * layout.xsize + (int)dinfo.image_height - 1) / (int)dinfo.image_height;
+      yscale = (8 * layout.ysize + (int)dinfo.image_width - 1) / (int)dinfo.image_width;
     }
     else
     {
-      xsize = height * options->printer_resolution[0] / ppi;
-      ysize = width * options->printer_resolution[1] / ppi;
+      xscale = (8 * layout.xsize + (int)dinfo.image_width - 1) / (int)dinfo.image_width;
+      yscale = (8 * layout.ysize + (int)dinfo.image_height - 1) / (int)dinfo.image_height;
     }
 
-    if (xsize > iwidth || ysize > iheight)
-    {
-      // Scale to fit/fill based on "print-scaling" and margins...
-      if (options->print_scaling == PAPPL_SCALING_AUTO && options->media.bottom_margin == 0 && options->media.left_margin == 0 && options->media.right_margin == 0 && options->media.top_margin == 0)
-        options->print_scaling = PAPPL_SCALING_FILL;
-      else
-        options->print_scaling = PAPPL_SCALING_FIT;
-    }
-    else
+    if (xscale < yscale)
+      xscale = yscale;
+
+    if (xscale < 8)
     {
-      // Do no scaling...
-      options->print_scaling = PAPPL_SCALING_NONE;
+      dinfo.scale_num   = (unsigned)(xscale > 0 ? xscale : 1);
+      dinfo.scale_denom = 8;
     }
   }
-  else if (options->print_scaling == PAPPL_SCALING_NONE && ppi <= 0)
+
+  dinfo.quantize_colors = FALSE;
+
+  if (options->header.cupsNumColors == 1)
   {
-    // Force a default PPI value of 200, which fits a typical 1080p sized
-    // screenshot on a standard letter/A4 page.
-    ppi = 200;
+    dinfo.out_color_space      = JCS_GRAYSCALE;
+    dinfo.out_color_components = 1;
+    dinfo.output_components    = 1;
   }
-
-  switch (options->orientation_requested)
+  else
   {
-    default :
-    case IPP_ORIENT_PORTRAIT :
-        pixbase    = pixels;
-        img_width  = width;
-        img_height = height;
-        xdir       = (int)depth;
-        ydir       = (int)depth * (int)width;
-
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * height / width;
+    dinfo.out_color_space      = JCS_RGB;
+    dinfo.out_color_components = 3;
+    dinfo.output_components    = 3;
+  }
 
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * width / height;
-	  }
-	}
-	break;
+  jpeg_calc_output_dimensions(&dinfo);
 
-    case IPP_ORIENT_REVERSE_PORTRAIT :
-        pixbase    = pixels + depth * width * height - depth;
-        img_width  = width;
-        img_height = height;
-        xdir       = -(int)depth;
-        ydir       = -(int)depth * (int)width;
+  if (dinfo.output_width != dinfo.image_width)
+  {
+    // Adjust the resolution to match the scaled image...
+    papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Decoding %ux%u JPEG image at %u/%u scale.", dinfo.image_width, dinfo.image_height, dinfo.scale_num, dinfo.scale_denom);
 
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * height / width;
+    if (ppi > 0 && (ppi = (int)((unsigned)ppi * dinfo.output_width / dinfo.image_width)) < 1)
+      ppi = 1;
+  }
 
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * width / height;
-	  }
-	}
-	break;
+  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Loading %dx%dx%d JPEG image.", dinfo.output_width, dinfo.output_height, dinfo.output_components);
 
-    case IPP_ORIENT_LANDSCAPE : // 90 counter-clockwise
-        pixbase    = pixels + depth * width - depth;
-        img_width  = height;
-        img_height = width;
-        xdir       = (int)depth * (int)width;
-        ydir       = -(int)depth;
+  if (options->orientation_requested == IPP_ORIENT_PORTRAIT && options->copies == 1)
+  {
+    // Stream the image from the decoder...
+    memset(&stream, 0, sizeof(stream));
+    stream.cb      = (_pappl_image_cb_t)jpeg_read_row;
+    stream.cb_data = &dinfo;
+    stream.rowsize = (size_t)dinfo.output_width * (size_t)dinfo.output_components;
 
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * width / height;
+    jpeg_start_decompress(&dinfo);
 
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * height / width;
-	  }
-	}
-	break;
+    ret = filter_image(job, device, options, NULL, &stream, (int)dinfo.output_width, (int)dinfo.output_height, dinfo.output_components, ppi, true);
+    goto finish_jpeg;
+  }
 
-    case IPP_ORIENT_REVERSE_LANDSCAPE : // 90 clockwise
-        pixbase    = pixels + depth * (height - 1) * width;
-        img_width  = height;
-        img_height = width;
-        xdir       = -(int)depth * (int)width;
-        ydir       = (int)depth;
+  if ((pixels = (unsigned char *)malloc((size_t)(dinfo.output_width * dinfo.output_height * (unsigned)dinfo.output_components))) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for %dx%dx%d JPEG image.", dinfo.output_width, dinfo.output_height, dinfo.output_components);
+    papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
+    goto finish_jpeg;
+  }
 
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * width / height;
+  jpeg_start_decompress(&dinfo);
 
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * height / width;
-	  }
-	}
-        break;
+  while (dinfo.output_scanline < dinfo.output_height)
+  {
+    row = (JSAMPROW)(pixels + (size_t)dinfo.output_scanline * (size_t)dinfo.output_width * (size_t)dinfo.output_components);
+    jpeg_read_scanlines(&dinfo, &row, 1);
   }
 
-  // Don't rotate in the driver...
-  options->orientation_requested = IPP_ORIENT_PORTRAIT;
+  ret = papplJobFilterImage(job, device, options, pixels, (int)dinfo.output_width, (int)dinfo.output_height, dinfo.output_components, ppi, true);
 
-  xstart = ileft + (iwidth - xsize) / 2;
-  xend   = xstart + xsize;
-  ystart = itop + (iheight - ysize) / 2;
-  yend   = ystart + ysize;
+  finish_jpeg:
 
-  xmod   = (int)(img_width % xsize);
-  xstep  = (int)(img_width / xsize) * xdir;
+  papplJobDeletePrintOptions(options);
+  free(pixels);
+  jpeg_destroy_decompress(&dinfo);
+  fclose(fp);
 
-  if (xend > (int)options->header.cupsWidth)
-    xend = (int)options->header.cupsWidth;
+  return (ret);
+}
+#endif // HAVE_LIBJPEG
 
-  if (yend > (int)options->header.cupsHeight)
-    yend = (int)options->header.cupsHeight;
 
-  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "xsize=%d, xstart=%d, xend=%d, xdir=%d, xmod=%d, xstep=%d", xsize, xstart, xend, xdir, xmod, xstep);
-  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ysize=%d, ystart=%d, yend=%d, ydir=%d", ysize, ystart, yend, ydir);
+//
+// '_papplJobFilterPNG()' - Filter a PNG image file.
+//
 
-  papplPrinterGetDriverData(papplJobGetPrinter(job), &driver_data);
+#ifdef HAVE_LIBPNG
+bool					// O - `true` on success and `false` otherwise
+_papplJobFilterPNG(
+    pappl_job_t    *job,		// I - Job
+    pappl_device_t *device,		// I - Device
+    void           *data)		// I - Filter data (unused)
+{
+  pappl_pr_options_t	*options = NULL;// Job options
+  png_image		png;		// PNG image data
+  png_color		bg;		// Background color
+  int			png_bpp;	// Bytes per pixel
+  int			ppi = 0;	// Pixels per inch
+  _pappl_image_layout_t	layout;		// Image layout
+  int			stream_ret;	// Result of streaming
+  unsigned char		*pixels = NULL;	// Image pixels
+  bool			ret = false;	// Return value
 
-  if ((line = malloc(options->header.cupsBytesPerLine)) == NULL)
-  {
+
+  // Load the PNG...
+  (void)data;
+
+  memset(&png, 0, sizeof(png));
+  png.version = PNG_IMAGE_VERSION;
+
+  bg.red = bg.green = bg.blue = 255;
+
+  png_image_begin_read_from_file(&png, job->filename);
+
+  if (png.warning_or_error & PNG_IMAGE_ERROR)
+  {
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", job->filename, png.message);
+    goto finish_job;
+  }
+
+  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "PNG image is %ux%u", png.width, png.height);
+
+  // Prepare options...
+  options = papplJobCreatePrintOptions(job, 1, (png.format & PNG_FORMAT_FLAG_COLOR) != 0);
+
+  // TODO: Get PNG image resolution information (Issue #65)
+  if (image_layout(job, options, (int)png.width, (int)png.height, &ppi, &layout) && options->orientation_requested == IPP_ORIENT_PORTRAIT && options->copies == 1)
+  {
+    // Stream the image from the decoder...
+    if ((stream_ret = png_stream_image(job, device, options, ppi)) >= 0)
+    {
+      ret = stream_ret > 0;
+      goto finish_job;
+    }
+  }
+
+  if (options->header.cupsNumColors > 1)
+  {
+    png.format = PNG_FORMAT_RGB;
+    png_bpp    = 3;
+  }
+  else
+  {
+    png.format = PNG_FORMAT_GRAY;
+    png_bpp    = 1;
+  }
+
+  pixels = malloc(PNG_IMAGE_SIZE(png));
+
+  png_image_finish_read(&png, &bg, pixels, 0, NULL);
+
+  if (png.warning_or_error & PNG_IMAGE_ERROR)
+  {
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", job->filename, png.message);
+    goto finish_job;
+  }
+
+  // Print the image...
+  ret = papplJobFilterImage(job, device, options, pixels, (int)png.width, (int)png.height, png_bpp, ppi, false);
+
+  finish_job:
+
+  papplJobDeletePrintOptions(options);
+
+  // Free the image data when we're done...
+  png_image_free(&png);
+  free(pixels);
+
+  return (ret);
+}
+#endif // HAVE_LIBPNG
+
+
+//
+// 'filter_image()' - Filter an image in memory or streamed from a decoder.
+//
+// Streamed images ("pixels" is `NULL`) are read one row at a time using the
+// stream callback and must be printed in portrait orientation with a single
+// copy.
+//
+
+static bool				// O - `true` on success, `false` otherwise
+filter_image(
+    pappl_job_t           *job,		// I - Job
+    pappl_device_t        *device,	// I - Device
+    pappl_pr_options_t    *options,	// I - Print options
+    const unsigned char   *pixels,	// I - Pointer to the top-left corner of the image data or `NULL`
+    _pappl_image_stream_t *stream,	// I - Image stream or `NULL`
+    int                   width,	// I - Width in columns
+    int                   height,	// I - Height in lines
+    int                   depth,	// I - Bytes per pixel (`1` for grayscale or `3` for sRGB)
+    int                   ppi,		// I - Pixels per inch (`0` for unknown)
+    bool                  smoothing)	// I - `true` to smooth/interpolate the image, `false` for nearest-neighbor sampling
+{
+  bool			started = false;// Have we started the job?
+  int			i;		// Looping var
+  pappl_printer_t	*printer = papplJobGetPrinter(job);
+					// Printer
+  pappl_pr_driver_data_t driver_data;	// Printer driver data
+  const unsigned char	*dither;	// Dither line
+  _pappl_image_layout_t	layout;		// Image layout
+  unsigned char		white,		// White color
+			*line = NULL,	// Output line
+			*lineptr,	// Pointer in line
+			byte,		// Byte in line
+			bit;		// Current bit
+  const unsigned char	*pixbase,	// Pointer to first pixel
+			*pixptr;	// Pointer into image
+  int			img_width,	// Rotated image width
+			img_height,	// Rotated image height
+			x,		// X position
+			xsize,		// Scaled width
+			xstart,		// X start position
+			xend,		// X end position
+			y,		// Y position
+			ysize,		// Scaled height
+			ystart,		// Y start position
+			yend;		// Y end position
+  int			xdir,		// X direction
+			xerr,		// X error accumulator
+			xmod,		// X modulus
+			xstep,		// X step
+			ydir;		// Y direction
+  int			srcy;		// Source row in rotated image
+  unsigned		blanks;		// Number of pending blank lines
+  size_t		rowbytes;	// Bytes per source row
+  ipp_orient_t		orientation;	// Image orientation
+  unsigned char		*band = NULL;	// Band of rotated rows
+  size_t		band_rowsize = 0;// Bytes per rotated row
+  int			band_rows[_PAPPL_IMAGE_BAND],
+					// Rotated rows in band
+			band_count = 0,	// Number of rows in band
+			band_index = 0,	// Current row in band
+			band_y,		// Output line for band
+			band_xcount = 0,// Number of columns in band
+			*band_xmap = NULL;
+					// Rotated image column for each band column
+  _pappl_image_coef_t	xcoef,		// Horizontal resampling coefficients
+			ycoef;		// Vertical resampling coefficients
+  size_t		acc_size = 0;	// Number of values in accumulator
+  unsigned		*acc = NULL;	// Vertical accumulator
+  unsigned char		*scaled = NULL;	// Resampled line
+
+
+  memset(&xcoef, 0, sizeof(xcoef));
+  memset(&ycoef, 0, sizeof(ycoef));
+
+  // Images contain a single page/impression...
+  papplJobSetImpressions(job, 1);
+
+  // Figure out the scaling and rotation of the image...
+  if (!image_layout(job, options, width, height, &ppi, &layout))
+    return (false);
+
+  if (stream)
+  {
+    // Streamed images are read sequentially, so they cannot be rotated or
+    // printed more than once...
+    if (options->orientation_requested != IPP_ORIENT_PORTRAIT || options->copies > 1)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to rotate or copy a streamed image.");
+      return (false);
+    }
+
+    stream->numrows = smoothing ? 2 : 1;
+    stream->nextrow = 0;
+
+    if ((stream->rows = _papplPrinterAllocBuffer(printer, (size_t)stream->numrows * stream->rowsize)) == NULL)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for image rows.");
+      return (false);
+    }
+  }
+
+  switch (options->orientation_requested)
+  {
+    default :
+    case IPP_ORIENT_PORTRAIT :
+        pixbase    = pixels;
+        img_width  = width;
+        img_height = height;
+        xdir       = (int)depth;
+        ydir       = (int)depth * (int)width;
+	break;
+
+    case IPP_ORIENT_REVERSE_PORTRAIT :
+        pixbase    = pixels + depth * width * height - depth;
+        img_width  = width;
+        img_height = height;
+        xdir       = -(int)depth;
+        ydir       = -(int)depth * (int)width;
+	break;
+
+    case IPP_ORIENT_LANDSCAPE : // 90 counter-clockwise
+    case IPP_ORIENT_REVERSE_LANDSCAPE : // 90 clockwise
+        // Rows are rotated into a band buffer below...
+        pixbase    = NULL;
+        img_width  = height;
+        img_height = width;
+        xdir       = 1;
+        ydir       = 0;
+        break;
+  }
+
+  // Don't rotate in the driver...
+  orientation                    = options->orientation_requested;
+  options->orientation_requested = IPP_ORIENT_PORTRAIT;
+
+  xsize  = layout.xsize;
+  ysize  = layout.ysize;
+  xstart = layout.ileft + (layout.iwidth - xsize) / 2;
+  xend   = xstart + xsize;
+  ystart = layout.itop + (layout.iheight - ysize) / 2;
+  yend   = ystart + ysize;
+
+  xmod   = (int)(img_width % xsize);
+  xstep  = (int)(img_width / xsize) * xdir;
+
+  if (xend > (int)options->header.cupsWidth)
+    xend = (int)options->header.cupsWidth;
+
+  if (yend > (int)options->header.cupsHeight)
+    yend = (int)options->header.cupsHeight;
+
+  if (smoothing)
+  {
+    // Resample each line using area-averaging to scale down and bilinear
+    // interpolation to scale up...
+    int xcount = xend - (xstart < 0 ? 0 : xstart),
+					// Number of columns
+	ycount = yend - (ystart < 0 ? 0 : ystart);
+					// Number of lines
+
+    acc_size = (size_t)img_width * (size_t)depth;
+
+    if (!image_coefficients(&xcoef, img_width, xsize, xstart < 0 ? -xstart : 0, xcount > 0 ? xcount : 1, orientation == IPP_ORIENT_REVERSE_PORTRAIT) || !image_coefficients(&ycoef, img_height, ysize, ystart < 0 ? -ystart : 0, ycount > 0 ? ycount : 1, false) || (acc = _papplPrinterAllocBuffer(printer, acc_size * sizeof(unsigned))) == NULL || (scaled = _papplPrinterAllocBuffer(printer, (size_t)xcoef.count * (size_t)depth)) == NULL)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for image scaling.");
+      goto abort_job;
+    }
+
+    if (orientation == IPP_ORIENT_LANDSCAPE || orientation == IPP_ORIENT_REVERSE_LANDSCAPE)
+    {
+      // Rotate bands of whole rows as needed...
+      band_xcount  = img_width;
+      band_rowsize = (size_t)band_xcount * (size_t)depth;
+
+      if ((band = _papplPrinterAllocBuffer(printer, _PAPPL_IMAGE_BAND * band_rowsize)) == NULL)
+      {
+	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for rotated image.");
+	goto abort_job;
+      }
+    }
+  }
+  else if (orientation == IPP_ORIENT_LANDSCAPE || orientation == IPP_ORIENT_REVERSE_LANDSCAPE)
+  {
+    // Walking down the columns of the image is very cache-unfriendly, so
+    // rotate bands of rows into a separate buffer as needed.  Only the pixels
+    // that are sampled for each output column are copied...
+    if ((band_xcount = xend - (xstart < 0 ? 0 : xstart)) < 1)
+      band_xcount = 1;
+
+    band_rowsize = (size_t)band_xcount * (size_t)depth;
+
+    if ((band_xmap = malloc((size_t)band_xcount * sizeof(int))) == NULL || (band = _papplPrinterAllocBuffer(printer, _PAPPL_IMAGE_BAND * band_rowsize)) == NULL)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for rotated image.");
+      goto abort_job;
+    }
+
+    if (xstart < 0)
+    {
+      x    = -(xstart * xmod / xsize);
+      xerr = -xmod / 2 - (xstart * xmod) % xsize;
+    }
+    else
+    {
+      x    = 0;
+      xerr = -xmod / 2;
+    }
+
+    for (i = 0; i < band_xcount; i ++)
+    {
+      band_xmap[i] = x < img_width ? x : img_width - 1;
+
+      x    += xstep;
+      xerr += xmod;
+      if (xerr >= (int)xsize)
+      {
+        xerr -= xsize;
+        x ++;
+      }
+    }
+
+  }
+
+  if (smoothing || band)
+  {
+    // The lines are already scaled horizontally...
+    xdir  = (int)depth;
+    xmod  = 0;
+    xstep = (int)depth;
+  }
+
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "xsize=%d, xstart=%d, xend=%d, xdir=%d, xmod=%d, xstep=%d", xsize, xstart, xend, xdir, xmod, xstep);
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ysize=%d, ystart=%d, yend=%d, ydir=%d", ysize, ystart, yend, ydir);
+
+  papplPrinterGetDriverData(printer, &driver_data);
+
+  if ((line = _papplPrinterAllocBuffer(printer, options->header.cupsBytesPerLine)) == NULL)
+  {
     papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for raster line.");
     goto abort_job;
   }
@@ -344,6 +666,15 @@ papplJobFilterImage(
   else
     white = 0xff;
 
+  // Source rows that are all white are not rendered, and runs of blank lines
+  // are sent to the driver at once...
+  if (smoothing)
+    rowbytes = (size_t)xcoef.count * (size_t)depth;
+  else if (band)
+    rowbytes = band_rowsize;
+  else
+    rowbytes = (size_t)width * (size_t)depth;
+
   // Print every copy...
   for (i = 0; i < options->copies; i ++)
   {
@@ -355,19 +686,157 @@ papplJobFilterImage(
 
     // Leading blank space...
     memset(line, white, options->header.cupsBytesPerLine);
-    for (y = 0; y < ystart; y ++)
+
+    y      = ystart > 0 ? ystart : 0;
+    blanks = (unsigned)y;
+
+    // Now RIP the image...
+    for (; y < yend && !job->is_canceled; y ++)
     {
-      if (!(driver_data.rwriteline_cb)(job, options, device, (unsigned)y, line))
+      srcy = ysize > 1 ? (y - ystart) * (img_height - 1) / (ysize - 1) : 0;
+
+      if (smoothing)
       {
-	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
+        // Resample the line...
+        int		j = y - (ystart < 0 ? 0 : ystart),
+					// Line in coefficient table
+			t;		// Current tap
+	size_t		k;		// Looping var
+        const unsigned	*weights = ycoef.weights + j * ycoef.maxtaps;
+					// Vertical weights
+        unsigned	weight;		// Current weight
+        const unsigned char *rowptr;	// Pointer to source row
+        unsigned char	*sptr;		// Pointer into resampled line
+
+        // Accumulate the source rows vertically...
+        memset(acc, 0, acc_size * sizeof(unsigned));
+
+        for (t = 0; t < ycoef.ntaps[j]; t ++)
+        {
+          srcy = ycoef.first[j] + t;
+
+          if (stream)
+          {
+            rowptr = image_row(stream, srcy);
+          }
+          else if (band)
+          {
+            if (band_count == 0 || srcy < band_rows[0] || srcy >= (band_rows[0] + band_count))
+            {
+              // Rotate the next band of rows, including the previous row for
+              // interpolation...
+              for (band_count = 0, band_y = srcy > 0 ? srcy - 1 : 0; band_y < img_height && band_count < _PAPPL_IMAGE_BAND; band_y ++)
+                band_rows[band_count ++] = band_y;
+
+              image_rotate(pixels, width, height, depth, orientation, band_rows, band_count, NULL, band_xcount, band);
+            }
+
+            rowptr = band + (size_t)(srcy - band_rows[0]) * band_rowsize;
+          }
+          else if (orientation == IPP_ORIENT_REVERSE_PORTRAIT)
+          {
+            rowptr = pixels + (size_t)(height - 1 - srcy) * acc_size;
+          }
+          else
+          {
+            rowptr = pixels + (size_t)srcy * acc_size;
+          }
+
+          if (!rowptr)
+          {
+	    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read image data.");
+	    goto abort_job;
+          }
+
+          for (k = 0, weight = weights[t]; k < acc_size; k ++)
+            acc[k] += weight * rowptr[k];
+        }
+
+        // Then resample horizontally...
+        for (j = 0, sptr = scaled; j < xcoef.count; j ++)
+        {
+          const unsigned *aptr = acc + (size_t)xcoef.first[j] * (size_t)depth;
+					// Pointer into accumulator
+          unsigned	sum0 = 1 << 23,	// Sums with rounding
+			sum1 = 1 << 23,
+			sum2 = 1 << 23;
+
+          weights = xcoef.weights + j * xcoef.maxtaps;
+
+          if (depth == 1)
+          {
+            for (t = 0; t < xcoef.ntaps[j]; t ++)
+              sum0 += weights[t] * aptr[t];
+
+            *sptr++ = (unsigned char)(sum0 >> 24);
+          }
+          else
+          {
+            for (t = 0; t < xcoef.ntaps[j]; t ++, aptr += 3)
+            {
+              sum0 += weights[t] * aptr[0];
+              sum1 += weights[t] * aptr[1];
+              sum2 += weights[t] * aptr[2];
+            }
+
+            *sptr++ = (unsigned char)(sum0 >> 24);
+            *sptr++ = (unsigned char)(sum1 >> 24);
+            *sptr++ = (unsigned char)(sum2 >> 24);
+          }
+        }
+
+        pixptr = scaled;
+      }
+      else if (band)
+      {
+        // Find the row in the current band...
+        while (band_index < band_count && band_rows[band_index] < srcy)
+          band_index ++;
+
+        if (band_index >= band_count || band_rows[band_index] != srcy)
+        {
+          // Rotate the rows needed for the next lines...
+          for (band_count = 0, band_y = y; band_y < yend && band_count < _PAPPL_IMAGE_BAND; band_y ++)
+          {
+            int row = ysize > 1 ? (band_y - ystart) * (img_height - 1) / (ysize - 1) : 0;
+					// Rotated row for this line
+
+            if (band_count == 0 || band_rows[band_count - 1] != row)
+              band_rows[band_count ++] = row;
+	  }
+
+          image_rotate(pixels, width, height, depth, orientation, band_rows, band_count, band_xmap, band_xcount, band);
+          band_index = 0;
+        }
+
+        pixptr = band + (size_t)band_index * band_rowsize;
+      }
+      else if (!stream)
+      {
+        pixptr = pixbase + ydir * srcy;
+      }
+      else if ((pixptr = image_row(stream, srcy)) == NULL)
+      {
+	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read image data.");
 	goto abort_job;
       }
-    }
 
-    // Now RIP the image...
-    for (; y < yend && !job->is_canceled; y ++)
-    {
-      pixptr = pixbase + ydir * (int)((y - ystart) * (img_height - 1) / (ysize - 1));
+      if (_papplJobIsBlankLine(xdir < 0 ? pixptr + depth - rowbytes : pixptr, rowbytes, 0xff))
+      {
+        blanks ++;
+        continue;
+      }
+
+      if (blanks > 0)
+      {
+        if (!_papplJobWriteBlankLines(job, options, device, (unsigned)y - blanks, blanks, line))
+	{
+	  papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", (unsigned)y - blanks);
+	  goto abort_job;
+	}
+
+        blanks = 0;
+      }
 
       if (xstart < 0)
       {
@@ -467,14 +936,13 @@ papplJobFilterImage(
     }
 
     // Trailing blank space...
-    memset(line, white, options->header.cupsBytesPerLine);
-    for (; y < (int)options->header.cupsHeight; y ++)
+    if (y < (int)options->header.cupsHeight)
+      blanks += options->header.cupsHeight - (unsigned)y;
+
+    if (!_papplJobWriteBlankLines(job, options, device, options->header.cupsHeight - blanks, blanks, line))
     {
-      if (!(driver_data.rwriteline_cb)(job, options, device, (unsigned)y, line))
-      {
-	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
-	goto abort_job;
-      }
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", options->header.cupsHeight - blanks);
+      goto abort_job;
     }
 
     // End the page...
@@ -495,7 +963,23 @@ papplJobFilterImage(
   }
 
   // Free memory and return...
-  free(line);
+  _papplPrinterFreeBuffer(printer, line);
+  _papplPrinterFreeBuffer(printer, band);
+  free(band_xmap);
+  _papplPrinterFreeBuffer(printer, acc);
+  _papplPrinterFreeBuffer(printer, scaled);
+  free(xcoef.first);
+  free(xcoef.ntaps);
+  free(xcoef.weights);
+  free(ycoef.first);
+  free(ycoef.ntaps);
+  free(ycoef.weights);
+
+  if (stream)
+  {
+    _papplPrinterFreeBuffer(printer, stream->rows);
+    stream->rows = NULL;
+  }
 
   return (true);
 
@@ -505,233 +989,608 @@ papplJobFilterImage(
   if (started)
     (driver_data.rendjob_cb)(job, options, device);
 
-  free(line);
+  _papplPrinterFreeBuffer(printer, line);
+  _papplPrinterFreeBuffer(printer, band);
+  free(band_xmap);
+  _papplPrinterFreeBuffer(printer, acc);
+  _papplPrinterFreeBuffer(printer, scaled);
+  free(xcoef.first);
+  free(xcoef.ntaps);
+  free(xcoef.weights);
+  free(ycoef.first);
+  free(ycoef.ntaps);
+  free(ycoef.weights);
+
+  if (stream)
+  {
+    _papplPrinterFreeBuffer(printer, stream->rows);
+    stream->rows = NULL;
+  }
 
   return (false);
 }
 
 
 //
-// '_papplJobFilterJPEG()' - Filter a JPEG image file.
+// 'image_coefficients()' - Compute fixed-point resampling coefficients.
+//
+// Scaled pixels from "first" to "first + count - 1" are computed.  Each scaled
+// pixel is the area-average of the source pixels it covers when scaling down,
+// or a linear interpolation of the two nearest source pixels when scaling up.
+// The weights for each scaled pixel add up to 4096.
 //
 
-#ifdef HAVE_LIBJPEG
-bool
-_papplJobFilterJPEG(
-    pappl_job_t    *job,		// I - Job
-    pappl_device_t *device,		// I - Device
-    void           *data)		// I - Filter data (unused)
+static bool				// O - `true` on success, `false` on error
+image_coefficients(
+    _pappl_image_coef_t *coef,		// O - Coefficients
+    int                 src,		// I - Number of source pixels
+    int                 dst,		// I - Number of scaled pixels
+    int                 first,		// I - First scaled pixel
+    int                 count,		// I - Number of scaled pixels to compute
+    bool                reverse)	// I - `true` to mirror the source pixels
 {
-  const char		*filename;	// JPEG filename
-  FILE			*fp;		// JPEG file
-  pappl_pr_options_t	*options = NULL;// Job options
-  struct jpeg_decompress_struct	dinfo;	// Decompressor info
-  int			ppi;		// Pixels per inch
-  _pappl_jpeg_err_t	jerr;		// Error handler info
-  unsigned char		*pixels = NULL;	// Image pixels
-  JSAMPROW		row;		// Sample row pointer
-  bool			ret = false;	// Return value
-
-
-  (void)data;
-
-  // Open the JPEG file...
-  filename = papplJobGetFilename(job);
-  if ((fp = fopen(filename, "rb")) == NULL)
+  int		i,			// Looping var
+		t,			// Current tap
+		ntaps,			// Number of taps
+		p0,			// First source pixel
+		largest,		// Largest tap
+		total;			// Total of fixed-point weights
+  unsigned	*weights;		// Weights for scaled pixel
+  double	scale = (double)dst / (double)src,
+					// Scaling factor
+		start,			// Start of scaled pixel in source
+		end,			// End of scaled pixel in source
+		*fw = NULL,		// Floating point weights
+		sum;			// Sum of weights
+
+
+  coef->count   = count;
+  coef->maxtaps = dst < src ? src / dst + 2 : 2;
+  coef->first   = calloc((size_t)count, sizeof(int));
+  coef->ntaps   = calloc((size_t)count, sizeof(int));
+  coef->weights = calloc((size_t)count * (size_t)coef->maxtaps, sizeof(unsigned));
+  fw            = calloc((size_t)coef->maxtaps, sizeof(double));
+
+  if (!coef->first || !coef->ntaps || !coef->weights || !fw)
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, strerror(errno));
+    free(fw);
     return (false);
   }
 
-  // Read the image header...
-  jpeg_std_error(&jerr.jerr);
-  jerr.jerr.error_exit = jpeg_error_handler;
-
-  if (setjmp(jerr.retbuf))
+  for (i = 0; i < count; i ++)
   {
-    // JPEG library errors are directed to this point...
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, jerr.message);
-    ret = false;
-    goto finish_jpeg;
+    if (dst < src)
+    {
+      // Area-average the source pixels covered by the scaled pixel...
+      start = (first + i) / scale;
+      end   = (first + i + 1) / scale;
+      p0    = (int)start;
+
+      for (ntaps = 0, sum = 0.0; ntaps < coef->maxtaps && (p0 + ntaps) < src && (p0 + ntaps) < end; ntaps ++)
+      {
+        fw[ntaps] = ((p0 + ntaps + 1) < end ? (p0 + ntaps + 1) : end) - ((p0 + ntaps) > start ? (p0 + ntaps) : start);
+        sum       += fw[ntaps];
+      }
+    }
+    else
+    {
+      // Interpolate between the two nearest source pixels...
+      if ((start = (first + i + 0.5) / scale - 0.5) < 0.0)
+        start = 0.0;
+
+      if ((p0 = (int)start) >= (src - 1))
+      {
+        p0    = src - 1;
+        fw[0] = 1.0;
+        ntaps = 1;
+      }
+      else
+      {
+        fw[0] = 1.0 - (start - p0);
+        fw[1] = start - p0;
+        ntaps = 2;
+      }
+
+      sum = 1.0;
+    }
+
+    if (ntaps == 0 || sum <= 0.0)
+    {
+      // Use the nearest pixel...
+      fw[0] = sum = 1.0;
+      ntaps = 1;
+      if (p0 >= src)
+        p0 = src - 1;
+    }
+
+    // Convert to fixed-point, making sure the weights add up to 4096...
+    weights = coef->weights + i * coef->maxtaps;
+
+    for (t = 0, total = 0, largest = 0; t < ntaps; t ++)
+    {
+      weights[t] = (unsigned)(4096.0 * fw[t] / sum + 0.5);
+      total      += (int)weights[t];
+
+      if (weights[t] > weights[largest])
+        largest = t;
+    }
+
+    weights[largest] = (unsigned)((int)weights[largest] + 4096 - total);
+
+    if (reverse)
+    {
+      // Mirror the source pixels...
+      for (t = 0; t < ntaps / 2; t ++)
+      {
+        unsigned temp = weights[t];	// Temporary weight
+
+        weights[t]             = weights[ntaps - 1 - t];
+        weights[ntaps - 1 - t] = temp;
+      }
+
+      p0 = src - p0 - ntaps;
+    }
+
+    coef->first[i] = p0;
+    coef->ntaps[i] = ntaps;
   }
 
-  dinfo.err = (struct jpeg_error_mgr *)&jerr;
-  jpeg_create_decompress(&dinfo);
-  jpeg_stdio_src(&dinfo, fp);
-  jpeg_read_header(&dinfo, TRUE);
+  free(fw);
 
-  // Get job options and request the image data in the format we need...
-  options = papplJobCreatePrintOptions(job, 1, dinfo.num_components > 1);
+  return (true);
+}
 
-  dinfo.quantize_colors = FALSE;
 
-  if (options->header.cupsNumColors == 1)
+//
+// 'image_layout()' - Compute the placement and size of an image on the page.
+//
+// This function resolves the "orientation-requested" and "print-scaling"
+// values for the image and computes the imageable area and the scaled image
+// size in device pixels.  The resolved values are stored back in the print
+// options so that calling this function again gives the same result.
+//
+
+static bool				// O - `true` on success, `false` on error
+image_layout(
+    pappl_job_t           *job,		// I - Job
+    pappl_pr_options_t    *options,	// I - Print options
+    int                   width,	// I - Width in columns
+    int                   height,	// I - Height in lines
+    int                   *ppi,		// IO - Pixels per inch (`0` for unknown)
+    _pappl_image_layout_t *layout)	// O - Image layout
+{
+  int	img_width,			// Rotated image width
+	img_height,			// Rotated image height
+	xsize,				// Scaled width
+	ysize;				// Scaled height
+
+
+  if (options->print_scaling == PAPPL_SCALING_FILL)
   {
-    dinfo.out_color_space      = JCS_GRAYSCALE;
-    dinfo.out_color_components = 1;
-    dinfo.output_components    = 1;
+    // Scale to fill the entire media area...
+    layout->ileft   = 0;
+    layout->itop    = 0;
+    layout->iwidth  = (int)options->header.cupsWidth;
+    layout->iheight = (int)options->header.cupsHeight;
   }
   else
   {
-    dinfo.out_color_space      = JCS_RGB;
-    dinfo.out_color_components = 3;
-    dinfo.output_components    = 3;
+    // Scale/center within the margins...
+    layout->ileft   = options->media.left_margin * options->printer_resolution[0] / 2540;
+    layout->itop    = options->media.top_margin * options->printer_resolution[1] / 2540;
+    layout->iwidth  = (int)options->header.cupsWidth - (options->media.left_margin + options->media.right_margin) * options->printer_resolution[0] / 2540;
+    layout->iheight = (int)options->header.cupsHeight - (options->media.bottom_margin + options->media.top_margin) * options->printer_resolution[1] / 2540;
   }
 
-  jpeg_calc_output_dimensions(&dinfo);
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ileft=%d, itop=%d, iwidth=%d, iheight=%d", layout->ileft, layout->itop, layout->iwidth, layout->iheight);
 
-  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Loading %dx%dx%d JPEG image.", dinfo.output_width, dinfo.output_height, dinfo.output_components);
+  if (layout->iwidth <= 0 || layout->iheight <= 0 || width <= 0 || height <= 0)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Invalid media size");
+    return (false);
+  }
 
-  if ((pixels = (unsigned char *)malloc((size_t)(dinfo.output_width * dinfo.output_height * (unsigned)dinfo.output_components))) == NULL)
+  // Figure out the rotation of the image...
+  if (options->orientation_requested == IPP_ORIENT_NONE)
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for %dx%dx%d JPEG image.", dinfo.output_width, dinfo.output_height, dinfo.output_components);
-    papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
-    goto finish_jpeg;
+    if (width > height && options->header.cupsWidth < options->header.cupsHeight)
+    {
+      options->orientation_requested = IPP_ORIENT_LANDSCAPE;
+      papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Auto-orientation: landscape");
+    }
+    else
+    {
+      options->orientation_requested = IPP_ORIENT_PORTRAIT;
+      papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Auto-orientation: portrait");
+    }
   }
 
-  jpeg_start_decompress(&dinfo);
+  if (options->orientation_requested == IPP_ORIENT_LANDSCAPE || options->orientation_requested == IPP_ORIENT_REVERSE_LANDSCAPE)
+  {
+    img_width  = height;
+    img_height = width;
+  }
+  else
+  {
+    img_width  = width;
+    img_height = height;
+  }
 
-  while (dinfo.output_scanline < dinfo.output_height)
+  // Then the scaling...
+  if (options->print_scaling == PAPPL_SCALING_AUTO || options->print_scaling == PAPPL_SCALING_AUTO_FIT)
   {
-    row = (JSAMPROW)(pixels + (size_t)dinfo.output_scanline * (size_t)dinfo.output_width * (size_t)dinfo.output_components);
-    jpeg_read_scanlines(&dinfo, &row, 1);
+    if (*ppi <= 0)
+    {
+      // No resolution information, so just force scaling the image to fit/fill
+      xsize = layout->iwidth + 1;
+      ysize = layout->iheight + 1;
+    }
+    else
+    {
+      xsize = img_width * options->printer_resolution[0] / *ppi;
+      ysize = img_height * options->printer_resolution[1] / *ppi;
+    }
+
+    if (xsize > layout->iwidth || ysize > layout->iheight)
+    {
+      // Scale to fit/fill based on "print-scaling" and margins...
+      if (options->print_scaling == PAPPL_SCALING_AUTO && options->media.bottom_margin == 0 && options->media.left_margin == 0 && options->media.right_margin == 0 && options->media.top_margin == 0)
+        options->print_scaling = PAPPL_SCALING_FILL;
+      else
+        options->print_scaling = PAPPL_SCALING_FIT;
+    }
+    else
+    {
+      // Do no scaling...
+      options->print_scaling = PAPPL_SCALING_NONE;
+    }
+  }
+  else if (options->print_scaling == PAPPL_SCALING_NONE && *ppi <= 0)
+  {
+    // Force a default PPI value of 200, which fits a typical 1080p sized
+    // screenshot on a standard letter/A4 page.
+    *ppi = 200;
   }
 
-  if (dinfo.X_density != dinfo.Y_density)
+  if (options->print_scaling == PAPPL_SCALING_NONE)
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unsupported non-square JPEG resolution %ux%u%s, using default.", dinfo.X_density, dinfo.Y_density, dinfo.density_unit == 1 ? "dpi" : dinfo.density_unit == 2 ? "dpcm" : "???");
-    ppi = 0;
+    // No scaling
+    xsize = img_width * options->printer_resolution[0] / *ppi;
+    ysize = img_height * options->printer_resolution[1] / *ppi;
   }
   else
   {
-    switch (dinfo.density_unit)
+    // Fit/fill
+    xsize = layout->iwidth;
+    ysize = xsize * img_height / img_width;
+
+    if ((ysize > layout->iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < layout->iheight && options->print_scaling == PAPPL_SCALING_FILL))
     {
-      default :
-      case 0 : // Unknown units
-          ppi = 0;
-          break;
-      case 1 : // Dots-per-inch
-          ppi = dinfo.X_density;
-          break;
-      case 2 : // Dots-per-centimeter
-          ppi = dinfo.X_density * 254 / 100;
-          break;
+      ysize = layout->iheight;
+      xsize = ysize * img_width / img_height;
     }
   }
 
-  ret = papplJobFilterImage(job, device, options, pixels, (int)dinfo.output_width, (int)dinfo.output_height, dinfo.output_components, ppi, true);
+  layout->xsize = xsize > 0 ? xsize : 1;
+  layout->ysize = ysize > 0 ? ysize : 1;
 
-  finish_jpeg:
+  return (true);
+}
 
-  papplJobDeletePrintOptions(options);
-  free(pixels);
-  jpeg_finish_decompress(&dinfo);
-  jpeg_destroy_decompress(&dinfo);
-  fclose(fp);
+
+//
+// 'image_rotate()' - Rotate rows of an image into a band buffer.
+//
+// Each rotated row is a column of the original image.  The "xmap" array
+// lists the position in the rotated row for each column of the band, or
+// `NULL` to copy the whole rotated row.  The image is read row by row so that
+// each cache line is only loaded once per band.
+//
+
+static void
+image_rotate(
+    const unsigned char *pixels,	// I - Pointer to the top-left corner of the image data
+    int                 width,		// I - Width in columns
+    int                 height,		// I - Height in lines
+    int                 depth,		// I - Bytes per pixel
+    ipp_orient_t        orientation,	// I - Landscape or reverse landscape
+    const int           *rows,		// I - Rotated rows to copy
+    int                 count,		// I - Number of rotated rows
+    const int           *xmap,		// I - Rotated row positions or `NULL`
+    int                 xcount,		// I - Number of columns in band
+    unsigned char       *band)		// O - Band buffer
+{
+  int			i,		// Looping var
+			x,		// Column in band
+			srcx;		// Position in rotated row
+  int			cols[_PAPPL_IMAGE_BAND];
+					// Image columns
+  size_t		rowsize = (size_t)xcount * (size_t)depth;
+					// Bytes per band row
+  const unsigned char	*pixptr;	// Pointer into image
+  unsigned char		*bandptr;	// Pointer into band
+
+
+  // Landscape (90 counter-clockwise) rotated rows are columns from the right,
+  // top down, while reverse landscape (90 clockwise) rotated rows are columns
+  // from the left, bottom up...
+  for (i = 0; i < count; i ++)
+    cols[i] = (orientation == IPP_ORIENT_LANDSCAPE ? width - 1 - rows[i] : rows[i]) * depth;
+
+  for (x = 0; x < xcount; x ++, band += depth)
+  {
+    srcx   = xmap ? xmap[x] : x;
+    pixptr = pixels + (size_t)(orientation == IPP_ORIENT_LANDSCAPE ? srcx : height - 1 - srcx) * (size_t)width * (size_t)depth;
+
+    if (depth == 1)
+    {
+      for (i = 0, bandptr = band; i < count; i ++, bandptr += rowsize)
+        *bandptr = pixptr[cols[i]];
+    }
+    else
+    {
+      for (i = 0, bandptr = band; i < count; i ++, bandptr += rowsize)
+      {
+        bandptr[0] = pixptr[cols[i]];
+        bandptr[1] = pixptr[cols[i] + 1];
+        bandptr[2] = pixptr[cols[i] + 2];
+      }
+    }
+  }
+}
+
+
+//
+// 'image_row()' - Get a row from a streamed image.
+//
+// Rows are read from the decoder as needed.  The most recent "numrows" rows
+// remain available.
+//
+
+static const unsigned char *		// O - Pointer to row or `NULL` on error
+image_row(
+    _pappl_image_stream_t *stream,	// I - Image stream
+    int                   y)		// I - Row number
+{
+  unsigned char	*row;			// Pointer to row
+
+
+  if (y < (stream->nextrow - stream->numrows))
+    return (NULL);
+
+  while (stream->nextrow <= y)
+  {
+    row = stream->rows + (size_t)(stream->nextrow % stream->numrows) * stream->rowsize;
+
+    if (!(stream->cb)(stream->cb_data, row))
+      return (NULL);
+
+    stream->nextrow ++;
+  }
+
+  return (stream->rows + (size_t)(y % stream->numrows) * stream->rowsize);
+}
+
+
+#ifdef HAVE_LIBJPEG
+//
+// 'jpeg_error_handler()' - Handle JPEG errors by not exiting.
+//
+
+static void
+jpeg_error_handler(j_common_ptr p)	// I - JPEG data
+{
+  _pappl_jpeg_err_t	*jerr = (_pappl_jpeg_err_t *)p->err;
+					// JPEG error handler
+
+
+  // Save the error message in the string buffer...
+  (jerr->jerr.format_message)(p, jerr->message);
+
+  // Return to the point we called setjmp()...
+  longjmp(jerr->retbuf, 1);
+}
+
+
+//
+// 'jpeg_read_row()' - Read the next row from a JPEG image.
+//
+
+static bool				// O - `true` on success, `false` on error
+jpeg_read_row(
+    j_decompress_ptr dinfo,		// I - Decompressor info
+    unsigned char    *row)		// I - Row buffer
+{
+  _pappl_jpeg_err_t	*jerr = (_pappl_jpeg_err_t *)dinfo->err;
+					// JPEG error handler
+  jmp_buf		retbuf;		// Saved setjmp() return buffer
+  JSAMPROW		samprow = row;	// Sample row pointer
+  bool			ret;		// Return value
+
+
+  // Catch errors here rather than in _papplJobFilterJPEG, since we are
+  // called while the driver is printing...
+  memcpy(retbuf, jerr->retbuf, sizeof(retbuf));
+
+  if (setjmp(jerr->retbuf))
+  {
+    papplLogJob((pappl_job_t *)dinfo->client_data, PAPPL_LOGLEVEL_ERROR, "Unable to read JPEG image: %s", jerr->message);
+    ret = false;
+  }
+  else
+  {
+    ret = jpeg_read_scanlines(dinfo, &samprow, 1) == 1;
+  }
+
+  memcpy(jerr->retbuf, retbuf, sizeof(retbuf));
 
   return (ret);
 }
 #endif // HAVE_LIBJPEG
 
 
+#ifdef HAVE_LIBPNG
 //
-// 'process_png()' - Process a PNG image file.
+// 'png_error_handler()' - Handle PNG errors by logging them.
 //
 
-#ifdef HAVE_LIBPNG
-bool					// O - `true` on success and `false` otherwise
-_papplJobFilterPNG(
-    pappl_job_t    *job,		// I - Job
-    pappl_device_t *device,		// I - Device
-    void           *data)		// I - Filter data (unused)
+static void
+png_error_handler(
+    png_structp     pp,			// I - PNG read data
+    png_const_charp message)		// I - Error message
 {
-  pappl_pr_options_t	*options = NULL;// Job options
-  png_image		png;		// PNG image data
-  png_color		bg;		// Background color
-  int			png_bpp;	// Bytes per pixel
-  unsigned char		*pixels = NULL;	// Image pixels
-  bool			ret = false;	// Return value
+  papplLogJob((pappl_job_t *)png_get_error_ptr(pp), PAPPL_LOGLEVEL_ERROR, "Unable to read PNG image: %s", message);
 
+  png_longjmp(pp, 1);
+}
 
-  // Load the PNG...
-  (void)data;
 
-  memset(&png, 0, sizeof(png));
-  png.version = PNG_IMAGE_VERSION;
+//
+// 'png_read_row_cb()' - Read the next row from a PNG image.
+//
 
-  bg.red = bg.green = bg.blue = 255;
+static bool				// O - `true` on success, `false` on error
+png_read_row_cb(
+    _pappl_png_stream_t *png,		// I - PNG streaming data
+    unsigned char       *row)		// I - Row buffer
+{
+  int			count;		// Number of values
+  const unsigned char	*bufptr;	// Pointer into decoded row
+  unsigned		alpha;		// Alpha value
 
-  png_image_begin_read_from_file(&png, job->filename);
 
-  if (png.warning_or_error & PNG_IMAGE_ERROR)
+  if (setjmp(png_jmpbuf(png->pp)))
+    return (false);
+
+  if (png->channels == png->depth)
   {
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", job->filename, png.message);
-    goto finish_job;
+    // No alpha, read directly into the row...
+    png_read_row(png->pp, row, NULL);
+    return (true);
   }
 
-  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "PNG image is %ux%u", png.width, png.height);
+  // Composite the image over a white background...
+  png_read_row(png->pp, png->buffer, NULL);
 
-  // Prepare options...
-  options = papplJobCreatePrintOptions(job, 1, (png.format & PNG_FORMAT_FLAG_COLOR) != 0);
-
-  if (options->header.cupsNumColors > 1)
+  for (bufptr = png->buffer, count = png->width; count > 0; count --, bufptr += png->channels, row += png->depth)
   {
-    png.format = PNG_FORMAT_RGB;
-    png_bpp    = 3;
+    alpha = bufptr[png->depth];
+
+    row[0] = (unsigned char)((bufptr[0] * alpha + 255 * (255 - alpha)) / 255);
+
+    if (png->depth == 3)
+    {
+      row[1] = (unsigned char)((bufptr[1] * alpha + 255 * (255 - alpha)) / 255);
+      row[2] = (unsigned char)((bufptr[2] * alpha + 255 * (255 - alpha)) / 255);
+    }
   }
-  else
+
+  return (true);
+}
+
+
+//
+// 'png_stream_image()' - Print a PNG image one row at a time.
+//
+// Interlaced PNG images cannot be streamed, in which case `-1` is returned and
+// nothing is printed.
+//
+
+static int				// O - `1` on success, `0` on error, `-1` if the image cannot be streamed
+png_stream_image(
+    pappl_job_t        *job,		// I - Job
+    pappl_device_t     *device,		// I - Device
+    pappl_pr_options_t *options,	// I - Print options
+    int                ppi)		// I - Pixels per inch (`0` for unknown)
+{
+  FILE			*fp;		// PNG file
+  _pappl_png_stream_t	png;		// PNG streaming data
+  _pappl_image_stream_t	stream;		// Image stream
+  int			color_type;	// PNG color type
+  int			ret = 0;	// Return value
+
+
+  if ((fp = fopen(job->filename, "rb")) == NULL)
   {
-    png.format = PNG_FORMAT_GRAY;
-    png_bpp    = 1;
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", job->filename, strerror(errno));
+    return (0);
   }
 
-  pixels = malloc(PNG_IMAGE_SIZE(png));
+  memset(&png, 0, sizeof(png));
+  png.job   = job;
+  png.depth = options->header.cupsNumColors > 1 ? 3 : 1;
 
-  png_image_finish_read(&png, &bg, pixels, 0, NULL);
+  if ((png.pp = png_create_read_struct(PNG_LIBPNG_VER_STRING, job, png_error_handler, png_warning_handler)) == NULL || (png.info = png_create_info_struct(png.pp)) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG image.");
+    goto finish_png;
+  }
 
-  if (png.warning_or_error & PNG_IMAGE_ERROR)
+  if (setjmp(png_jmpbuf(png.pp)))
   {
     papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", job->filename, png.message);
-    goto finish_job;
+    ret = 0;
+    goto finish_png;
   }
 
-  // TODO: Get PNG image resolution information (Issue #65)
+  png_init_io(png.pp, fp);
+  png_read_info(png.pp, png.info);
+
+  if (png_get_interlace_type(png.pp, png.info) != PNG_INTERLACE_NONE)
+  {
+    ret = -1;
+    goto finish_png;
+  }
+
+  // Request 8-bit grayscale or sRGB pixels, with alpha if present...
+  color_type = png_get_color_type(png.pp, png.info);
+
+  png_set_expand(png.pp);
+  png_set_strip_16(png.pp);
+
+  if (png.depth == 1 && (color_type & PNG_COLOR_MASK_COLOR))
+    png_set_rgb_to_gray_fixed(png.pp, PNG_ERROR_ACTION_NONE, -1, -1);
+  else if (png.depth == 3 && !(color_type & PNG_COLOR_MASK_COLOR))
+    png_set_gray_to_rgb(png.pp);
+
+  png_read_update_info(png.pp, png.info);
+
+  png.width    = (int)png_get_image_width(png.pp, png.info);
+  png.channels = png_get_channels(png.pp, png.info);
+
+  if (png.channels != png.depth && (png.buffer = malloc((size_t)png.width * (size_t)png.channels)) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG image.");
+    goto finish_png;
+  }
 
   // Print the image...
-  ret = papplJobFilterImage(job, device, options, pixels, (int)png.width, (int)png.height, png_bpp, 0, false);
+  memset(&stream, 0, sizeof(stream));
+  stream.cb      = (_pappl_image_cb_t)png_read_row_cb;
+  stream.cb_data = &png;
+  stream.rowsize = (size_t)png.width * (size_t)png.depth;
 
-  finish_job:
+  ret = filter_image(job, device, options, NULL, &stream, png.width, (int)png_get_image_height(png.pp, png.info), png.depth, ppi, false) ? 1 : 0;
 
-  papplJobDeletePrintOptions(options);
+  finish_png:
 
-  // Free the image data when we're done...
-  png_image_free(&png);
-  free(pixels);
+  png_destroy_read_struct(&png.pp, &png.info, NULL);
+  free(png.buffer);
+  fclose(fp);
 
   return (ret);
 }
-#endif // HAVE_LIBPNG
 
 
-#ifdef HAVE_LIBJPEG
 //
-// 'jpeg_error_handler()' - Handle JPEG errors by not exiting.
+// 'png_warning_handler()' - Log PNG warnings.
 //
 
 static void
-jpeg_error_handler(j_common_ptr p)	// I - JPEG data
+png_warning_handler(
+    png_structp     pp,			// I - PNG read data
+    png_const_charp message)		// I - Warning message
 {
-  _pappl_jpeg_err_t	*jerr = (_pappl_jpeg_err_t *)p->err;
-					// JPEG error handler
-
-
-  // Save the error message in the string buffer...
-  (jerr->jerr.format_message)(p, jerr->message);
-
-  // Return to the point we called setjmp()...
-  longjmp(jerr->retbuf, 1);
+  papplLogJob((pappl_job_t *)png_get_error_ptr(pp), PAPPL_LOGLEVEL_WARN, "PNG image: %s", message);
 }
-#endif // HAVE_LIBJPEG
+#endif // HAVE_LIBPNG
@@ -31,6 +31,7 @@ typedef struct _pappl_attr_s		// Input attribute structure
 // Local functions...
 //
 
+static void		copy_compact_attributes(pappl_client_t *client, pappl_job_t *job, _pappl_ra_t *ra);
 static void		ipp_cancel_job(pappl_client_t *client);
 static void		ipp_close_job(pappl_client_t *client);
 static void		ipp_get_job_attributes(pappl_client_t *client);
@@ -45,14 +46,23 @@ void
 _papplJobCopyAttributes(
     pappl_client_t *client,		// I - Client
     pappl_job_t    *job,		// I - Job
-    cups_array_t   *ra)			// I - requested-attributes
+    _pappl_ra_t    *ra)			// I - requested-attributes
 {
-  _papplCopyAttributes(client->response, job->attrs, ra, IPP_TAG_JOB, 0);
+  _papplJobLoadAttributes(job);
 
-  if (!ra || cupsArrayFind(ra, "date-time-at-creation"))
+  pthread_rwlock_rdlock(&job->rwlock);
+
+  if (job->is_compact)
+    copy_compact_attributes(client, job, ra);
+  else
+    _papplCopyAttributes(client->response, job->attrs, ra, IPP_TAG_JOB, 0);
+
+  pthread_rwlock_unlock(&job->rwlock);
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_DATE_TIME_AT_CREATION))
     ippAddDate(client->response, IPP_TAG_JOB, "date-time-at-creation", ippTimeToDate(job->created));
 
-  if (!ra || cupsArrayFind(ra, "date-time-at-completed"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_DATE_TIME_AT_COMPLETED))
   {
     if (job->completed)
       ippAddDate(client->response, IPP_TAG_JOB, "date-time-at-completed", ippTimeToDate(job->completed));
@@ -60,7 +70,7 @@ _papplJobCopyAttributes(
       ippAddOutOfBand(client->response, IPP_TAG_JOB, IPP_TAG_NOVALUE, "date-time-at-completed");
   }
 
-  if (!ra || cupsArrayFind(ra, "date-time-at-processing"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_DATE_TIME_AT_PROCESSING))
   {
     if (job->processing)
       ippAddDate(client->response, IPP_TAG_JOB, "date-time-at-processing", ippTimeToDate(job->processing));
@@ -68,19 +78,19 @@ _papplJobCopyAttributes(
       ippAddOutOfBand(client->response, IPP_TAG_JOB, IPP_TAG_NOVALUE, "date-time-at-processing");
   }
 
-  if (!ra || cupsArrayFind(ra, "job-impressions"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_IMPRESSIONS))
     ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_INTEGER, "job-impressions", job->impressions);
 
-  if (!ra || cupsArrayFind(ra, "job-impressions-completed"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_IMPRESSIONS_COMPLETED))
     ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_INTEGER, "job-impressions-completed", job->impcompleted);
 
-  if (!ra || cupsArrayFind(ra, "job-printer-up-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_PRINTER_UP_TIME))
     ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_INTEGER, "job-printer-up-time", (int)(time(NULL) - client->printer->start_time));
 
-  if (!ra || cupsArrayFind(ra, "job-state"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_STATE))
     ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_ENUM, "job-state", (int)job->state);
 
-  if (!ra || cupsArrayFind(ra, "job-state-message"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_STATE_MESSAGE))
   {
     if (job->message)
     {
@@ -129,7 +139,7 @@ _papplJobCopyAttributes(
     }
   }
 
-  if (!ra || cupsArrayFind(ra, "job-state-reasons"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_STATE_REASONS))
   {
     if (job->state_reasons)
     {
@@ -186,13 +196,13 @@ _papplJobCopyAttributes(
     }
   }
 
-  if (!ra || cupsArrayFind(ra, "time-at-creation"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_TIME_AT_CREATION))
     ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_INTEGER, "time-at-creation", (int)(job->created - client->printer->start_time));
 
-  if (!ra || cupsArrayFind(ra, "time-at-completed"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_TIME_AT_COMPLETED))
     ippAddInteger(client->response, IPP_TAG_JOB, job->completed ? IPP_TAG_INTEGER : IPP_TAG_NOVALUE, "time-at-completed", (int)(job->completed - client->printer->start_time));
 
-  if (!ra || cupsArrayFind(ra, "time-at-processing"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_TIME_AT_PROCESSING))
     ippAddInteger(client->response, IPP_TAG_JOB, job->processing ? IPP_TAG_INTEGER : IPP_TAG_NOVALUE, "time-at-processing", (int)(job->processing - client->printer->start_time));
 }
 
@@ -210,7 +220,22 @@ _papplJobCopyDocumentData(
   char			filename[1024],	// Filename buffer
 			buffer[4096];	// Copy buffer
   ssize_t		bytes;		// Bytes read
-  cups_array_t		*ra;		// Attributes to send in response
+  _pappl_ra_t		*ra;		// Attributes to send in response
+  static const char * const job_attrs[] =
+  {					// Attributes for a queued job
+    "job-id",
+    "job-state",
+    "job-state-message",
+    "job-state-reasons",
+    "job-uri"
+  };
+  static const char * const abort_attrs[] =
+  {					// Attributes for an aborted job
+    "job-id",
+    "job-state",
+    "job-state-reasons",
+    "job-uri"
+  };
 
 
   // If we have a PWG or Apple raster file, process it directly or return
@@ -292,17 +317,16 @@ _papplJobCopyDocumentData(
   complete_job:
 
   // Return the job info...
-  papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
+  if (!_papplCreateRequestedNames(sizeof(job_attrs) / sizeof(job_attrs[0]), job_attrs, &ra))
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_INTERNAL, "Unable to allocate memory.");
+    return;
+  }
 
-  ra = cupsArrayNew((cups_array_func_t)strcmp, NULL);
-  cupsArrayAdd(ra, "job-id");
-  cupsArrayAdd(ra, "job-state");
-  cupsArrayAdd(ra, "job-state-message");
-  cupsArrayAdd(ra, "job-state-reasons");
-  cupsArrayAdd(ra, "job-uri");
+  papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
   _papplJobCopyAttributes(client, job, ra);
-  cupsArrayDelete(ra);
+  _papplDeleteRequested(ra);
   return;
 
   // If we get here we had to abort the job...
@@ -318,19 +342,19 @@ _papplJobCopyDocumentData(
   cupsArrayRemove(client->printer->active_jobs, job);
   cupsArrayAdd(client->printer->completed_jobs, job);
 
-  if (!client->system->clean_time)
-    client->system->clean_time = time(NULL) + 60;
+  _papplJobRemoveAttributes(job);
+  _papplJobScheduleCleanup(job);
+  _papplPrinterAddEvent(job->printer, job, _PAPPL_EVENT_JOB_COMPLETED | _PAPPL_EVENT_JOB_STATE_CHANGED);
 
   pthread_rwlock_unlock(&client->printer->rwlock);
 
-  ra = cupsArrayNew((cups_array_func_t)strcmp, NULL);
-  cupsArrayAdd(ra, "job-id");
-  cupsArrayAdd(ra, "job-state");
-  cupsArrayAdd(ra, "job-state-reasons");
-  cupsArrayAdd(ra, "job-uri");
-
-  _papplJobCopyAttributes(client, job, ra);
-  cupsArrayDelete(ra);
+  // The response already has the error status, so only add the job attributes
+  // if we can...
+  if (_papplCreateRequestedNames(sizeof(abort_attrs) / sizeof(abort_attrs[0]), abort_attrs, &ra))
+  {
+    _papplJobCopyAttributes(client, job, ra);
+    _papplDeleteRequested(ra);
+  }
 }
 
 
@@ -498,6 +522,57 @@ _papplJobValidateDocumentAttributes(
 }
 
 
+//
+// 'copy_compact_attributes()' - Copy the description attributes of a compacted job.
+//
+// Compacted (and archived) jobs no longer have their creation attributes, so
+// the job description attributes are recreated from the job values.
+//
+
+static void
+copy_compact_attributes(
+    pappl_client_t *client,		// I - Client
+    pappl_job_t    *job,		// I - Job
+    _pappl_ra_t    *ra)			// I - requested-attributes
+{
+  pappl_printer_t	*printer = job->printer;
+					// Printer
+  char			uri[1024],	// job-uri/job-printer-uri value
+			uuid[64];	// job-uuid value
+
+
+  if (job->format && _PAPPL_REQUESTED(ra, _PAPPL_ATTR_DOCUMENT_FORMAT))
+    ippAddString(client->response, IPP_TAG_JOB, IPP_TAG_MIMETYPE, "document-format", NULL, job->format);
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_ID))
+    ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_INTEGER, "job-id", job->job_id);
+
+  if (job->name && _PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_NAME))
+    ippAddString(client->response, IPP_TAG_JOB, IPP_TAG_NAME, "job-name", NULL, job->name);
+
+  if (job->username && _PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_ORIGINATING_USER_NAME))
+    ippAddString(client->response, IPP_TAG_JOB, IPP_TAG_NAME, "job-originating-user-name", NULL, job->username);
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_PRINTER_URI))
+  {
+    httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipps", NULL, printer->system->hostname, printer->system->port, printer->resource);
+    ippAddString(client->response, IPP_TAG_JOB, IPP_TAG_URI, "job-printer-uri", NULL, uri);
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_URI))
+  {
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipps", NULL, printer->system->hostname, printer->system->port, "%s/%d", printer->resource, job->job_id);
+    ippAddString(client->response, IPP_TAG_JOB, IPP_TAG_URI, "job-uri", NULL, uri);
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_JOB_UUID))
+  {
+    _papplSystemMakeUUID(printer->system, printer->name, job->job_id, uuid, sizeof(uuid));
+    ippAddString(client->response, IPP_TAG_JOB, IPP_TAG_URI, "job-uuid", NULL, uuid);
+  }
+}
+
+
 //
 // 'ipp_cancel_job()' - Cancel a job.
 //
@@ -600,7 +675,7 @@ ipp_get_job_attributes(
     pappl_client_t *client)		// I - Client
 {
   pappl_job_t	*job = client->job;	// Job information
-  cups_array_t	*ra;			// requested-attributes
+  _pappl_ra_t	*ra;			// requested-attributes
 
 
   if (!job)
@@ -609,11 +684,16 @@ ipp_get_job_attributes(
     return;
   }
 
+  if (!_papplCreateRequested(client->request, &ra))
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_INTERNAL, "Unable to allocate memory.");
+    return;
+  }
+
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
-  ra = ippCreateRequestedArray(client->request);
   _papplJobCopyAttributes(client, job, ra);
-  cupsArrayDelete(ra);
+  _papplDeleteRequested(ra);
 }
 
 
@@ -690,6 +770,7 @@ ipp_send_document(
     job->state = IPP_JSTATE_ABORTED;
 
   // Then finish getting the document data and process things...
+  pthread_rwlock_wrlock(&job->rwlock);
   pthread_rwlock_wrlock(&(client->printer->rwlock));
 
   _papplCopyAttributes(job->attrs, client->request, NULL, IPP_TAG_JOB, 0);
@@ -702,6 +783,11 @@ ipp_send_document(
     job->format = client->printer->driver_data.format;
 
   pthread_rwlock_unlock(&(client->printer->rwlock));
+  pthread_rwlock_unlock(&job->rwlock);
+
+  // Update the saved job attributes with the document attributes after the
+  // printer is unlocked...
+  _papplJobSaveAttributes(job);
 
   if (have_data)
     _papplJobCopyDocumentData(client, job);
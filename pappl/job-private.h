@@ -23,6 +23,14 @@
 extern char **environ;
 
 
+//
+// Constants...
+//
+
+#  define _PAPPL_MAX_ARCHIVED_JOBS 25000
+					// Maximum number of records in a job history archive file
+
+
 //
 // Types and structures...
 //
@@ -30,6 +38,7 @@ extern char **environ;
 struct _pappl_job_s			// Job data
 {
   pthread_rwlock_t	rwlock;			// Reader/writer lock
+  int			refcount;		// Number of references
   pappl_system_t	*system;		// Containing system
   pappl_printer_t	*printer;		// Containing printer
   int			job_id;			// "job-id" value
@@ -47,12 +56,30 @@ struct _pappl_job_s			// Job data
   int			impressions,		// "job-impressions" value
 			impcompleted;		// "job-impressions-completed" value
   ipp_t			*attrs;			// Static attributes
+  bool			attrs_deferred;		// Attributes still need to be loaded from the spool directory?
+  bool			is_compact;		// Have the attributes been freed and the strings interned?
   char			*filename;		// Print file name
   int			fd;			// Print file descriptor
   bool			streaming;		// Streaming job?
   void			*data;			// Per-job driver data
 };
 
+typedef struct _pappl_jobrec_s		// Job history archive record
+{
+  int32_t		job_id,			// "job-id" value
+			state,			// "job-state" value
+			state_reasons,		// "job-state-reasons" values
+			impressions,		// "job-impressions" value
+			impcompleted,		// "job-impressions-completed" value
+			reserved;		// Reserved for future use
+  int64_t		created,		// "[date-]time-at-creation" value
+			processing,		// "[date-]time-at-processing" value
+			completed;		// "[date-]time-at-completed" value
+  char			username[64],		// "job-originating-user-name" value
+			format[64],		// "document-format" value
+			name[256];		// "job-name" value
+} _pappl_jobrec_t;
+
 
 //
 // Functions...
@@ -61,7 +88,7 @@ struct _pappl_job_s			// Job data
 extern int		_papplJobCompareActive(pappl_job_t *a, pappl_job_t *b) _PAPPL_PRIVATE;
 extern int		_papplJobCompareAll(pappl_job_t *a, pappl_job_t *b) _PAPPL_PRIVATE;
 extern int		_papplJobCompareCompleted(pappl_job_t *a, pappl_job_t *b) _PAPPL_PRIVATE;
-extern void		_papplJobCopyAttributes(pappl_client_t *client, pappl_job_t *job, cups_array_t *ra) _PAPPL_PRIVATE;
+extern void		_papplJobCopyAttributes(pappl_client_t *client, pappl_job_t *job, _pappl_ra_t *ra) _PAPPL_PRIVATE;
 extern void		_papplJobCopyDocumentData(pappl_client_t *client, pappl_job_t *job) _PAPPL_PRIVATE;
 extern pappl_job_t	*_papplJobCreate(pappl_printer_t *printer, int job_id, const char *username, const char *format, const char *job_name, ipp_t *attrs) _PAPPL_PRIVATE;
 extern void		_papplJobDelete(pappl_job_t *job) _PAPPL_PRIVATE;
@@ -71,14 +98,22 @@ extern bool		_papplJobFilterJPEG(pappl_job_t *job, pappl_device_t *device, void
 #  ifdef HAVE_LIBPNG
 extern bool		_papplJobFilterPNG(pappl_job_t *job, pappl_device_t *device, void *data);
 #  endif // HAVE_LIBPNG
+extern bool		_papplJobIsBlankLine(const unsigned char *line, size_t bytes, unsigned char white) _PAPPL_PRIVATE;
+extern void		_papplJobLoadAttributes(pappl_job_t *job) _PAPPL_PRIVATE;
 extern void		*_papplJobProcess(pappl_job_t *job) _PAPPL_PRIVATE;
 extern void		_papplJobProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplJobProcessRaster(pappl_job_t *job, pappl_client_t *client) _PAPPL_PRIVATE;
 extern const char	*_papplJobReasonString(pappl_jreason_t reason) _PAPPL_PRIVATE;
+extern void		_papplJobRelease(pappl_job_t *job) _PAPPL_PRIVATE;
+extern void		_papplJobRemoveAttributes(pappl_job_t *job) _PAPPL_PRIVATE;
 extern void		_papplJobRemoveFile(pappl_job_t *job) _PAPPL_PRIVATE;
+extern pappl_job_t	*_papplJobRetain(pappl_job_t *job) _PAPPL_PRIVATE;
+extern void		_papplJobSaveAttributes(pappl_job_t *job) _PAPPL_PRIVATE;
+extern void		_papplJobScheduleCleanup(pappl_job_t *job) _PAPPL_PRIVATE;
 extern void		_papplJobSetState(pappl_job_t *job, ipp_jstate_t state) _PAPPL_PRIVATE;
 extern void		_papplJobSubmitFile(pappl_job_t *job, const char *filename) _PAPPL_PRIVATE;
 extern bool		_papplJobValidateDocumentAttributes(pappl_client_t *client) _PAPPL_PRIVATE;
+extern bool		_papplJobWriteBlankLines(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device, unsigned y, unsigned count, unsigned char *line) _PAPPL_PRIVATE;
 
 
 #endif // !_PAPPL_JOB_PRIVATE_H_
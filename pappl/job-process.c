@@ -14,13 +14,29 @@
 #include "pappl-private.h"
 
 
+//
+// Local types...
+//
+
+typedef void (*_pappl_convert_cb_t)(unsigned char *dst, const unsigned char *src, unsigned width);
+					// Color conversion function
+
+
 //
 // Local functions...
 //
 
+static void	convert_invert(unsigned char *dst, const unsigned char *src, unsigned width);
+static void	convert_rgb_to_black(unsigned char *dst, const unsigned char *src, unsigned width);
+static void	convert_rgb_to_cmyk(unsigned char *dst, const unsigned char *src, unsigned width);
+static void	convert_rgb_to_white(unsigned char *dst, const unsigned char *src, unsigned width);
 static const char *cups_cspace_string(cups_cspace_t cspace);
+static unsigned char dither_byte(const unsigned char *pixels, const unsigned char *dither);
+static void	dither_line(unsigned char *line, const unsigned char *pixels, unsigned width, const unsigned char *dither, bool black);
 static bool	filter_raw(pappl_job_t *job, pappl_device_t *device);
 static void	finish_job(pappl_job_t *job);
+static _pappl_convert_cb_t get_convert(cups_cspace_t inspace, cups_cspace_t outspace);
+static bool	read_pixels(cups_raster_t *ras, unsigned char *pixels, unsigned bytes, unsigned short *raw);
 static void	start_job(pappl_job_t *job);
 
 
@@ -209,7 +225,7 @@ papplJobCreatePrintOptions(
 
   if (options->print_color_mode == PAPPL_COLOR_MODE_AUTO)
   {
-    if (color)
+    if (color && (printer->driver_data.color_supported & PAPPL_COLOR_MODE_COLOR))
       options->print_color_mode = PAPPL_COLOR_MODE_COLOR;
     else
       options->print_color_mode = PAPPL_COLOR_MODE_MONOCHROME;
@@ -334,6 +350,8 @@ papplJobCreatePrintOptions(
       raster_type = "srgb_8";
     else if (printer->driver_data.raster_types & PAPPL_PWG_RASTER_TYPE_ADOBE_RGB_8)
       raster_type = "adobe-rgb_8";
+    else if ((printer->driver_data.raster_types & (PAPPL_PWG_RASTER_TYPE_CMYK_8 | PAPPL_PWG_RASTER_TYPE_RGB_8)) == PAPPL_PWG_RASTER_TYPE_CMYK_8)
+      raster_type = "cmyk_8";
     else
       raster_type = "rgb_8";
   }
@@ -417,6 +435,39 @@ papplJobDeletePrintOptions(
 }
 
 
+//
+// '_papplJobIsBlankLine()' - Determine whether a line contains only white.
+//
+// The line is checked 64 bytes at a time so that the compiler can vectorize
+// the comparisons while still stopping early for lines with ink.
+//
+
+bool					// O - `true` if blank, `false` otherwise
+_papplJobIsBlankLine(
+    const unsigned char *line,		// I - Line
+    size_t              bytes,		// I - Number of bytes
+    unsigned char       white)		// I - White value (`0x00` or `0xff`)
+{
+  size_t	i;			// Looping var
+  unsigned char	bits;			// Non-white bits
+
+
+  for (; bytes >= 64; bytes -= 64, line += 64)
+  {
+    for (i = 0, bits = 0; i < 64; i ++)
+      bits |= line[i] ^ white;
+
+    if (bits)
+      return (false);
+  }
+
+  for (i = 0, bits = 0; i < bytes; i ++)
+    bits |= line[i] ^ white;
+
+  return (bits == 0);
+}
+
+
 //
 // '_papplJobProcess()' - Process a print job.
 //
@@ -471,17 +522,24 @@ _papplJobProcessRaster(
 					// Printer for job
   pappl_pr_options_t	*options = NULL;// Job options
   cups_raster_t		*ras = NULL;	// Raster stream
-  cups_page_header2_t	header;		// Page header
+  cups_page_header2_t	header,		// Page header
+			ojheader,	// Job raster header from options
+			opheader;	// Previous page raster header
+  bool			color;		// Options computed for color?
+  _pappl_convert_cb_t	convert;	// Color conversion function, if any
+  bool			dither,		// Dither the page?
+			black;		// Dithered line is black (not white)?
+  unsigned char		white;		// White value for incoming lines
   unsigned		header_pages;	// Number of pages from page header
-  const unsigned char	*dither;	// Dither line
   unsigned char		*pixels,	// Incoming pixel line
-			*pixptr,	// Pixel pointer in line
-			*line,		// Output (bitmap) line
-			*lineptr,	// Pointer in line
-			byte,		// Byte in line
-			bit;		// Current bit
+			*converted,	// Color converted line, if any
+			*line;		// Output (bitmap) line
+  unsigned short	*raw;		// Incoming 16-bit pixel line, if any
   unsigned		page = 0,	// Current page
-			x,		// Current column
+			rawbytes,	// Bytes per 16-bit line or `0` for none
+			blanks,		// Number of pending blank lines
+			blankbytes,	// Number of bytes to check for blank lines
+			width,		// Number of columns to dither
 			y;		// Current line
 
 
@@ -509,7 +567,10 @@ _papplJobProcessRaster(
   if ((header_pages = header.cupsInteger[CUPS_RASTER_PWG_TotalPageCount]) > 0)
     papplJobSetImpressions(job, (int)header.cupsInteger[CUPS_RASTER_PWG_TotalPageCount]);
 
-  options = papplJobCreatePrintOptions(job, (unsigned)job->impressions, header.cupsBitsPerPixel > 8);
+  color    = header.cupsBitsPerPixel > header.cupsBitsPerColor;
+  options  = papplJobCreatePrintOptions(job, (unsigned)job->impressions, color);
+  ojheader = options->header;
+  opheader = options->header;
 
   if (!(printer->driver_data.rstartjob_cb)(job, options, job->printer->device))
   {
@@ -528,11 +589,24 @@ _papplJobProcessRaster(
 
     papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Page %u raster data is %ux%ux%u (%s)", page, header.cupsWidth, header.cupsHeight, header.cupsBitsPerPixel, cups_cspace_string(header.cupsColorSpace));
 
-    // Set options for this page...
-    papplJobDeletePrintOptions(options);
-    options = papplJobCreatePrintOptions(job, (unsigned)job->impressions, header.cupsBitsPerPixel > 8);
+    // Set options for this page - the job options only need to be recomputed
+    // if the page needs a different color mode...
+    if ((header.cupsBitsPerPixel > header.cupsBitsPerColor) != color)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Page %u is %s, updating options.", page, color ? "grayscale" : "color");
 
-    if (header.cupsWidth == 0 || header.cupsHeight == 0 || (header.cupsBitsPerColor != 1 && header.cupsBitsPerColor != 8) || header.cupsColorOrder != CUPS_ORDER_CHUNKED || (header.cupsBytesPerLine != ((header.cupsWidth * header.cupsBitsPerPixel + 7) / 8)))
+      papplJobDeletePrintOptions(options);
+      color    = header.cupsBitsPerPixel > header.cupsBitsPerColor;
+      options  = papplJobCreatePrintOptions(job, (unsigned)job->impressions, color);
+      ojheader = options->header;
+    }
+    else
+    {
+      // Restore the job raster header...
+      options->header = ojheader;
+    }
+
+    if (header.cupsWidth == 0 || header.cupsHeight == 0 || (header.cupsBitsPerColor != 1 && header.cupsBitsPerColor != 8 && header.cupsBitsPerColor != 16) || header.cupsColorOrder != CUPS_ORDER_CHUNKED || (header.cupsBytesPerLine != ((header.cupsWidth * header.cupsBitsPerPixel + 7) / 8)))
     {
       papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Bad raster data seen.");
       papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
@@ -540,16 +614,101 @@ _papplJobProcessRaster(
       break;
     }
 
-    if (header.cupsBitsPerPixel > 8 && !(printer->driver_data.color_supported & PAPPL_COLOR_MODE_COLOR))
+    if (header.cupsBitsPerColor == 16)
     {
-      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unsupported raster data seen.");
-      papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
-      job->state = IPP_JSTATE_ABORTED;
-      break;
+      // Convert 16-bit samples to 8-bit as they are read - the rest of the
+      // page is processed as 8-bit raster data...
+      rawbytes                = header.cupsBytesPerLine;
+      header.cupsBitsPerColor = 8;
+      header.cupsBitsPerPixel /= 2;
+      header.cupsBytesPerLine /= 2;
     }
+    else
+      rawbytes = 0;
+
+    // Select the color conversion for this page...
+    convert = NULL;
+    dither  = false;
+    black   = false;
 
-    if (options->header.cupsBitsPerPixel >= 8 && header.cupsBitsPerPixel >= 8)
-      options->header = header;		// Use page header from client
+    if (options->header.cupsBitsPerPixel == 1)
+    {
+      // Dither grayscale data, converting color data to grayscale first...
+      if (header.cupsColorSpace == CUPS_CSPACE_K)
+        black = true;
+      else
+        convert = get_convert(header.cupsColorSpace, CUPS_CSPACE_SW);
+
+      dither = header.cupsBitsPerPixel == 8 || convert != NULL;
+
+      if (!dither && header.cupsBitsPerPixel != options->header.cupsBitsPerPixel)
+      {
+	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unsupported raster data seen.");
+	papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
+	job->state = IPP_JSTATE_ABORTED;
+	break;
+      }
+    }
+    else if (header.cupsBitsPerPixel >= 8)
+    {
+      // Use page header from client, converting to the driver's color space
+      // as needed - the conversions only produce 8-bit samples, so other
+      // driver bit depths get the client data as-is...
+      if (options->header.cupsBitsPerColor == 8 && (convert = get_convert(header.cupsColorSpace, options->header.cupsColorSpace)) != NULL)
+      {
+        cups_page_header2_t dheader = options->header;
+					// Driver raster header
+
+        options->header                  = header;
+        options->header.cupsColorSpace   = dheader.cupsColorSpace;
+        options->header.cupsBitsPerColor = dheader.cupsBitsPerColor;
+        options->header.cupsBitsPerPixel = dheader.cupsBitsPerPixel;
+        options->header.cupsNumColors    = dheader.cupsNumColors;
+        options->header.cupsBytesPerLine = (header.cupsWidth * dheader.cupsBitsPerPixel + 7) / 8;
+
+        papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Page %u is converted from %s to %s.", page, cups_cspace_string(header.cupsColorSpace), cups_cspace_string(options->header.cupsColorSpace));
+      }
+      else if (header.cupsBitsPerPixel > 8 && !(printer->driver_data.color_supported & PAPPL_COLOR_MODE_COLOR))
+      {
+	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unsupported raster data seen.");
+	papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
+	job->state = IPP_JSTATE_ABORTED;
+	break;
+      }
+      else
+      {
+        options->header = header;
+      }
+    }
+
+    options->page_changes = PAPPL_PAGE_CHANGES_NONE;
+
+    if (page > 1 && memcmp(&options->header, &opheader, sizeof(opheader)))
+    {
+      // Tell the driver what changed from the previous page...
+      if (options->header.cupsWidth != opheader.cupsWidth || options->header.cupsHeight != opheader.cupsHeight)
+      {
+        papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Page %u size changed from %ux%u to %ux%u.", page, opheader.cupsWidth, opheader.cupsHeight, options->header.cupsWidth, options->header.cupsHeight);
+        options->page_changes |= PAPPL_PAGE_CHANGES_SIZE;
+      }
+
+      if (options->header.cupsBitsPerPixel != opheader.cupsBitsPerPixel || options->header.cupsColorSpace != opheader.cupsColorSpace)
+      {
+        papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Page %u color changed from %u-bit %s to %u-bit %s.", page, opheader.cupsBitsPerPixel, cups_cspace_string(opheader.cupsColorSpace), options->header.cupsBitsPerPixel, cups_cspace_string(options->header.cupsColorSpace));
+        options->page_changes |= PAPPL_PAGE_CHANGES_COLOR;
+      }
+
+      if (options->header.HWResolution[0] != opheader.HWResolution[0] || options->header.HWResolution[1] != opheader.HWResolution[1])
+      {
+        papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Page %u resolution changed from %ux%udpi to %ux%udpi.", page, opheader.HWResolution[0], opheader.HWResolution[1], options->header.HWResolution[0], options->header.HWResolution[1]);
+        options->page_changes |= PAPPL_PAGE_CHANGES_RESOLUTION;
+      }
+
+      if (!options->page_changes)
+        options->page_changes = PAPPL_PAGE_CHANGES_OTHER;
+    }
+
+    opheader = options->header;
 
     if (!(printer->driver_data.rstartpage_cb)(job, options, job->printer->device, page))
     {
@@ -560,7 +719,7 @@ _papplJobProcessRaster(
     if (options->header.cupsBytesPerLine > header.cupsBytesPerLine)
     {
       // Allocate enough space for the entire output line and clear to white
-      if ((pixels = malloc(options->header.cupsBytesPerLine)) == NULL)
+      if ((pixels = _papplPrinterAllocBuffer(printer, options->header.cupsBytesPerLine)) == NULL)
       {
         papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
 	job->state = IPP_JSTATE_ABORTED;
@@ -575,7 +734,7 @@ _papplJobProcessRaster(
     else
     {
       // The input raster is at least as wide as the output raster...
-      if ((pixels = malloc(header.cupsBytesPerLine)) == NULL)
+      if ((pixels = _papplPrinterAllocBuffer(printer, header.cupsBytesPerLine)) == NULL)
       {
         papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
 	job->state = IPP_JSTATE_ABORTED;
@@ -583,72 +742,90 @@ _papplJobProcessRaster(
       }
     }
 
-    if ((line = malloc(options->header.cupsBytesPerLine)) == NULL)
+    if ((line = _papplPrinterAllocBuffer(printer, options->header.cupsBytesPerLine)) == NULL)
+    {
+      _papplPrinterFreeBuffer(printer, pixels);
+
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+
+    if (rawbytes == 0)
+    {
+      raw = NULL;
+    }
+    else if ((raw = _papplPrinterAllocBuffer(printer, rawbytes)) == NULL)
+    {
+      _papplPrinterFreeBuffer(printer, pixels);
+      _papplPrinterFreeBuffer(printer, line);
+
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+
+    if (!convert)
     {
-      free(pixels);
+      converted = pixels;
+    }
+    else if ((converted = _papplPrinterAllocBuffer(printer, dither ? header.cupsWidth : options->header.cupsBytesPerLine)) == NULL)
+    {
+      _papplPrinterFreeBuffer(printer, pixels);
+      _papplPrinterFreeBuffer(printer, line);
+      _papplPrinterFreeBuffer(printer, raw);
 
       papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
       job->state = IPP_JSTATE_ABORTED;
       break;
     }
 
-    for (y = 0; !job->is_canceled && y < header.cupsHeight && y < options->header.cupsHeight; y ++)
+    // Clear any columns that are not dithered...
+    memset(line, 0, options->header.cupsBytesPerLine);
+
+    if ((width = header.cupsWidth) > options->header.cupsBytesPerLine * 8)
+      width = options->header.cupsBytesPerLine * 8;
+
+    // Incoming lines that are all white are not converted or dithered, and
+    // runs of them are sent to the driver at once...
+    if (header.cupsColorSpace == CUPS_CSPACE_K || header.cupsColorSpace == CUPS_CSPACE_CMYK)
+      white = 0x00;
+    else
+      white = 0xff;
+
+    if (dither)
+      blankbytes = width * header.cupsBitsPerPixel / 8;
+    else
+      blankbytes = header.cupsBytesPerLine;
+
+    for (y = 0, blanks = 0; !job->is_canceled && y < header.cupsHeight && y < options->header.cupsHeight; y ++)
     {
-      if (cupsRasterReadPixels(ras, pixels, header.cupsBytesPerLine))
+      if (read_pixels(ras, pixels, header.cupsBytesPerLine, raw))
       {
-        if (header.cupsBitsPerPixel == 8 && options->header.cupsBitsPerPixel == 1)
+        if (_papplJobIsBlankLine(pixels, blankbytes, white))
+        {
+          blanks ++;
+          continue;
+        }
+
+        if (blanks > 0)
+        {
+          _papplJobWriteBlankLines(job, options, job->printer->device, y - blanks, blanks, line);
+          blanks = 0;
+        }
+
+        if (convert)
+          (convert)(converted, pixels, header.cupsWidth);
+
+        if (dither)
         {
           // Dither the line...
-	  dither = options->dither[y & 15];
-	  memset(line, 0, options->header.cupsBytesPerLine);
-
-          if (header.cupsColorSpace == CUPS_CSPACE_K)
-          {
-            // Black...
-	    for (x = 0, lineptr = line, pixptr = pixels, bit = 128, byte = 0; x < header.cupsWidth; x ++, pixptr ++)
-	    {
-	      if (*pixptr > dither[x & 15])
-	        byte |= bit;
-
-	      if (bit == 1)
-	      {
-	        *lineptr++ = byte;
-	        byte       = 0;
-	        bit        = 128;
-	      }
-	      else
-	        bit /= 2;
-	    }
-
-	    if (bit < 128)
-	      *lineptr = byte;
-	  }
-	  else
-	  {
-	    // Grayscale to black...
-	    for (x = 0, lineptr = line, pixptr = pixels, bit = 128, byte = 0; x < header.cupsWidth; x ++, pixptr ++)
-	    {
-	      if (*pixptr <= dither[x & 15])
-	        byte |= bit;
-
-	      if (bit == 1)
-	      {
-	        *lineptr++ = byte;
-	        byte       = 0;
-	        bit        = 128;
-	      }
-	      else
-	        bit /= 2;
-	    }
-
-	    if (bit < 128)
-	      *lineptr = byte;
-	  }
+	  dither_line(line, converted, width, options->dither[y & 15], black);
 
           (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, line);
         }
         else
-          (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, pixels);
+          (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, converted);
       }
       else
         break;
@@ -657,42 +834,26 @@ _papplJobProcessRaster(
     if (!job->is_canceled && y < header.cupsHeight)
     {
       // Discard excess lines from client...
+      _papplJobWriteBlankLines(job, options, job->printer->device, y - blanks, blanks, line);
+
       while (y < header.cupsHeight)
       {
-        cupsRasterReadPixels(ras, pixels, header.cupsBytesPerLine);
+        read_pixels(ras, pixels, header.cupsBytesPerLine, raw);
         y ++;
       }
     }
     else
     {
       // Pad missing lines with whitespace...
-      if (header.cupsBitsPerPixel == 8 && options->header.cupsBitsPerPixel == 1)
-      {
-        memset(line, 0, options->header.cupsBytesPerLine);
-
-        while (y < options->header.cupsHeight)
-        {
-	  (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, line);
-          y ++;
-        }
-      }
-      else
-      {
-        if (header.cupsColorSpace == CUPS_CSPACE_K || header.cupsColorSpace == CUPS_CSPACE_CMYK)
-          memset(pixels, 0x00, header.cupsBytesPerLine);
-	else
-          memset(pixels, 0xff, header.cupsBytesPerLine);
-
-        while (y < options->header.cupsHeight)
-        {
-	  (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, pixels);
-          y ++;
-        }
-      }
+      _papplJobWriteBlankLines(job, options, job->printer->device, y - blanks, blanks + options->header.cupsHeight - y, line);
     }
 
-    free(pixels);
-    free(line);
+    _papplPrinterFreeBuffer(printer, pixels);
+    _papplPrinterFreeBuffer(printer, line);
+    _papplPrinterFreeBuffer(printer, raw);
+
+    if (convert)
+      _papplPrinterFreeBuffer(printer, converted);
 
     if (!(printer->driver_data.rendpage_cb)(job, options, job->printer->device, page))
     {
@@ -736,6 +897,138 @@ _papplJobProcessRaster(
 }
 
 
+//
+// '_papplJobWriteBlankLines()' - Write blank lines of raster graphics.
+//
+// The printer's "rwriteblank" callback is used if available.  Otherwise the
+// "line" buffer (`options->header.cupsBytesPerLine` bytes) is cleared to white
+// and sent to the "rwriteline" callback once for each line.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplJobWriteBlankLines(
+    pappl_job_t        *job,		// I - Job
+    pappl_pr_options_t *options,	// I - Print options
+    pappl_device_t     *device,		// I - Device
+    unsigned           y,		// I - First line
+    unsigned           count,		// I - Number of lines
+    unsigned char      *line)		// I - Line buffer
+{
+  pappl_printer_t	*printer = job->printer;
+					// Printer
+  pappl_pr_rwriteblank_cb_t rwriteblank_cb;
+					// Write blank lines callback
+
+
+  if (count == 0)
+    return (true);
+
+  pthread_rwlock_rdlock(&printer->rwlock);
+  rwriteblank_cb = printer->rwriteblank_cb;
+  pthread_rwlock_unlock(&printer->rwlock);
+
+  if (rwriteblank_cb)
+    return ((rwriteblank_cb)(job, options, device, y, count));
+
+  if (options->header.cupsColorSpace == CUPS_CSPACE_K || options->header.cupsColorSpace == CUPS_CSPACE_CMYK)
+    memset(line, 0x00, options->header.cupsBytesPerLine);
+  else
+    memset(line, 0xff, options->header.cupsBytesPerLine);
+
+  for (; count > 0; count --, y ++)
+  {
+    if (!(printer->driver_data.rwriteline_cb)(job, options, device, y, line))
+      return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'convert_invert()' - Invert grayscale pixels, for example sGray to black.
+//
+
+static void
+convert_invert(
+    unsigned char       *dst,		// I - Output line
+    const unsigned char *src,		// I - Input line
+    unsigned            width)		// I - Number of pixels
+{
+  unsigned	i;			// Looping var
+
+
+  for (i = 0; i < width; i ++)
+    dst[i] = (unsigned char)~src[i];
+}
+
+
+//
+// 'convert_rgb_to_black()' - Convert RGB pixels to black (inverted luminance).
+//
+
+static void
+convert_rgb_to_black(
+    unsigned char       *dst,		// I - Output line
+    const unsigned char *src,		// I - Input line
+    unsigned            width)		// I - Number of pixels
+{
+  unsigned	i;			// Looping var
+
+
+  for (i = 0; i < width; i ++, src += 3)
+    dst[i] = (unsigned char)(255 - ((77 * src[0] + 150 * src[1] + 29 * src[2] + 128) >> 8));
+}
+
+
+//
+// 'convert_rgb_to_cmyk()' - Convert RGB pixels to CMYK with full black generation.
+//
+
+static void
+convert_rgb_to_cmyk(
+    unsigned char       *dst,		// I - Output line
+    const unsigned char *src,		// I - Input line
+    unsigned            width)		// I - Number of pixels
+{
+  unsigned	i;			// Looping var
+  unsigned char	c, m, y, k;		// CMYK values
+
+
+  for (i = 0; i < width; i ++, src += 3, dst += 4)
+  {
+    c = (unsigned char)~src[0];
+    m = (unsigned char)~src[1];
+    y = (unsigned char)~src[2];
+    k = c < m ? c : m;
+    k = k < y ? k : y;
+
+    dst[0] = (unsigned char)(c - k);
+    dst[1] = (unsigned char)(m - k);
+    dst[2] = (unsigned char)(y - k);
+    dst[3] = k;
+  }
+}
+
+
+//
+// 'convert_rgb_to_white()' - Convert RGB pixels to grayscale (luminance).
+//
+
+static void
+convert_rgb_to_white(
+    unsigned char       *dst,		// I - Output line
+    const unsigned char *src,		// I - Input line
+    unsigned            width)		// I - Number of pixels
+{
+  unsigned	i;			// Looping var
+
+
+  for (i = 0; i < width; i ++, src += 3)
+    dst[i] = (unsigned char)((77 * src[0] + 150 * src[1] + 29 * src[2] + 128) >> 8);
+}
+
+
 //
 // 'cups_cspace_string()' - Get a string corresponding to a cupsColorSpace enum value.
 //
@@ -819,6 +1112,70 @@ cups_cspace_string(
 }
 
 
+//
+// 'dither_byte()' - Dither 8 pixels to a byte of 1-bit black.
+//
+// Each comparison yields 0 or 1, so no branches are needed.  The bits are
+// set for pixels that are darker than the threshold for black (K) pixels.
+//
+
+static unsigned char			// O - Dithered byte
+dither_byte(
+    const unsigned char *pixels,	// I - 8-bit pixels
+    const unsigned char *dither)	// I - Dither thresholds
+{
+  return ((unsigned char)(((pixels[0] > dither[0]) << 7) | ((pixels[1] > dither[1]) << 6) | ((pixels[2] > dither[2]) << 5) | ((pixels[3] > dither[3]) << 4) | ((pixels[4] > dither[4]) << 3) | ((pixels[5] > dither[5]) << 2) | ((pixels[6] > dither[6]) << 1) | (pixels[7] > dither[7])));
+}
+
+
+//
+// 'dither_line()' - Dither a line of 8-bit pixels to 1-bit black.
+//
+// The line is processed 16 pixels (one dither row) at a time, packing 8
+// pixels per output byte.  Grayscale pixels are dithered by inverting the
+// result for black pixels.
+//
+
+static void
+dither_line(
+    unsigned char       *line,		// O - Output line
+    const unsigned char *pixels,	// I - 8-bit pixels
+    unsigned            width,		// I - Number of pixels
+    const unsigned char *dither,	// I - Dither row (16 thresholds)
+    bool                black)		// I - `true` for black (K) pixels, `false` for grayscale
+{
+  unsigned char	invert = black ? 0x00 : 0xff,
+					// Bits to invert
+		byte;			// Last byte
+  unsigned	bit;			// Current bit
+
+
+  // Dither 16 pixels at a time...
+  for (; width >= 16; width -= 16, pixels += 16, line += 2)
+  {
+    line[0] = invert ^ dither_byte(pixels, dither);
+    line[1] = invert ^ dither_byte(pixels + 8, dither + 8);
+  }
+
+  if (width >= 8)
+  {
+    *line++ = invert ^ dither_byte(pixels, dither);
+    pixels  += 8;
+    dither  += 8;
+    width   -= 8;
+  }
+
+  if (width > 0)
+  {
+    // Dither the last few pixels, leaving the unused bits cleared...
+    for (bit = 0, byte = 0; bit < width; bit ++)
+      byte |= (unsigned char)((pixels[bit] > dither[bit]) << (7 - bit));
+
+    *line = (unsigned char)((invert ^ byte) & (0xff << (8 - width)));
+  }
+}
+
+
 //
 // 'filter_raw()' - "Filter" a raw print file.
 //
@@ -891,13 +1248,15 @@ finish_job(pappl_job_t  *job)		// I - Job
   cupsArrayRemove(printer->active_jobs, job);
   cupsArrayAdd(printer->completed_jobs, job);
 
-  printer->impcompleted += job->impcompleted;
+  _papplJobScheduleCleanup(job);
+  _papplPrinterAddEvent(printer, job, _PAPPL_EVENT_JOB_COMPLETED | _PAPPL_EVENT_JOB_STATE_CHANGED | _PAPPL_EVENT_PRINTER_STATE_CHANGED);
 
-  if (!job->system->clean_time)
-    job->system->clean_time = time(NULL) + 60;
+  printer->impcompleted += job->impcompleted;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
+  _papplJobRemoveAttributes(job);
+
   _papplSystemConfigChanged(printer->system);
 
   if (printer->is_deleted)
@@ -926,6 +1285,74 @@ finish_job(pappl_job_t  *job)		// I - Job
 }
 
 
+//
+// 'get_convert()' - Get the function for converting between two color spaces.
+//
+// Only RGB to grayscale, black, or CMYK and grayscale to/from black conversions
+// are supported - all other combinations are passed through as-is.
+//
+
+static _pappl_convert_cb_t		// O - Conversion function or `NULL` for none
+get_convert(cups_cspace_t inspace,	// I - Input color space
+            cups_cspace_t outspace)	// I - Output color space
+{
+  bool	ingray = inspace == CUPS_CSPACE_W || inspace == CUPS_CSPACE_SW,
+					// Grayscale input?
+	inrgb = inspace == CUPS_CSPACE_RGB || inspace == CUPS_CSPACE_SRGB || inspace == CUPS_CSPACE_ADOBERGB,
+					// RGB input?
+	outgray = outspace == CUPS_CSPACE_W || outspace == CUPS_CSPACE_SW;
+					// Grayscale output?
+
+
+  if (inrgb)
+  {
+    if (outgray)
+      return (convert_rgb_to_white);
+    else if (outspace == CUPS_CSPACE_K)
+      return (convert_rgb_to_black);
+    else if (outspace == CUPS_CSPACE_CMYK)
+      return (convert_rgb_to_cmyk);
+  }
+  else if ((ingray && outspace == CUPS_CSPACE_K) || (inspace == CUPS_CSPACE_K && outgray))
+  {
+    return (convert_invert);
+  }
+
+  return (NULL);
+}
+
+
+//
+// 'read_pixels()' - Read a line of raster data.
+//
+// If "raw" is not `NULL`, the line contains 16-bit samples that are read into
+// the "raw" buffer and then narrowed to 8-bit samples in "pixels".  CUPS
+// returns 16-bit samples in host byte order, so no swapping is needed here.
+//
+
+static bool				// O - `true` on success, `false` on error
+read_pixels(cups_raster_t  *ras,	// I - Raster stream
+            unsigned char  *pixels,	// I - Line buffer
+            unsigned       bytes,	// I - Bytes per 8-bit line
+            unsigned short *raw)	// I - 16-bit line buffer or `NULL`
+{
+  unsigned	i;			// Looping var
+
+
+  if (!raw)
+    return (cupsRasterReadPixels(ras, pixels, bytes) > 0);
+
+  if (!cupsRasterReadPixels(ras, (unsigned char *)raw, 2 * bytes))
+    return (false);
+
+  // Keep the most significant 8 bits of each sample...
+  for (i = 0; i < bytes; i ++)
+    pixels[i] = (unsigned char)(raw[i] >> 8);
+
+  return (true);
+}
+
+
 //
 // 'start_job()' - Start processing a job...
 //
@@ -938,6 +1365,9 @@ start_job(pappl_job_t *job)		// I - Job
   bool	first_open = true;		// Is this the first time we try to open the device?
 
 
+  // Make sure the job attributes are loaded...
+  _papplJobLoadAttributes(job);
+
   // Move the job to the 'processing' state...
   pthread_rwlock_wrlock(&job->rwlock);
   pthread_rwlock_wrlock(&printer->rwlock);
@@ -965,6 +1395,8 @@ start_job(pappl_job_t *job)		// I - Job
 
 	printer->state      = IPP_PSTATE_STOPPED;
 	printer->state_time = time(NULL);
+
+	_papplPrinterAddEvent(printer, NULL, _PAPPL_EVENT_PRINTER_STATE_CHANGED);
       }
 
       pthread_rwlock_unlock(&printer->rwlock);
@@ -977,5 +1409,7 @@ start_job(pappl_job_t *job)		// I - Job
   printer->state      = IPP_PSTATE_PROCESSING;
   printer->state_time = time(NULL);
 
+  _papplPrinterAddEvent(printer, job, _PAPPL_EVENT_JOB_STATE_CHANGED | _PAPPL_EVENT_PRINTER_STATE_CHANGED);
+
   pthread_rwlock_unlock(&printer->rwlock);
 }
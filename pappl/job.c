@@ -15,6 +15,43 @@
 #include "pappl-private.h"
 
 
+//
+// Local types...
+//
+
+typedef struct _pappl_istring_s		// Interned string
+{
+  char		*str;			// String value
+  int		refcount;		// Number of references
+} _pappl_istring_t;
+
+
+//
+// Local globals...
+//
+
+static cups_array_t	*strings = NULL;
+					// Interned strings for compacted jobs
+static pthread_mutex_t	refs_mutex = PTHREAD_MUTEX_INITIALIZER;
+					// Mutex for job reference counts
+static pthread_mutex_t	strings_mutex = PTHREAD_MUTEX_INITIALIZER;
+					// Mutex for interned strings
+
+
+//
+// Local functions...
+//
+
+static void		add_timer(pappl_system_t *system, _pappl_timer_t *timer);
+static void		archive_job(pappl_job_t *job, int *fd);
+static void		archive_jobs(pappl_printer_t *printer, time_t cleantime);
+static int		compare_strings(_pappl_istring_t *a, _pappl_istring_t *b);
+static void		compact_job(pappl_job_t *job);
+static void		expire_job(pappl_system_t *system, int printer_id, int job_id);
+static const char	*intern_string(const char *s);
+static void		release_string(const char *s);
+
+
 //
 // 'papplJobCancel()' - Cancel a job.
 //
@@ -26,6 +63,9 @@
 void
 papplJobCancel(pappl_job_t *job)	// I - Job
 {
+  bool	completed = false;		// Did the job complete?
+
+
   if (!job)
     return;
 
@@ -45,12 +85,17 @@ papplJobCancel(pappl_job_t *job)	// I - Job
 
     cupsArrayRemove(job->printer->active_jobs, job);
     cupsArrayAdd(job->printer->completed_jobs, job);
+
+    _papplJobScheduleCleanup(job);
+    _papplPrinterAddEvent(job->printer, job, _PAPPL_EVENT_JOB_COMPLETED | _PAPPL_EVENT_JOB_STATE_CHANGED);
+
+    completed = true;
   }
 
   pthread_rwlock_unlock(&job->printer->rwlock);
 
-  if (!job->system->clean_time)
-    job->system->clean_time = time(NULL) + 60;
+  if (completed)
+    _papplJobRemoveAttributes(job);
 
   pthread_rwlock_unlock(&job->rwlock);
 }
@@ -94,14 +139,15 @@ _papplJobCreate(
     return (NULL);
   }
 
-  job->attrs   = ippNew();
-  job->fd      = -1;
-  job->format  = format;
-  job->name    = job_name;
-  job->printer = printer;
-  job->state   = IPP_JSTATE_HELD;
-  job->system  = printer->system;
-  job->created = time(NULL);
+  job->refcount = 1;			// Reference for the all_jobs array
+  job->attrs    = ippNew();
+  job->fd       = -1;
+  job->format   = format;
+  job->name     = job_name;
+  job->printer  = printer;
+  job->state    = IPP_JSTATE_HELD;
+  job->system   = printer->system;
+  job->created  = time(NULL);
 
   if (attrs)
   {
@@ -150,12 +196,20 @@ _papplJobCreate(
   ippAddString(job->attrs, IPP_TAG_JOB, IPP_TAG_URI, "job-printer-uri", NULL, job_printer_uri);
 
   cupsArrayAdd(printer->all_jobs, job);
+  cupsArrayAdd(printer->user_jobs, job);
 
   if (!job_id)
     cupsArrayAdd(printer->active_jobs, job);
 
   pthread_rwlock_unlock(&printer->rwlock);
 
+  // Save the job attributes and report new jobs...
+  if (!job_id)
+  {
+    _papplJobSaveAttributes(job);
+    _papplPrinterAddEvent(printer, job, _PAPPL_EVENT_JOB_CREATED);
+  }
+
   _papplSystemConfigChanged(printer->system);
 
   return (job);
@@ -173,6 +227,13 @@ _papplJobDelete(pappl_job_t *job)	// I - Job
 
   ippDelete(job->attrs);
 
+  if (job->is_compact)
+  {
+    release_string(job->name);
+    release_string(job->username);
+    release_string(job->format);
+  }
+
   free(job->message);
 
   // Only remove the job file (document) if the job is in a terminating state...
@@ -183,6 +244,67 @@ _papplJobDelete(pappl_job_t *job)	// I - Job
 }
 
 
+//
+// '_papplJobLoadAttributes()' - Load deferred job attributes.
+//
+// Jobs loaded from a state file defer reading their attribute file from the
+// spool directory until the attributes are first needed.  Since the job is
+// write-locked, this function must not be called with the printer locked.
+//
+
+void
+_papplJobLoadAttributes(
+    pappl_job_t *job)			// I - Job
+{
+  int			fd;		// Attribute file descriptor
+  char			filename[1024];	// Attribute filename
+  ipp_t			*attrs;		// Attributes from file
+  ipp_attribute_t	*attr;		// Current attribute
+  const char		*name;		// Attribute name
+  bool			deferred;	// Are the attributes deferred?
+
+
+  pthread_rwlock_rdlock(&job->rwlock);
+  deferred = job->attrs_deferred;
+  pthread_rwlock_unlock(&job->rwlock);
+
+  if (!deferred)
+    return;
+
+  // Check again with the write lock held since another thread may have loaded
+  // the attributes in the meantime...
+  pthread_rwlock_wrlock(&job->rwlock);
+
+  if (job->attrs_deferred)
+  {
+    if ((fd = papplJobOpenFile(job, filename, sizeof(filename), job->system->directory, "ipp", "r")) < 0)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open file for job attributes: '%s'.", filename);
+    }
+    else
+    {
+      // Add the saved attributes that are not already set...
+      attrs = ippNew();
+
+      ippReadFile(fd, attrs);
+      close(fd);
+
+      for (attr = ippFirstAttribute(attrs); attr; attr = ippNextAttribute(attrs))
+      {
+        if ((name = ippGetName(attr)) != NULL && !ippFindAttribute(job->attrs, name, IPP_TAG_ZERO))
+          ippCopyAttribute(job->attrs, attr, 0);
+      }
+
+      ippDelete(attrs);
+    }
+
+    job->attrs_deferred = false;
+  }
+
+  pthread_rwlock_unlock(&job->rwlock);
+}
+
+
 //
 // 'papplJobOpenFile()' - Create or open a file for the document in a job.
 //
@@ -290,6 +412,43 @@ papplJobOpenFile(
 }
 
 
+//
+// '_papplJobRelease()' - Release a reference to a job.
+//
+// The job is freed when the last reference is released.
+//
+
+void
+_papplJobRelease(pappl_job_t *job)	// I - Job
+{
+  int	refcount;			// New reference count
+
+
+  pthread_mutex_lock(&refs_mutex);
+  refcount = -- job->refcount;
+  pthread_mutex_unlock(&refs_mutex);
+
+  if (refcount <= 0)
+    _papplJobDelete(job);
+}
+
+
+//
+// '_papplJobRemoveAttributes()' - Remove the job attributes file from the spool directory.
+//
+
+void
+_papplJobRemoveAttributes(
+    pappl_job_t *job)			// I - Job
+{
+  char	filename[1024];			// Attribute filename
+
+
+  if (job->system->directory)
+    papplJobOpenFile(job, filename, sizeof(filename), job->system->directory, "ipp", "x");
+}
+
+
 //
 // '_papplJobRemoveFile()' - Remove a file in spool directory
 //
@@ -310,6 +469,93 @@ _papplJobRemoveFile(pappl_job_t *job)	// I - Job
 }
 
 
+//
+// '_papplJobRetain()' - Retain a reference to a job.
+//
+// The printer must be locked by the caller so that the job cannot be removed
+// while the reference is added.  The reference keeps the job in memory after
+// the printer is unlocked, which allows the job to be locked without holding
+// the printer lock.
+//
+
+pappl_job_t *				// O - Job
+_papplJobRetain(pappl_job_t *job)	// I - Job
+{
+  pthread_mutex_lock(&refs_mutex);
+  job->refcount ++;
+  pthread_mutex_unlock(&refs_mutex);
+
+  return (job);
+}
+
+
+//
+// '_papplJobSaveAttributes()' - Save the job attributes to the spool directory.
+//
+// The job attributes are written once when the job is accepted (and again if
+// Send-Document adds document attributes) so that state saves only need to
+// record the job state.  The printer must not be locked by the caller.
+//
+
+void
+_papplJobSaveAttributes(
+    pappl_job_t *job)			// I - Job
+{
+  int	fd;				// Attribute file descriptor
+  char	filename[1024];			// Attribute filename
+
+
+  if (!job->system->directory)
+    return;
+
+  if ((fd = papplJobOpenFile(job, filename, sizeof(filename), job->system->directory, "ipp", "w")) < 0)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to create file for job attributes: '%s'.", filename);
+    return;
+  }
+
+  pthread_rwlock_rdlock(&job->rwlock);
+  ippWriteFile(fd, job->attrs);
+  pthread_rwlock_unlock(&job->rwlock);
+
+  close(fd);
+}
+
+
+//
+// '_papplJobScheduleCleanup()' - Schedule a completed job for cleanup.
+//
+
+void
+_papplJobScheduleCleanup(
+    pappl_job_t *job)			// I - Job
+{
+  pappl_system_t	*system = job->system;
+					// System
+  _pappl_timer_t	*timer;		// Expiration timer
+
+
+  if ((timer = (_pappl_timer_t *)calloc(1, sizeof(_pappl_timer_t))) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for job expiration timer: %s", strerror(errno));
+    return;
+  }
+
+  timer->expire     = (job->completed ? job->completed : time(NULL)) + 60;
+  timer->printer_id = job->printer->printer_id;
+  timer->job_id     = job->job_id;
+
+  pthread_mutex_lock(&system->timer_mutex);
+
+  if (!system->timer_time)
+    system->timer_time = time(NULL);
+
+  add_timer(system, timer);
+
+  pthread_mutex_unlock(&system->timer_mutex);
+}
+
+
 //
 // '_papplJobSubmitFile()' - Submit a file for printing.
 //
@@ -398,12 +644,30 @@ _papplJobSubmitFile(
     cupsArrayAdd(job->printer->completed_jobs, job);
     pthread_rwlock_unlock(&job->printer->rwlock);
 
-    if (!job->system->clean_time)
-      job->system->clean_time = time(NULL) + 60;
+    _papplJobRemoveAttributes(job);
+    _papplJobScheduleCleanup(job);
+    _papplPrinterAddEvent(job->printer, job, _PAPPL_EVENT_JOB_COMPLETED | _PAPPL_EVENT_JOB_STATE_CHANGED);
   }
 }
 
 
+//
+// '_papplPrinterArchiveFilename()' - Get the job history archive filename for a printer.
+//
+
+char *					// O - Filename
+_papplPrinterArchiveFilename(
+    pappl_printer_t *printer,		// I - Printer
+    char            *fname,		// I - Filename buffer
+    size_t          fnamesize,		// I - Size of filename buffer
+    bool            old)		// I - `true` for the previous (rotated) archive
+{
+  snprintf(fname, fnamesize, "%s/p%05d-history.%s", printer->system->directory, printer->printer_id, old ? "old" : "dat");
+
+  return (fname);
+}
+
+
 //
 // '_papplPrinterCheckJobs()' - Check for new jobs to process.
 //
@@ -412,7 +676,8 @@ void
 _papplPrinterCheckJobs(
     pappl_printer_t *printer)		// I - Printer
 {
-  pappl_job_t	*job;			// Current job
+  pappl_job_t	*job,			// Current job
+		*aborted = NULL;	// Job that could not be started
 
 
   papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Checking for new jobs to process.");
@@ -454,8 +719,10 @@ _papplPrinterCheckJobs(
 	cupsArrayRemove(printer->active_jobs, job);
 	cupsArrayAdd(printer->completed_jobs, job);
 
-	if (!printer->system->clean_time)
-	  printer->system->clean_time = time(NULL) + 60;
+	_papplJobScheduleCleanup(job);
+	_papplPrinterAddEvent(job->printer, job, _PAPPL_EVENT_JOB_COMPLETED | _PAPPL_EVENT_JOB_STATE_CHANGED);
+
+	aborted = _papplJobRetain(job);
       }
       else
 	pthread_detach(t);
@@ -467,6 +734,13 @@ _papplPrinterCheckJobs(
     papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "No jobs to process at this time.");
 
   pthread_rwlock_unlock(&printer->rwlock);
+
+  if (aborted)
+  {
+    // Remove the attributes file after the printer is unlocked...
+    _papplJobRemoveAttributes(aborted);
+    _papplJobRelease(aborted);
+  }
 }
 
 
@@ -495,15 +769,86 @@ papplPrinterFindJob(
 }
 
 
+//
+// '_papplSystemCleanJobs()' - Expire completed jobs whose timers are due.
+//
+// Completed jobs are scheduled on a two-level timer wheel with one second
+// slots for the next 64 seconds and 64 second slots for the following ~68
+// minutes.  Each call advances the wheel to the current time, cascading the
+// coarse slots as needed, and then expires only the jobs that are due.
+//
+
+void
+_papplSystemCleanJobs(
+    pappl_system_t *system)		// I - System
+{
+  time_t		curtime;	// Current time
+  _pappl_timer_t	*due = NULL,	// Timers that are due
+			*timer,		// Current timer
+			*next;		// Next timer
+  size_t		slot;		// Current slot
+
+
+  curtime = time(NULL);
+
+  pthread_mutex_lock(&system->timer_mutex);
+
+  while (system->timer_time && system->timer_time <= curtime)
+  {
+    if ((system->timer_time % _PAPPL_TIMER_SLOTS) == 0)
+    {
+      // Cascade the timers in the next coarse slot...
+      slot  = (size_t)(system->timer_time / _PAPPL_TIMER_SLOTS) % _PAPPL_TIMER_SLOTS;
+      timer = system->timers[1][slot];
+
+      system->timers[1][slot] = NULL;
+
+      for (; timer; timer = next)
+      {
+        next = timer->next;
+        add_timer(system, timer);
+      }
+    }
+
+    // Move the timers in the current slot to the due list...
+    slot = (size_t)system->timer_time % _PAPPL_TIMER_SLOTS;
+
+    for (timer = system->timers[0][slot]; timer; timer = next)
+    {
+      next        = timer->next;
+      timer->next = due;
+      due         = timer;
+    }
+
+    system->timers[0][slot] = NULL;
+    system->timer_time ++;
+  }
+
+  pthread_mutex_unlock(&system->timer_mutex);
+
+  // Expire the jobs without holding the timer mutex...
+  for (timer = due; timer; timer = next)
+  {
+    next = timer->next;
+
+    expire_job(system, timer->printer_id, timer->job_id);
+    free(timer);
+  }
+}
+
+
 //
 // 'papplSystemCleanJobs()' - Clean out old (completed) jobs.
 //
-// This function deletes all old (completed) jobs above the limit set by the
-// @link papplPrinterSetMaxCompletedJobs@ function.  The level may temporarily
-// exceed this limit if the jobs were completed within the last 60 seconds.
+// This function moves all old (completed) jobs above the limit set by the
+// @link papplPrinterSetMaxCompletedJobs@ function to the job history archive
+// in the spool directory.  The level may temporarily exceed this limit if the
+// jobs were completed within the last 60 seconds.  Completed jobs that are kept
+// in memory have their attributes freed once they are more than 60 seconds old.
 //
-// > Note: This function is normally called automatically from the
-// > @link papplSystemRun@ function.
+// > Note: The @link papplSystemRun@ function expires each completed job
+// > individually 60 seconds after it completes, so this function only needs to
+// > be called to force a full cleanup of all printers.
 //
 
 void
@@ -511,9 +856,12 @@ papplSystemCleanJobs(
     pappl_system_t *system)		// I - System
 {
   int			i,		// Looping var
-			count;		// Number of printers
+			count,		// Number of printers
+			j,		// Looping var
+			num_jobs;	// Number of jobs to compact
   pappl_printer_t	*printer;	// Current printer
-  pappl_job_t		*job;		// Current job
+  pappl_job_t		*job,		// Current job
+			**jobs;		// Jobs to compact
   time_t		cleantime;	// Clean time
 
 
@@ -530,27 +878,364 @@ papplSystemCleanJobs(
   {
     printer = (pappl_printer_t *)cupsArrayIndex(system->printers, i);
 
-    if (cupsArrayCount(printer->completed_jobs) == 0 || printer->max_completed_jobs <= 0)
+    if (cupsArrayCount(printer->completed_jobs) == 0)
       continue;
 
-    pthread_rwlock_wrlock(&printer->rwlock);
+    archive_jobs(printer, cleantime);
 
-    // Enumerate the jobs.  Since we have a writer (exclusive) lock, we are the
-    // only thread enumerating and can use cupsArrayFirst/Last...
+    // Collect the remaining old jobs, which are then compacted without the
+    // printer lock since each job has to be locked first...
+    num_jobs = 0;
 
-    for (job = (pappl_job_t *)cupsArrayFirst(printer->completed_jobs); job; job = (pappl_job_t *)cupsArrayNext(printer->completed_jobs))
+    pthread_rwlock_rdlock(&printer->rwlock);
+
+    if ((jobs = (pappl_job_t **)calloc((size_t)cupsArrayCount(printer->completed_jobs) + 1, sizeof(pappl_job_t *))) != NULL)
     {
-      if (job->completed && job->completed < cleantime && cupsArrayCount(printer->completed_jobs) > printer->max_completed_jobs)
+      for (j = 0; (job = (pappl_job_t *)cupsArrayIndex(printer->completed_jobs, j)) != NULL; j ++)
       {
-	cupsArrayRemove(printer->completed_jobs, job);
-	cupsArrayRemove(printer->all_jobs, job);
+        if (!job->is_compact && job->completed && job->completed < cleantime)
+          jobs[num_jobs ++] = _papplJobRetain(job);
       }
-      else
-	break;
     }
 
     pthread_rwlock_unlock(&printer->rwlock);
+
+    for (j = 0; j < num_jobs; j ++)
+    {
+      compact_job(jobs[j]);
+      _papplJobRelease(jobs[j]);
+    }
+
+    free(jobs);
   }
 
   pthread_rwlock_unlock(&system->rwlock);
 }
+
+
+//
+// 'add_timer()' - Add a timer to the job expiration timer wheel.
+//
+// The timer mutex must be held by the caller.  Timers that are already due go
+// in the current slot, timers due in the next 64 seconds go in a fine (one
+// second) slot, and the rest go in a coarse (64 second) slot that is cascaded
+// into the fine slots as the wheel turns.
+//
+
+static void
+add_timer(pappl_system_t *system,	// I - System
+          _pappl_timer_t *timer)	// I - Timer
+{
+  size_t	level,			// Wheel level
+		slot;			// Wheel slot
+
+
+  if (timer->expire < system->timer_time + _PAPPL_TIMER_SLOTS)
+  {
+    level = 0;
+    slot  = (size_t)(timer->expire > system->timer_time ? timer->expire : system->timer_time) % _PAPPL_TIMER_SLOTS;
+  }
+  else
+  {
+    level = 1;
+    slot  = (size_t)(timer->expire / _PAPPL_TIMER_SLOTS) % _PAPPL_TIMER_SLOTS;
+  }
+
+  timer->next                  = system->timers[level][slot];
+  system->timers[level][slot] = timer;
+}
+
+
+//
+// 'archive_job()' - Append a job to the printer's job history archive.
+//
+// The archive is an append-only file of fixed-size records, so the newest
+// records are at the end.  Once the archive reaches _PAPPL_MAX_ARCHIVED_JOBS
+// records it replaces the previous (old) archive and a new one is started.
+// The printer's archive mutex must be held by the caller.
+//
+
+static void
+archive_job(pappl_job_t *job,		// I  - Job
+            int         *fd)		// IO - Archive file descriptor
+{
+  pappl_printer_t	*printer = job->printer;
+					// Printer
+  char			filename[1024],	// Archive filename
+			oldname[1024];	// Previous archive filename
+  struct stat		fileinfo;	// Archive information
+  _pappl_jobrec_t	rec;		// Job record
+
+
+  if (!job->system->directory)
+    return;
+
+  if (*fd < 0)
+  {
+    _papplPrinterArchiveFilename(printer, filename, sizeof(filename), false);
+
+    if ((*fd = open(filename, O_WRONLY | O_CREAT | O_APPEND | O_NOFOLLOW | O_CLOEXEC, 0600)) < 0)
+    {
+      papplLogPrinter(printer, PAPPL_LOGLEVEL_ERROR, "Unable to open job history archive '%s': %s", filename, strerror(errno));
+      return;
+    }
+
+    if (!fstat(*fd, &fileinfo) && fileinfo.st_size >= (off_t)(_PAPPL_MAX_ARCHIVED_JOBS * sizeof(_pappl_jobrec_t)))
+    {
+      // Rotate the archive...
+      close(*fd);
+
+      _papplPrinterArchiveFilename(printer, oldname, sizeof(oldname), true);
+      rename(filename, oldname);
+
+      if ((*fd = open(filename, O_WRONLY | O_CREAT | O_APPEND | O_NOFOLLOW | O_CLOEXEC, 0600)) < 0)
+      {
+	papplLogPrinter(printer, PAPPL_LOGLEVEL_ERROR, "Unable to create job history archive '%s': %s", filename, strerror(errno));
+	return;
+      }
+    }
+  }
+
+  memset(&rec, 0, sizeof(rec));
+
+  pthread_rwlock_rdlock(&job->rwlock);
+
+  rec.job_id        = job->job_id;
+  rec.state         = (int32_t)job->state;
+  rec.state_reasons = (int32_t)job->state_reasons;
+  rec.impressions   = job->impressions;
+  rec.impcompleted  = job->impcompleted;
+  rec.created       = (int64_t)job->created;
+  rec.processing    = (int64_t)job->processing;
+  rec.completed     = (int64_t)job->completed;
+
+  if (job->username)
+    strlcpy(rec.username, job->username, sizeof(rec.username));
+  if (job->format)
+    strlcpy(rec.format, job->format, sizeof(rec.format));
+  if (job->name)
+    strlcpy(rec.name, job->name, sizeof(rec.name));
+
+  pthread_rwlock_unlock(&job->rwlock);
+
+  if (write(*fd, &rec, sizeof(rec)) != (ssize_t)sizeof(rec))
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write job history archive: %s", strerror(errno));
+}
+
+
+//
+// 'archive_jobs()' - Move the oldest completed jobs above the limit to the archive.
+//
+// Completed jobs are sorted newest first, so jobs are removed from the end of
+// the array with the printer locked.  The archive records are then written
+// and the jobs freed after the printer is unlocked.
+//
+
+static void
+archive_jobs(pappl_printer_t *printer,	// I - Printer
+             time_t          cleantime)	// I - Only archive jobs completed before this time
+{
+  pappl_job_t	*job,			// Current job
+		**jobs = NULL;		// Jobs to archive
+  int		i,			// Looping var
+		num_jobs = 0,		// Number of jobs to archive
+		max_jobs;		// Maximum number of jobs to archive
+  int		fd = -1;		// Job history archive file
+
+
+  pthread_rwlock_wrlock(&printer->rwlock);
+
+  if (printer->max_completed_jobs > 0 && (max_jobs = cupsArrayCount(printer->completed_jobs) - printer->max_completed_jobs) > 0 && (jobs = (pappl_job_t **)calloc((size_t)max_jobs, sizeof(pappl_job_t *))) != NULL)
+  {
+    while (num_jobs < max_jobs)
+    {
+      job = (pappl_job_t *)cupsArrayLast(printer->completed_jobs);
+
+      if (!job->completed || job->completed >= cleantime)
+	break;
+
+      // Keep a reference to the job until it has been archived...
+      jobs[num_jobs ++] = _papplJobRetain(job);
+
+      cupsArrayRemove(printer->completed_jobs, job);
+      cupsArrayRemove(printer->user_jobs, job);
+      cupsArrayRemove(printer->all_jobs, job);
+    }
+  }
+
+  pthread_rwlock_unlock(&printer->rwlock);
+
+  if (num_jobs > 0)
+  {
+    pthread_mutex_lock(&printer->archive_mutex);
+
+    for (i = 0; i < num_jobs; i ++)
+      archive_job(jobs[i], &fd);
+
+    if (fd >= 0)
+      close(fd);
+
+    pthread_mutex_unlock(&printer->archive_mutex);
+
+    for (i = 0; i < num_jobs; i ++)
+      _papplJobRelease(jobs[i]);
+  }
+
+  free(jobs);
+}
+
+
+//
+// 'compact_job()' - Free the attributes of a completed job.
+//
+// The job name, username, and format are interned since many jobs share the
+// same values and they otherwise point into the attributes.  The caller must
+// hold a reference to the job but not the printer lock, since the job is
+// locked before the printer.
+//
+
+static void
+compact_job(pappl_job_t *job)		// I - Job
+{
+  pthread_rwlock_wrlock(&job->rwlock);
+  pthread_rwlock_wrlock(&job->printer->rwlock);
+
+  if (!job->is_compact)
+  {
+    job->name     = intern_string(job->name);
+    job->username = intern_string(job->username);
+    job->format   = intern_string(job->format);
+
+    ippDelete(job->attrs);
+    job->attrs          = NULL;
+    job->attrs_deferred = false;
+    job->is_compact     = true;
+  }
+
+  pthread_rwlock_unlock(&job->printer->rwlock);
+  pthread_rwlock_unlock(&job->rwlock);
+}
+
+
+//
+// 'compare_strings()' - Compare two interned strings.
+//
+
+static int				// O - Result of comparison
+compare_strings(_pappl_istring_t *a,	// I - First string
+                _pappl_istring_t *b)	// I - Second string
+{
+  return (strcmp(a->str, b->str));
+}
+
+
+//
+// 'expire_job()' - Compact an expired job and archive old jobs on its printer.
+//
+
+static void
+expire_job(pappl_system_t *system,	// I - System
+           int            printer_id,	// I - Printer ID
+           int            job_id)	// I - Job ID
+{
+  pappl_printer_t	*printer;	// Printer
+  pappl_job_t		key,		// Search key
+			*job;		// Job
+
+
+  if ((printer = papplSystemFindPrinter(system, NULL, printer_id, NULL)) == NULL)
+    return;				// Printer has been deleted
+
+  key.job_id = job_id;
+
+  pthread_rwlock_rdlock(&printer->rwlock);
+
+  if ((job = (pappl_job_t *)cupsArrayFind(printer->all_jobs, &key)) != NULL && !job->is_compact && job->state >= IPP_JSTATE_CANCELED)
+    _papplJobRetain(job);
+  else
+    job = NULL;
+
+  pthread_rwlock_unlock(&printer->rwlock);
+
+  if (job)
+  {
+    compact_job(job);
+    _papplJobRelease(job);
+  }
+
+  archive_jobs(printer, time(NULL) - 60);
+}
+
+
+//
+// 'intern_string()' - Get a reference to an interned copy of a string.
+//
+
+static const char *			// O - Interned string or `NULL`
+intern_string(const char *s)		// I - String
+{
+  _pappl_istring_t	key,		// Search key
+			*istr;		// Interned string
+
+
+  if (!s)
+    return (NULL);
+
+  pthread_mutex_lock(&strings_mutex);
+
+  if (!strings)
+    strings = cupsArrayNew((cups_array_func_t)compare_strings, NULL);
+
+  key.str = (char *)s;
+
+  if ((istr = (_pappl_istring_t *)cupsArrayFind(strings, &key)) != NULL)
+  {
+    istr->refcount ++;
+  }
+  else if ((istr = (_pappl_istring_t *)calloc(1, sizeof(_pappl_istring_t))) != NULL)
+  {
+    if ((istr->str = strdup(s)) == NULL)
+    {
+      free(istr);
+      istr = NULL;
+    }
+    else
+    {
+      istr->refcount = 1;
+      cupsArrayAdd(strings, istr);
+    }
+  }
+
+  pthread_mutex_unlock(&strings_mutex);
+
+  return (istr ? istr->str : NULL);
+}
+
+
+//
+// 'release_string()' - Release a reference to an interned string.
+//
+
+static void
+release_string(const char *s)		// I - Interned string
+{
+  _pappl_istring_t	key,		// Search key
+			*istr;		// Interned string
+
+
+  if (!s)
+    return;
+
+  pthread_mutex_lock(&strings_mutex);
+
+  key.str = (char *)s;
+
+  if ((istr = (_pappl_istring_t *)cupsArrayFind(strings, &key)) != NULL && -- istr->refcount <= 0)
+  {
+    cupsArrayRemove(strings, istr);
+    free(istr->str);
+    free(istr);
+  }
+
+  pthread_mutex_unlock(&strings_mutex);
+}
@@ -21,6 +21,7 @@
 #  include "client-private.h"
 #  include "printer-private.h"
 #  include "job-private.h"
+#  include "subscription-private.h"
 #  include "mainloop-private.h"
 #  include "log-private.h"
 
@@ -12,9 +12,17 @@
 //
 
 #include "printer-private.h"
+#include "job-private.h"
 #include "system-private.h"
 
 
+//
+// Local functions...
+//
+
+static void	iterate_jobs(pappl_printer_t *printer, cups_array_t *jobs, pappl_job_cb_t cb, void *data, int job_index, int limit);
+
+
 //
 // 'papplPrinterCloseDevice()' - Close the device associated with the printer.
 //
@@ -570,24 +578,10 @@ papplPrinterIterateActiveJobs(
     int             job_index,		// I - First job to iterate (1-based)
     int             limit)		// I - Maximum jobs to iterate or `0` for no limit
 {
-  pappl_job_t	*job;			// Current job
-  int		count;			// Number of jobs
-
-
   if (!printer || !cb)
     return;
 
-  pthread_rwlock_rdlock(&printer->rwlock);
-
-  for (job = (pappl_job_t *)cupsArrayIndex(printer->active_jobs, job_index - 1), count = 0; job; job = (pappl_job_t *)cupsArrayNext(printer->active_jobs), count ++)
-  {
-    if (limit == 0 || count < limit)
-      (cb)(job, data);
-    else
-      break;
-  }
-
-  pthread_rwlock_unlock(&printer->rwlock);
+  iterate_jobs(printer, printer->active_jobs, cb, data, job_index, limit);
 }
 
 
@@ -610,24 +604,10 @@ papplPrinterIterateAllJobs(
     int             job_index,		// I - First job to iterate (1-based)
     int             limit)		// I - Maximum jobs to iterate, `0` for no limit
 {
-  pappl_job_t	*job;			// Current job
-  int		count;			// Number of jobs
-
-
   if (!printer || !cb)
     return;
 
-  pthread_rwlock_rdlock(&printer->rwlock);
-
-  for (job = (pappl_job_t *)cupsArrayIndex(printer->all_jobs, job_index - 1), count = 0; job; job = (pappl_job_t *)cupsArrayNext(printer->all_jobs), count ++)
-  {
-    if (limit == 0 || count < limit)
-      (cb)(job, data);
-    else
-      break;
-  }
-
-  pthread_rwlock_unlock(&printer->rwlock);
+  iterate_jobs(printer, printer->all_jobs, cb, data, job_index, limit);
 }
 
 
@@ -651,24 +631,10 @@ papplPrinterIterateCompletedJobs(
     int             job_index,		// I - First job to iterate (1-based)
     int             limit)		// I - Maximum jobs to iterate, `0` for no limit
 {
-  pappl_job_t	*job;			// Current job
-  int		count;			// Number of jobs
-
-
   if (!printer || !cb)
     return;
 
-  pthread_rwlock_rdlock(&printer->rwlock);
-
-  for (job = (pappl_job_t *)cupsArrayIndex(printer->completed_jobs, job_index - 1), count = 0; job; job = (pappl_job_t *)cupsArrayNext(printer->completed_jobs), count ++)
-  {
-    if (limit == 0 || count < limit)
-      (cb)(job, data);
-    else
-      break;
-  }
-
-  pthread_rwlock_unlock(&printer->rwlock);
+  iterate_jobs(printer, printer->completed_jobs, cb, data, job_index, limit);
 }
 
 
@@ -735,6 +701,8 @@ papplPrinterPause(
     printer->state = IPP_PSTATE_STOPPED;
 
   pthread_rwlock_unlock(&printer->rwlock);
+
+  _papplPrinterAddEvent(printer, NULL, _PAPPL_EVENT_PRINTER_STATE_CHANGED);
 }
 
 
@@ -758,6 +726,8 @@ papplPrinterResume(
 
   pthread_rwlock_unlock(&printer->rwlock);
 
+  _papplPrinterAddEvent(printer, NULL, _PAPPL_EVENT_PRINTER_STATE_CHANGED);
+
   _papplPrinterCheckJobs(printer);
 }
 
@@ -780,6 +750,7 @@ papplPrinterSetContact(
 
   printer->contact     = *contact;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -809,6 +780,7 @@ papplPrinterSetDNSSDName(
   printer->dns_sd_collision = false;
   printer->dns_sd_serial    = 0;
   printer->config_time      = time(NULL);
+  printer->generation ++;
 
   if (!value)
     _papplPrinterUnregisterDNSSDNoLock(printer);
@@ -848,6 +820,7 @@ papplPrinterSetGeoLocation(
   free(printer->geo_location);
   printer->geo_location = value ? strdup(value) : NULL;
   printer->config_time  = time(NULL);
+  printer->generation ++;
 
   _papplPrinterRegisterDNSSDNoLock(printer);
 
@@ -904,6 +877,7 @@ papplPrinterSetLocation(
   free(printer->location);
   printer->location    = value ? strdup(value) : NULL;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   _papplPrinterRegisterDNSSDNoLock(printer);
 
@@ -936,6 +910,7 @@ papplPrinterSetMaxActiveJobs(
 
   printer->max_active_jobs = max_active_jobs;
   printer->config_time     = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -963,6 +938,7 @@ papplPrinterSetMaxCompletedJobs(
 
   printer->max_completed_jobs = max_completed_jobs;
   printer->config_time        = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -992,6 +968,7 @@ papplPrinterSetNextJobID(
 
   printer->next_job_id = next_job_id;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -1019,6 +996,7 @@ papplPrinterSetOrganization(
   free(printer->organization);
   printer->organization = value ? strdup(value) : NULL;
   printer->config_time  = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -1046,6 +1024,7 @@ papplPrinterSetOrganizationalUnit(
   free(printer->org_unit);
   printer->org_unit    = value ? strdup(value) : NULL;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -1076,6 +1055,7 @@ papplPrinterSetPrintGroup(
   free(printer->print_group);
   printer->print_group = value ? strdup(value) : NULL;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   if (printer->print_group && strcmp(printer->print_group, "none"))
   {
@@ -1122,6 +1102,8 @@ papplPrinterSetReasons(
   printer->state_time    = printer->status_time = time(NULL);
 
   pthread_rwlock_unlock(&printer->rwlock);
+
+  _papplPrinterAddEvent(printer, NULL, _PAPPL_EVENT_PRINTER_STATE_CHANGED);
 }
 
 
@@ -1147,6 +1129,58 @@ papplPrinterSetSupplies(
   if (supplies)
     memcpy(printer->supply, supplies, (size_t)num_supplies * sizeof(pappl_supply_t));
   printer->state_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
+
+  _papplPrinterAddEvent(printer, NULL, _PAPPL_EVENT_PRINTER_STATE_CHANGED);
+}
+
+
+//
+// 'iterate_jobs()' - Iterate over the jobs in an array.
+//
+// The jobs are collected with the printer locked and then passed to the
+// callback after the printer is unlocked, since the callback will usually
+// lock each job.
+//
+
+static void
+iterate_jobs(
+    pappl_printer_t *printer,		// I - Printer
+    cups_array_t    *jobs,		// I - Jobs array
+    pappl_job_cb_t  cb,			// I - Callback function
+    void            *data,		// I - Callback data
+    int             job_index,		// I - First job to iterate (1-based)
+    int             limit)		// I - Maximum jobs to iterate, `0` for no limit
+{
+  pappl_job_t	*job,			// Current job
+		**cbjobs = NULL;	// Jobs to iterate
+  int		i,			// Looping var
+		count = 0;		// Number of jobs
+
+
+  if (job_index < 1)
+    job_index = 1;
+
+  pthread_rwlock_rdlock(&printer->rwlock);
+
+  if ((i = cupsArrayCount(jobs) - job_index + 1) > limit && limit > 0)
+    i = limit;
+
+  if (i > 0 && (cbjobs = (pappl_job_t **)calloc((size_t)i, sizeof(pappl_job_t *))) != NULL)
+  {
+    while (count < i && (job = (pappl_job_t *)cupsArrayIndex(jobs, job_index - 1 + count)) != NULL)
+      cbjobs[count ++] = _papplJobRetain(job);
+  }
+
+  pthread_rwlock_unlock(&printer->rwlock);
+
+  for (i = 0; i < count; i ++)
+  {
+    (cb)(cbjobs[i], data);
+    _papplJobRelease(cbjobs[i]);
+  }
+
+  free(cbjobs);
 }
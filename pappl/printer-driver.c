@@ -168,6 +168,7 @@ papplPrinterSetDriverData(
 
   // Copy driver data to printer
   memcpy(&printer->driver_data, data, sizeof(printer->driver_data));
+  printer->generation ++;
 
   // Create printer (capability) attributes based on driver data...
   ippDelete(printer->driver_attrs);
@@ -276,6 +277,7 @@ papplPrinterSetDriverDefaults(
   }
 
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -311,6 +313,7 @@ papplPrinterSetReadyMedia(
   memset(printer->driver_data.media_ready, 0, sizeof(printer->driver_data.media_ready));
   memcpy(printer->driver_data.media_ready, ready, (size_t)num_ready * sizeof(pappl_media_col_t));
   printer->state_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -320,6 +323,33 @@ papplPrinterSetReadyMedia(
 }
 
 
+//
+// 'papplPrinterSetWriteBlankCallback()' - Set the write blank lines callback.
+//
+// This function sets an optional driver callback that is called instead of
+// the "rwriteline" callback for runs of blank (white) raster lines, allowing
+// the driver to send a single vertical skip command to the printer.  Pass
+// `NULL` to send each blank line to the "rwriteline" callback.
+//
+// @since PAPPL 1.1@
+//
+
+void
+papplPrinterSetWriteBlankCallback(
+    pappl_printer_t           *printer,	// I - Printer
+    pappl_pr_rwriteblank_cb_t cb)	// I - Write blank lines callback or `NULL` for none
+{
+  if (!printer)
+    return;
+
+  pthread_rwlock_wrlock(&printer->rwlock);
+
+  printer->rwriteblank_cb = cb;
+
+  pthread_rwlock_unlock(&printer->rwlock);
+}
+
+
 //
 // 'make_attrs()' - Make the capability attributes for the given driver data.
 //
@@ -31,7 +31,9 @@ typedef struct _pappl_attr_s		// Input attribute structure
 // Local functions...
 //
 
+static int		copy_archived_jobs(pappl_client_t *client, _pappl_ra_t *ra, const char *username, int skip, int count, int limit);
 static pappl_job_t	*create_job(pappl_client_t *client);
+static int		find_user_jobs(cups_array_t *jobs, const char *username);
 
 static void		ipp_cancel_current_job(pappl_client_t *client);
 static void		ipp_cancel_jobs(pappl_client_t *client);
@@ -45,6 +47,8 @@ static void		ipp_resume_printer(pappl_client_t *client);
 static void		ipp_set_printer_attributes(pappl_client_t *client);
 static void		ipp_validate_job(pappl_client_t *client);
 
+static ipp_t		*make_attributes(pappl_printer_t *printer);
+
 static bool		valid_job_attributes(pappl_client_t *client);
 
 
@@ -56,274 +60,66 @@ void
 _papplPrinterCopyAttributes(
     pappl_client_t  *client,		// I - Client
     pappl_printer_t *printer,		// I - Printer
-    cups_array_t    *ra,		// I - Requested attributes
+    _pappl_ra_t     *ra,		// I - Requested attributes
     const char      *format)		// I - "document-format" value, if any
 {
-  int		i,			// Looping var
-		num_values;		// Number of values
-  unsigned	bit;			// Current bit value
+  int		num_values;		// Number of values
   const char	*svalues[100];		// String values
-  int		ivalues[100];		// Integer values
-  pappl_pr_driver_data_t *data = &printer->driver_data;
-					// Driver data
 
 
   _papplCopyAttributes(client->response, printer->attrs, ra, IPP_TAG_ZERO, IPP_TAG_CUPS_CONST);
   _papplCopyAttributes(client->response, printer->driver_attrs, ra, IPP_TAG_ZERO, IPP_TAG_CUPS_CONST);
-  _papplPrinterCopyState(client, client->response, printer, ra);
-
-  if (!ra || cupsArrayFind(ra, "copies-supported"))
-  {
-    // Filter copies-supported value based on the document format...
-    // (no copy support for streaming raster formats)
-    if (format && (!strcmp(format, "image/pwg-raster") || !strcmp(format, "image/urf")))
-      ippAddRange(client->response, IPP_TAG_PRINTER, "copies-supported", 1, 1);
-    else
-      ippAddRange(client->response, IPP_TAG_PRINTER, "copies-supported", 1, 999);
-  }
-
-  if (!ra || cupsArrayFind(ra, "identify-actions-default"))
-  {
-    for (num_values = 0, bit = PAPPL_IDENTIFY_ACTIONS_DISPLAY; bit <= PAPPL_IDENTIFY_ACTIONS_SPEAK; bit *= 2)
-    {
-      if (data->identify_default & bit)
-	svalues[num_values ++] = _papplIdentifyActionsString(bit);
-    }
-
-    if (num_values > 0)
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", num_values, NULL, svalues);
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", NULL, "none");
-  }
-
-  if ((!ra || cupsArrayFind(ra, "label-mode-configured")) && data->mode_configured)
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "label-mode-configured", NULL, _papplLabelModeString(data->mode_configured));
 
-  if ((!ra || cupsArrayFind(ra, "label-tear-offset-configured")) && data->tear_offset_supported[1] > 0)
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "label-tear-offset-configured", data->tear_offset_configured);
+  // Copy the cached configuration attributes, updating the cache as needed -
+  // the caller's printer lock keeps the generation from changing, so only
+  // the first client to see a stale cache rebuilds it...
+  pthread_rwlock_rdlock(&printer->cache_rwlock);
 
-  if (printer->num_supply > 0)
+  if (!printer->cache_attrs || printer->cache_generation != printer->generation)
   {
-    pappl_supply_t *supply = printer->supply;
-					// Supply values...
-
-    if (!ra || cupsArrayFind(ra, "marker-colors"))
-    {
-      for (i = 0; i < printer->num_supply; i ++)
-        svalues[i] = _papplMarkerColorString(supply[i].color);
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_NAME), "marker-colors", printer->num_supply, NULL, svalues);
-    }
+    pthread_rwlock_unlock(&printer->cache_rwlock);
+    pthread_rwlock_wrlock(&printer->cache_rwlock);
 
-    if (!ra || cupsArrayFind(ra, "marker-high-levels"))
+    if (!printer->cache_attrs || printer->cache_generation != printer->generation)
     {
-      for (i = 0; i < printer->num_supply; i ++)
-        ivalues[i] = supply[i].is_consumed ? 100 : 90;
+      ippDelete(printer->cache_attrs);
 
-      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-high-levels", printer->num_supply, ivalues);
+      printer->cache_attrs      = make_attributes(printer);
+      printer->cache_generation = printer->generation;
     }
 
-    if (!ra || cupsArrayFind(ra, "marker-levels"))
-    {
-      for (i = 0; i < printer->num_supply; i ++)
-        ivalues[i] = supply[i].level;
-
-      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-levels", printer->num_supply, ivalues);
-    }
-
-    if (!ra || cupsArrayFind(ra, "marker-low-levels"))
-    {
-      for (i = 0; i < printer->num_supply; i ++)
-        ivalues[i] = supply[i].is_consumed ? 10 : 0;
-
-      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-low-levels", printer->num_supply, ivalues);
-    }
-
-    if (!ra || cupsArrayFind(ra, "marker-names"))
-    {
-      for (i = 0; i < printer->num_supply; i ++)
-        svalues[i] = supply[i].description;
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "marker-names", printer->num_supply, NULL, svalues);
-    }
-
-    if (!ra || cupsArrayFind(ra, "marker-types"))
-    {
-      for (i = 0; i < printer->num_supply; i ++)
-        svalues[i] = _papplMarkerTypeString(supply[i].type);
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "marker-types", printer->num_supply, NULL, svalues);
-    }
+    pthread_rwlock_unlock(&printer->cache_rwlock);
+    pthread_rwlock_rdlock(&printer->cache_rwlock);
   }
 
-  if ((!ra || cupsArrayFind(ra, "media-col-default")) && data->media_default.size_name[0])
-  {
-    ipp_t *col = _papplMediaColExport(&printer->driver_data, &data->media_default, 0);
-					// Collection value
-
-    ippAddCollection(client->response, IPP_TAG_PRINTER, "media-col-default", col);
-    ippDelete(col);
-  }
+  _papplCopyAttributes(client->response, printer->cache_attrs, ra, IPP_TAG_ZERO, 0);
 
-  if (!ra || cupsArrayFind(ra, "media-col-ready"))
-  {
-    int			j,		// Looping var
-			count;		// Number of values
-    ipp_t		*col;		// Collection value
-    ipp_attribute_t	*attr;		// media-col-ready attribute
-    pappl_media_col_t	media;		// Current media...
+  pthread_rwlock_unlock(&printer->cache_rwlock);
 
-    for (i = 0, count = 0; i < data->num_source; i ++)
-    {
-      if (data->media_ready[i].size_name[0])
-        count ++;
-    }
-
-    if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
-      count *= 2;			// Need to report ready media for borderless, too...
-
-    if (count > 0)
-    {
-      attr = ippAddCollections(client->response, IPP_TAG_PRINTER, "media-col-ready", count, NULL);
-
-      for (i = 0, j = 0; i < data->num_source && j < count; i ++)
-      {
-	if (data->media_ready[i].size_name[0])
-	{
-          if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
-	  {
-	    // Report both bordered and borderless media-col values...
-	    media = data->media_ready[i];
-
-	    media.bottom_margin = media.top_margin   = data->bottom_top;
-	    media.left_margin   = media.right_margin = data->left_right;
-	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
-	    ippSetCollection(client->response, &attr, j ++, col);
-	    ippDelete(col);
-
-	    media.bottom_margin = media.top_margin   = 0;
-	    media.left_margin   = media.right_margin = 0;
-	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
-	    ippSetCollection(client->response, &attr, j ++, col);
-	    ippDelete(col);
-	  }
-	  else
-	  {
-	    // Just report the single media-col value...
-	    col = _papplMediaColExport(&printer->driver_data, data->media_ready + i, 0);
-	    ippSetCollection(client->response, &attr, j ++, col);
-	    ippDelete(col);
-	  }
-	}
-      }
-    }
-  }
-
-  if ((!ra || cupsArrayFind(ra, "media-default")) && data->media_default.size_name[0])
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-default", NULL, data->media_default.size_name);
-
-  if (!ra || cupsArrayFind(ra, "media-ready"))
-  {
-    int			j,		// Looping vars
-			count;		// Number of values
-    ipp_attribute_t	*attr;		// media-col-ready attribute
-
-    for (i = 0, count = 0; i < data->num_source; i ++)
-    {
-      if (data->media_ready[i].size_name[0])
-        count ++;
-    }
-
-    if (count > 0)
-    {
-      attr = ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-ready", count, NULL, NULL);
-
-      for (i = 0, j = 0; i < data->num_source && j < count; i ++)
-      {
-	if (data->media_ready[i].size_name[0])
-	  ippSetString(client->response, &attr, j ++, data->media_ready[i].size_name);
-      }
-    }
-  }
-
-  if (!ra || cupsArrayFind(ra, "multiple-document-handling-default"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "multiple-document-handling-default", NULL, "separate-documents-collated-copies");
-
-  if (!ra || cupsArrayFind(ra, "orientation-requested-default"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "orientation-requested-default", (int)data->orient_default);
-
-  if (!ra || cupsArrayFind(ra, "output-bin-default"))
-  {
-    if (data->num_bin > 0)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, data->bin[data->bin_default]);
-    else if (data->output_face_up)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-up");
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-down");
-  }
-
-  if ((!ra || cupsArrayFind(ra, "print-color-mode-default")) && data->color_default)
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-color-mode-default", NULL, _papplColorModeString(data->color_default));
-
-  if (!ra || cupsArrayFind(ra, "print-content-optimize-default"))
-  {
-    if (data->content_default)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, _papplContentString(data->content_default));
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, "auto");
-  }
-
-  if (!ra || cupsArrayFind(ra, "print-quality-default"))
-  {
-    if (data->quality_default)
-      ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", (int)data->quality_default);
-    else
-      ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", IPP_QUALITY_NORMAL);
-  }
+  // Then add the attributes that depend on the client or current state...
+  _papplPrinterCopyState(client, client->response, printer, ra);
 
-  if (!ra || cupsArrayFind(ra, "print-scaling-default"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_COPIES_SUPPORTED))
   {
-    if (data->scaling_default)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, _papplScalingString(data->scaling_default));
+    // Filter copies-supported value based on the document format...
+    // (no copy support for streaming raster formats)
+    if (format && (!strcmp(format, "image/pwg-raster") || !strcmp(format, "image/urf")))
+      ippAddRange(client->response, IPP_TAG_PRINTER, "copies-supported", 1, 1);
     else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, "auto");
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-config-change-date-time"))
-    ippAddDate(client->response, IPP_TAG_PRINTER, "printer-config-change-date-time", ippTimeToDate(printer->config_time));
-
-  if (!ra || cupsArrayFind(ra, "printer-config-change-time"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-config-change-time", (int)(printer->config_time - printer->start_time));
-
-  if (!ra || cupsArrayFind(ra, "printer-contact-col"))
-  {
-    ipp_t *col = _papplContactExport(&printer->contact);
-    ippAddCollection(client->response, IPP_TAG_PRINTER, "printer-contact-col", col);
-    ippDelete(col);
+      ippAddRange(client->response, IPP_TAG_PRINTER, "copies-supported", 1, 999);
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-current-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_CURRENT_TIME))
     ippAddDate(client->response, IPP_TAG_PRINTER, "printer-current-time", ippTimeToDate(time(NULL)));
 
-  if ((!ra || cupsArrayFind(ra, "printer-darkness-configured")) && data->darkness_supported > 0)
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-darkness-configured", data->darkness_configured);
-
-  if (!ra || cupsArrayFind(ra, "printer-dns-sd-name"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_DNS_SD_NAME))
     ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-dns-sd-name", NULL, printer->dns_sd_name ? printer->dns_sd_name : "");
 
   pthread_rwlock_rdlock(&client->system->rwlock);
   _papplSystemExportVersions(client->system, client->response, IPP_TAG_PRINTER, ra);
   pthread_rwlock_unlock(&client->system->rwlock);
 
-  if (!ra || cupsArrayFind(ra, "printer-geo-location"))
-  {
-    if (printer->geo_location)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-geo-location", NULL, printer->geo_location);
-    else
-      ippAddOutOfBand(client->response, IPP_TAG_PRINTER, IPP_TAG_UNKNOWN, "printer-geo-location");
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-icons"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_ICONS))
   {
     char	uris[3][1024];		// Buffers for URIs
     const char	*values[3];		// Values for attribute
@@ -339,46 +135,13 @@ _papplPrinterCopyAttributes(
     ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-icons", 3, NULL, values);
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-impressions-completed"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_IMPRESSIONS_COMPLETED))
     ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-impressions-completed", printer->impcompleted);
 
-  if (!ra || cupsArrayFind(ra, "printer-input-tray"))
-  {
-    ipp_attribute_t	*attr = NULL;	// "printer-input-tray" attribute
-    char		value[256];	// Value for current tray
-    pappl_media_col_t	*media;		// Media in the tray
-
-    for (i = 0, media = data->media_ready; i < data->num_source; i ++, media ++)
-    {
-      const char	*type;		// Tray type
-
-      if (!strcmp(data->source[i], "manual"))
-        type = "sheetFeedManual";
-      else if (!strcmp(data->source[i], "by-pass-tray"))
-        type = "sheetFeedAutoNonRemovableTray";
-      else
-        type = "sheetFeedAutoRemovableTray";
-
-      snprintf(value, sizeof(value), "type=%s;mediafeed=%d;mediaxfeed=%d;maxcapacity=%d;level=-2;status=0;name=%s;", type, media->size_length, media->size_width, !strcmp(media->source, "manual") ? 1 : -2, media->source);
-
-      if (attr)
-        ippSetOctetString(client->response, &attr, ippGetCount(attr), value, (int)strlen(value));
-      else
-        attr = ippAddOctetString(client->response, IPP_TAG_PRINTER, "printer-input-tray", value, (int)strlen(value));
-    }
-
-    // The "auto" tray is a dummy entry...
-    strlcpy(value, "type=other;mediafeed=0;mediaxfeed=0;maxcapacity=-2;level=-2;status=0;name=auto;", sizeof(value));
-    ippSetOctetString(client->response, &attr, ippGetCount(attr), value, (int)strlen(value));
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-is-accepting-jobs"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_IS_ACCEPTING_JOBS))
     ippAddBoolean(client->response, IPP_TAG_PRINTER, "printer-is-accepting-jobs", !printer->system->shutdown_time);
 
-  if (!ra || cupsArrayFind(ra, "printer-location"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-location", NULL, printer->location ? printer->location : "");
-
-  if (!ra || cupsArrayFind(ra, "printer-more-info"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_MORE_INFO))
   {
     char	uri[1024];		// URI value
 
@@ -386,25 +149,13 @@ _papplPrinterCopyAttributes(
     ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-more-info", NULL, uri);
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-organization"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organization", NULL, printer->organization ? printer->organization : "");
-
-  if (!ra || cupsArrayFind(ra, "printer-organizational-unit"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organizational-unit", NULL, printer->org_unit ? printer->org_unit : "");
-
-  if (!ra || cupsArrayFind(ra, "printer-resolution-default"))
-    ippAddResolution(client->response, IPP_TAG_PRINTER, "printer-resolution-default", IPP_RES_PER_INCH, data->x_default, data->y_default);
-
-  if (!ra || cupsArrayFind(ra, "printer-speed-default"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-speed-default", data->speed_default);
-
-  if (!ra || cupsArrayFind(ra, "printer-state-change-date-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_STATE_CHANGE_DATE_TIME))
     ippAddDate(client->response, IPP_TAG_PRINTER, "printer-state-change-date-time", ippTimeToDate(printer->state_time));
 
-  if (!ra || cupsArrayFind(ra, "printer-state-change-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_STATE_CHANGE_TIME))
     ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-state-change-time", (int)(printer->state_time - printer->start_time));
 
-  if (!ra || cupsArrayFind(ra, "printer-strings-languages-supported"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_STRINGS_LANGUAGES_SUPPORTED))
   {
     _pappl_resource_t	*r;		// Current resource
 
@@ -420,7 +171,7 @@ _papplPrinterCopyAttributes(
       ippAddStrings(printer->attrs, IPP_TAG_PRINTER, IPP_TAG_LANGUAGE, "printer-strings-languages-supported", num_values, NULL, svalues);
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-strings-uri"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_STRINGS_URI))
   {
     const char	*lang = ippGetString(ippFindAttribute(client->request, "attributes-natural-language", IPP_TAG_LANGUAGE), 0, NULL);
 					// Language
@@ -443,37 +194,7 @@ _papplPrinterCopyAttributes(
     pthread_rwlock_unlock(&printer->system->rwlock);
   }
 
-  if (printer->num_supply > 0)
-  {
-    pappl_supply_t	 *supply = printer->supply;
-					// Supply values...
-
-    if (!ra || cupsArrayFind(ra, "printer-supply"))
-    {
-      char		value[256];	// "printer-supply" value
-      ipp_attribute_t	*attr = NULL;	// "printer-supply" attribute
-
-      for (i = 0; i < printer->num_supply; i ++)
-      {
-	snprintf(value, sizeof(value), "index=%d;type=%s;maxcapacity=100;level=%d;colorantname=%s;", i, _papplSupplyTypeString(supply[i].type), supply[i].level, _papplSupplyColorString(supply[i].color));
-
-	if (attr)
-	  ippSetOctetString(client->response, &attr, ippGetCount(attr), value, (int)strlen(value));
-	else
-	  attr = ippAddOctetString(client->response, IPP_TAG_PRINTER, "printer-supply", value, (int)strlen(value));
-      }
-    }
-
-    if (!ra || cupsArrayFind(ra, "printer-supply-description"))
-    {
-      for (i = 0; i < printer->num_supply; i ++)
-        svalues[i] = supply[i].description;
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-supply-description", printer->num_supply, NULL, svalues);
-    }
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-supply-info-uri"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_SUPPLY_INFO_URI))
   {
     char	uri[1024];		// URI value
 
@@ -481,10 +202,10 @@ _papplPrinterCopyAttributes(
     ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-supply-info-uri", NULL, uri);
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-up-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_UP_TIME))
     ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-up-time", (int)(time(NULL) - printer->start_time));
 
-  if (!ra || cupsArrayFind(ra, "printer-uri-supported"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_URI_SUPPORTED))
   {
     char	uris[2][1024];		// Buffers for URIs
     const char	*values[2];		// Values for attribute
@@ -509,36 +230,28 @@ _papplPrinterCopyAttributes(
       ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-uri-supported", num_values, NULL, values);
   }
 
-  if (client->system->wifi_status_cb && httpAddrLocalhost(httpGetAddress(client->http)) && (!ra || cupsArrayFind(ra, "printer-wifi-ssid") || cupsArrayFind(ra, "printer-wifi-state")))
+  if (client->system->wifi_status_cb && httpAddrLocalhost(httpGetAddress(client->http)) && (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_WIFI_SSID) || _PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_WIFI_STATE)))
   {
     // Get Wi-Fi status...
     pappl_wifi_t	wifi;		// Wi-Fi status
 
     if ((client->system->wifi_status_cb)(client->system, client->system->wifi_cbdata, &wifi))
     {
-      if (!ra || cupsArrayFind(ra, "printer-wifi-ssid"))
+      if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_WIFI_SSID))
         ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-wifi-ssid", NULL, wifi.ssid);
 
-      if (!ra || cupsArrayFind(ra, "printer-wifi-state"))
+      if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_WIFI_STATE))
         ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "printer-wifi-state", (int)wifi.state);
     }
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-xri-supported"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_XRI_SUPPORTED))
     _papplPrinterCopyXRI(client, client->response, printer);
 
-  if (!ra || cupsArrayFind(ra, "queued-job-count"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_QUEUED_JOB_COUNT))
     ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "queued-job-count", cupsArrayCount(printer->active_jobs));
 
-  if (!ra || cupsArrayFind(ra, "sides-default"))
-  {
-    if (data->sides_default)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, _papplSidesString(data->sides_default));
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, "one-sided");
-  }
-
-  if (!ra || cupsArrayFind(ra, "uri-authentication-supported"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_URI_AUTHENTICATION_SUPPORTED))
   {
     // For each supported printer-uri value, report whether authentication is
     // supported.  Since we only support authentication over a secure (TLS)
@@ -588,19 +301,19 @@ _papplPrinterCopyState(
     pappl_client_t  *client,		// I - Client connection
     ipp_t           *ipp,		// I - IPP message
     pappl_printer_t *printer,		// I - Printer
-    cups_array_t    *ra)		// I - Requested attributes
+    _pappl_ra_t     *ra)		// I - Requested attributes
 {
-  if (!ra || cupsArrayFind(ra, "printer-state"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_STATE))
     ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_ENUM, "printer-state", (int)printer->state);
 
-  if (!ra || cupsArrayFind(ra, "printer-state-message"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_STATE_MESSAGE))
   {
     static const char * const messages[] = { "Idle.", "Printing.", "Stopped." };
 
     ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_TEXT), "printer-state-message", NULL, messages[printer->state - IPP_PSTATE_IDLE]);
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-state-reasons"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_ATTR_PRINTER_STATE_REASONS))
   {
     bool	wifi_not_configured = false;
 					// Need the 'wifi-not-configured' reason?
@@ -759,6 +472,13 @@ _papplPrinterProcessIPP(
 	ipp_resume_printer(client);
 	break;
 
+    case IPP_OP_CREATE_PRINTER_SUBSCRIPTIONS :
+    case IPP_OP_CREATE_JOB_SUBSCRIPTIONS :
+    case IPP_OP_CANCEL_SUBSCRIPTION :
+    case IPP_OP_GET_NOTIFICATIONS :
+	_papplSubscriptionProcessIPP(client);
+	break;
+
     default :
         if (client->system->op_cb && (client->system->op_cb)(client, client->system->op_cbdata))
           break;
@@ -1109,6 +829,120 @@ _papplPrinterSetAttributes(
 }
 
 
+//
+// 'copy_archived_jobs()' - Copy jobs from the job history archive.
+//
+// The archive files are only read when a client asks for completed jobs that
+// are no longer in memory.  Records are read from the end of each file so
+// that the newest jobs are reported first.
+//
+
+static int				// O - Number of jobs reported
+copy_archived_jobs(
+    pappl_client_t *client,		// I - Client
+    _pappl_ra_t    *ra,			// I - requested-attributes
+    const char     *username,		// I - Username or `NULL` for all
+    int            skip,		// I - Number of matching jobs to skip
+    int            count,		// I - Number of jobs reported so far
+    int            limit)		// I - Maximum number of jobs or `0` for no limit
+{
+  pappl_printer_t	*printer = client->printer;
+					// Printer
+  int			old,		// Reading the old archive?
+			fd;		// Archive file
+  char			filename[1024];	// Archive filename
+  struct stat		fileinfo;	// Archive information
+  off_t			offset;		// Offset of current records
+  _pappl_jobrec_t	recs[64],	// Job records
+			*rec;		// Current job record
+  size_t		nrecs;		// Number of job records
+  pappl_job_t		job;		// Job for archived record
+
+
+  if (!client->system->directory)
+    return (count);
+
+  memset(&job, 0, sizeof(job));
+  pthread_rwlock_init(&job.rwlock, NULL);
+
+  job.system     = client->system;
+  job.printer    = printer;
+  job.fd         = -1;
+  job.is_compact = true;
+
+  // Lock the archive so that it isn't rotated while we read it...
+  pthread_mutex_lock(&printer->archive_mutex);
+
+  for (old = 0; old < 2 && (limit <= 0 || count < limit); old ++)
+  {
+    if ((fd = open(_papplPrinterArchiveFilename(printer, filename, sizeof(filename), old != 0), O_RDONLY | O_NOFOLLOW | O_CLOEXEC)) < 0)
+      continue;
+
+    if (fstat(fd, &fileinfo))
+    {
+      close(fd);
+      continue;
+    }
+
+    offset = fileinfo.st_size - fileinfo.st_size % (off_t)sizeof(_pappl_jobrec_t);
+
+    while (offset > 0 && (limit <= 0 || count < limit))
+    {
+      // Read the previous block of records...
+      if ((nrecs = (size_t)offset / sizeof(_pappl_jobrec_t)) > (sizeof(recs) / sizeof(recs[0])))
+        nrecs = sizeof(recs) / sizeof(recs[0]);
+
+      offset -= (off_t)(nrecs * sizeof(_pappl_jobrec_t));
+
+      if (pread(fd, recs, nrecs * sizeof(_pappl_jobrec_t), offset) != (ssize_t)(nrecs * sizeof(_pappl_jobrec_t)))
+        break;
+
+      for (rec = recs + nrecs - 1; rec >= recs && (limit <= 0 || count < limit); rec --)
+      {
+        rec->username[sizeof(rec->username) - 1] = '\0';
+        rec->format[sizeof(rec->format) - 1]     = '\0';
+        rec->name[sizeof(rec->name) - 1]         = '\0';
+
+        if (username && strcasecmp(username, rec->username))
+          continue;
+
+        if (skip > 0)
+        {
+          skip --;
+          continue;
+        }
+
+        job.job_id        = rec->job_id;
+        job.name          = rec->name;
+        job.username      = rec->username;
+        job.format        = rec->format;
+        job.state         = (ipp_jstate_t)rec->state;
+        job.state_reasons = (pappl_jreason_t)rec->state_reasons;
+        job.impressions   = rec->impressions;
+        job.impcompleted  = rec->impcompleted;
+        job.created       = (time_t)rec->created;
+        job.processing    = (time_t)rec->processing;
+        job.completed     = (time_t)rec->completed;
+
+	if (count > 0)
+	  ippAddSeparator(client->response);
+
+	count ++;
+	_papplJobCopyAttributes(client, &job, ra);
+      }
+    }
+
+    close(fd);
+  }
+
+  pthread_mutex_unlock(&printer->archive_mutex);
+
+  pthread_rwlock_destroy(&job.rwlock);
+
+  return (count);
+}
+
+
 //
 // 'create_job()' - Create a new job object from a Print-Job or Create-Job
 //                  request.
@@ -1140,6 +974,39 @@ create_job(
 }
 
 
+//
+// 'find_user_jobs()' - Find the index of the first job for a user.
+//
+// The user jobs array is sorted by username and then newest job first, so a
+// binary search finds the start of the user's jobs without walking the whole
+// job history.
+//
+
+static int				// O - Index of first job
+find_user_jobs(cups_array_t *jobs,	// I - User jobs array
+               const char   *username)	// I - Username
+{
+  int		left,			// Left side of search
+		right,			// Right side of search
+		current;		// Current element
+  pappl_job_t	*job;			// Current job
+
+
+  for (left = 0, right = cupsArrayCount(jobs); left < right;)
+  {
+    current = (left + right) / 2;
+    job     = (pappl_job_t *)cupsArrayIndex(jobs, current);
+
+    if (strcasecmp(job->username ? job->username : "", username) < 0)
+      left = current + 1;
+    else
+      right = current;
+  }
+
+  return (left);
+}
+
+
 //
 // 'ipp_cancel_current_job()' - Cancel the current job.
 //
@@ -1216,7 +1083,15 @@ static void
 ipp_create_job(pappl_client_t *client)	// I - Client
 {
   pappl_job_t		*job;		// New job
-  cups_array_t		*ra;		// Attributes to send in response
+  _pappl_ra_t		*ra;		// Attributes to send in response
+  static const char * const job_attrs[] =
+  {					// Attributes to return
+    "job-id",
+    "job-state",
+    "job-state-message",
+    "job-state-reasons",
+    "job-uri"
+  };
 
 
   // Do we have a file to print?
@@ -1239,17 +1114,16 @@ ipp_create_job(pappl_client_t *client)	// I - Client
   }
 
   // Return the job info...
-  papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
+  if (!_papplCreateRequestedNames(sizeof(job_attrs) / sizeof(job_attrs[0]), job_attrs, &ra))
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_INTERNAL, "Unable to allocate memory.");
+    return;
+  }
 
-  ra = cupsArrayNew((cups_array_func_t)strcmp, NULL);
-  cupsArrayAdd(ra, "job-id");
-  cupsArrayAdd(ra, "job-state");
-  cupsArrayAdd(ra, "job-state-message");
-  cupsArrayAdd(ra, "job-state-reasons");
-  cupsArrayAdd(ra, "job-uri");
+  papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
   _papplJobCopyAttributes(client, job, ra);
-  cupsArrayDelete(ra);
+  _papplDeleteRequested(ra);
 }
 
 
@@ -1267,11 +1141,16 @@ ipp_get_jobs(pappl_client_t *client)	// I - Client
   ipp_jstate_t		job_state;	// job-state value
   int			i,		// Looping var
 			limit,		// Maximum number of jobs to return
-			count;		// Number of jobs that match
+			first_index,	// First job to return (1-based)
+			skip,		// Number of matching jobs to skip
+			count,		// Number of jobs that match
+			max_jobs;	// Maximum number of jobs to collect
+  ipp_attribute_t	*job_ids;	// "job-ids" attribute
   const char		*username;	// Username
   cups_array_t		*list;		// Jobs list
-  pappl_job_t		*job;		// Current job pointer
-  cups_array_t		*ra;		// Requested attributes array
+  pappl_job_t		*job,		// Current job pointer
+			**jobs = NULL;	// Matching jobs
+  _pappl_ra_t		*ra;		// Requested attributes array
 
 
   // See if the "which-jobs" attribute have been specified...
@@ -1339,35 +1218,124 @@ ipp_get_jobs(pappl_client_t *client)	// I - Client
     }
   }
 
+  // See if they want to start at a particular job or only see specific jobs...
+  if ((attr = ippFindAttribute(client->request, "first-index", IPP_TAG_ZERO)) != NULL)
+  {
+    if (ippGetGroupTag(attr) != IPP_TAG_OPERATION || ippGetValueTag(attr) != IPP_TAG_INTEGER || ippGetCount(attr) != 1 || ippGetInteger(attr, 0) < 1)
+    {
+      papplClientRespondIPPUnsupported(client, attr);
+      return;
+    }
+
+    first_index = ippGetInteger(attr, 0);
+
+    papplLogClient(client, PAPPL_LOGLEVEL_DEBUG, "Get-Jobs \"first-index\"='%d'", first_index);
+  }
+  else
+    first_index = 1;
+
+  if ((job_ids = ippFindAttribute(client->request, "job-ids", IPP_TAG_ZERO)) != NULL)
+  {
+    if (ippGetGroupTag(job_ids) != IPP_TAG_OPERATION || ippGetValueTag(job_ids) != IPP_TAG_INTEGER)
+    {
+      papplClientRespondIPPUnsupported(client, job_ids);
+      return;
+    }
+  }
+
   // OK, build a list of jobs for this printer...
-  ra = ippCreateRequestedArray(client->request);
+  if (!_papplCreateRequested(client->request, &ra))
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_INTERNAL, "Unable to allocate memory.");
+    return;
+  }
 
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
+  // Collect the matching jobs with the printer locked, then copy their
+  // attributes without it since each job has to be locked in turn...
   pthread_rwlock_rdlock(&(client->printer->rwlock));
 
-  count = cupsArrayCount(list);
-  if (limit <= 0 || limit > count)
-    limit = count;
+  count = 0;
+  skip  = first_index - 1;
 
-  for (count = 0, i = 0; i < limit; i ++)
+  if ((max_jobs = cupsArrayCount(client->printer->all_jobs)) > limit && limit > 0)
+    max_jobs = limit;
+
+  if (max_jobs > 0 && (jobs = (pappl_job_t **)calloc((size_t)max_jobs, sizeof(pappl_job_t *))) == NULL)
   {
-    job = (pappl_job_t *)cupsArrayIndex(list, i);
+    pthread_rwlock_unlock(&(client->printer->rwlock));
+    _papplDeleteRequested(ra);
 
-    // Filter out jobs that don't match...
-    if ((job_comparison < 0 && job->state > job_state) || /* (job_comparison == 0 && job->state != job_state) || */ (job_comparison > 0 && job->state < job_state) || (username && job->username && strcasecmp(username, job->username)))
-      continue;
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_INTERNAL, "Unable to allocate memory.");
+    return;
+  }
 
-    if (count > 0)
-      ippAddSeparator(client->response);
+  if (job_ids)
+  {
+    // Look up the requested jobs directly...
+    pappl_job_t	key;			// Search key
+
+    for (i = 0; i < ippGetCount(job_ids) && count < max_jobs; i ++)
+    {
+      key.job_id = ippGetInteger(job_ids, i);
+
+      if ((job = (pappl_job_t *)cupsArrayFind(client->printer->all_jobs, &key)) == NULL || (username && job->username && strcasecmp(username, job->username)))
+        continue;
+
+      jobs[count ++] = _papplJobRetain(job);
+    }
+  }
+  else if (username)
+  {
+    // Only walk the jobs for this user...
+    for (i = find_user_jobs(client->printer->user_jobs, username); (job = (pappl_job_t *)cupsArrayIndex(client->printer->user_jobs, i)) != NULL && count < max_jobs; i ++)
+    {
+      if (strcasecmp(username, job->username ? job->username : ""))
+        break;
+
+      // Filter out jobs that don't match...
+      if ((job_comparison < 0 && job->state > job_state) || (job_comparison > 0 && job->state < job_state))
+        continue;
+
+      if (skip > 0)
+      {
+        skip --;
+        continue;
+      }
 
-    count ++;
-    _papplJobCopyAttributes(client, job, ra);
+      jobs[count ++] = _papplJobRetain(job);
+    }
   }
+  else
+  {
+    // The job arrays only contain jobs in the requested states, so start at
+    // the requested index...
+    for (i = skip; (job = (pappl_job_t *)cupsArrayIndex(list, i)) != NULL && count < max_jobs; i ++)
+      jobs[count ++] = _papplJobRetain(job);
 
-  cupsArrayDelete(ra);
+    if ((skip -= cupsArrayCount(list)) < 0)
+      skip = 0;
+  }
 
   pthread_rwlock_unlock(&(client->printer->rwlock));
+
+  for (i = 0; i < count; i ++)
+  {
+    if (i > 0)
+      ippAddSeparator(client->response);
+
+    _papplJobCopyAttributes(client, jobs[i], ra);
+    _papplJobRelease(jobs[i]);
+  }
+
+  free(jobs);
+
+  // Older completed jobs come from the job history archive...
+  if (!job_ids && job_comparison > 0 && (limit <= 0 || count < limit))
+    copy_archived_jobs(client, ra, username, skip, count, limit);
+
+  _papplDeleteRequested(ra);
 }
 
 
@@ -1379,7 +1347,7 @@ static void
 ipp_get_printer_attributes(
     pappl_client_t *client)		// I - Client
 {
-  cups_array_t		*ra;		// Requested attributes array
+  _pappl_ra_t		*ra;		// Requested attributes array
   pappl_printer_t	*printer = client->printer;
 					// Printer
 
@@ -1392,7 +1360,11 @@ ipp_get_printer_attributes(
   }
 
   // Send the attributes...
-  ra = ippCreateRequestedArray(client->request);
+  if (!_papplCreateRequested(client->request, &ra))
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_INTERNAL, "Unable to allocate memory.");
+    return;
+  }
 
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
@@ -1402,7 +1374,7 @@ ipp_get_printer_attributes(
 
   pthread_rwlock_unlock(&(printer->rwlock));
 
-  cupsArrayDelete(ra);
+  _papplDeleteRequested(ra);
 }
 
 
@@ -1564,6 +1536,317 @@ ipp_validate_job(
 }
 
 
+//
+// 'make_attributes()' - Make the cached configuration attributes for a printer.
+//
+// These attributes only depend on the printer configuration, driver defaults,
+// ready media, and supplies, so they are cached until the printer generation
+// counter changes.
+//
+
+static ipp_t *				// O - Attributes
+make_attributes(
+    pappl_printer_t *printer)		// I - Printer
+{
+  ipp_t		*attrs;			// Attributes
+  int		i,			// Looping var
+		num_values;		// Number of values
+  unsigned	bit;			// Current bit value
+  const char	*svalues[100];		// String values
+  int		ivalues[100];		// Integer values
+  pappl_pr_driver_data_t *data = &printer->driver_data;
+					// Driver data
+
+
+  attrs = ippNew();
+
+  // identify-actions-default
+  for (num_values = 0, bit = PAPPL_IDENTIFY_ACTIONS_DISPLAY; bit <= PAPPL_IDENTIFY_ACTIONS_SPEAK; bit *= 2)
+  {
+    if (data->identify_default & bit)
+      svalues[num_values ++] = _papplIdentifyActionsString(bit);
+  }
+
+  if (num_values > 0)
+    ippAddStrings(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", num_values, NULL, svalues);
+  else
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", NULL, "none");
+
+  // label-mode-configured
+  if (data->mode_configured)
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "label-mode-configured", NULL, _papplLabelModeString(data->mode_configured));
+
+  // label-tear-offset-configured
+  if (data->tear_offset_supported[1] > 0)
+    ippAddInteger(attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "label-tear-offset-configured", data->tear_offset_configured);
+
+  if (printer->num_supply > 0)
+  {
+    pappl_supply_t	*supply = printer->supply;
+					// Supply values...
+    char		value[256];	// "printer-supply" value
+    ipp_attribute_t	*attr = NULL;	// "printer-supply" attribute
+
+    // marker-colors
+    for (i = 0; i < printer->num_supply; i ++)
+      svalues[i] = _papplMarkerColorString(supply[i].color);
+
+    ippAddStrings(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_NAME), "marker-colors", printer->num_supply, NULL, svalues);
+
+    // marker-high-levels
+    for (i = 0; i < printer->num_supply; i ++)
+      ivalues[i] = supply[i].is_consumed ? 100 : 90;
+
+    ippAddIntegers(attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-high-levels", printer->num_supply, ivalues);
+
+    // marker-levels
+    for (i = 0; i < printer->num_supply; i ++)
+      ivalues[i] = supply[i].level;
+
+    ippAddIntegers(attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-levels", printer->num_supply, ivalues);
+
+    // marker-low-levels
+    for (i = 0; i < printer->num_supply; i ++)
+      ivalues[i] = supply[i].is_consumed ? 10 : 0;
+
+    ippAddIntegers(attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-low-levels", printer->num_supply, ivalues);
+
+    // marker-names
+    for (i = 0; i < printer->num_supply; i ++)
+      svalues[i] = supply[i].description;
+
+    ippAddStrings(attrs, IPP_TAG_PRINTER, IPP_TAG_NAME, "marker-names", printer->num_supply, NULL, svalues);
+
+    // marker-types
+    for (i = 0; i < printer->num_supply; i ++)
+      svalues[i] = _papplMarkerTypeString(supply[i].type);
+
+    ippAddStrings(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "marker-types", printer->num_supply, NULL, svalues);
+
+    // printer-supply
+    for (i = 0; i < printer->num_supply; i ++)
+    {
+      snprintf(value, sizeof(value), "index=%d;type=%s;maxcapacity=100;level=%d;colorantname=%s;", i, _papplSupplyTypeString(supply[i].type), supply[i].level, _papplSupplyColorString(supply[i].color));
+
+      if (attr)
+	ippSetOctetString(attrs, &attr, ippGetCount(attr), value, (int)strlen(value));
+      else
+	attr = ippAddOctetString(attrs, IPP_TAG_PRINTER, "printer-supply", value, (int)strlen(value));
+    }
+
+    // printer-supply-description
+    for (i = 0; i < printer->num_supply; i ++)
+      svalues[i] = supply[i].description;
+
+    ippAddStrings(attrs, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-supply-description", printer->num_supply, NULL, svalues);
+  }
+
+  // media-col-default
+  if (data->media_default.size_name[0])
+  {
+    ipp_t *col = _papplMediaColExport(&printer->driver_data, &data->media_default, 0);
+					// Collection value
+
+    ippAddCollection(attrs, IPP_TAG_PRINTER, "media-col-default", col);
+    ippDelete(col);
+  }
+
+  // media-col-ready
+  {
+    int			j,		// Looping var
+			count;		// Number of values
+    ipp_t		*col;		// Collection value
+    ipp_attribute_t	*attr;		// media-col-ready attribute
+    pappl_media_col_t	media;		// Current media...
+
+    for (i = 0, count = 0; i < data->num_source; i ++)
+    {
+      if (data->media_ready[i].size_name[0])
+        count ++;
+    }
+
+    if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
+      count *= 2;			// Need to report ready media for borderless, too...
+
+    if (count > 0)
+    {
+      attr = ippAddCollections(attrs, IPP_TAG_PRINTER, "media-col-ready", count, NULL);
+
+      for (i = 0, j = 0; i < data->num_source && j < count; i ++)
+      {
+	if (data->media_ready[i].size_name[0])
+	{
+          if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
+	  {
+	    // Report both bordered and borderless media-col values...
+	    media = data->media_ready[i];
+
+	    media.bottom_margin = media.top_margin   = data->bottom_top;
+	    media.left_margin   = media.right_margin = data->left_right;
+	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
+	    ippSetCollection(attrs, &attr, j ++, col);
+	    ippDelete(col);
+
+	    media.bottom_margin = media.top_margin   = 0;
+	    media.left_margin   = media.right_margin = 0;
+	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
+	    ippSetCollection(attrs, &attr, j ++, col);
+	    ippDelete(col);
+	  }
+	  else
+	  {
+	    // Just report the single media-col value...
+	    col = _papplMediaColExport(&printer->driver_data, data->media_ready + i, 0);
+	    ippSetCollection(attrs, &attr, j ++, col);
+	    ippDelete(col);
+	  }
+	}
+      }
+    }
+  }
+
+  // media-default
+  if (data->media_default.size_name[0])
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-default", NULL, data->media_default.size_name);
+
+  // media-ready
+  {
+    int			j,		// Looping vars
+			count;		// Number of values
+    ipp_attribute_t	*attr;		// media-col-ready attribute
+
+    for (i = 0, count = 0; i < data->num_source; i ++)
+    {
+      if (data->media_ready[i].size_name[0])
+        count ++;
+    }
+
+    if (count > 0)
+    {
+      attr = ippAddStrings(attrs, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-ready", count, NULL, NULL);
+
+      for (i = 0, j = 0; i < data->num_source && j < count; i ++)
+      {
+	if (data->media_ready[i].size_name[0])
+	  ippSetString(attrs, &attr, j ++, data->media_ready[i].size_name);
+      }
+    }
+  }
+
+  // multiple-document-handling-default
+  ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "multiple-document-handling-default", NULL, "separate-documents-collated-copies");
+
+  // orientation-requested-default
+  ippAddInteger(attrs, IPP_TAG_PRINTER, IPP_TAG_ENUM, "orientation-requested-default", (int)data->orient_default);
+
+  // output-bin-default
+  if (data->num_bin > 0)
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, data->bin[data->bin_default]);
+  else if (data->output_face_up)
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-up");
+  else
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-down");
+
+  // print-color-mode-default
+  if (data->color_default)
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-color-mode-default", NULL, _papplColorModeString(data->color_default));
+
+  // print-content-optimize-default
+  if (data->content_default)
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, _papplContentString(data->content_default));
+  else
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, "auto");
+
+  // print-quality-default
+  if (data->quality_default)
+    ippAddInteger(attrs, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", (int)data->quality_default);
+  else
+    ippAddInteger(attrs, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", IPP_QUALITY_NORMAL);
+
+  // print-scaling-default
+  if (data->scaling_default)
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, _papplScalingString(data->scaling_default));
+  else
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, "auto");
+
+  // printer-config-change-date-time
+  ippAddDate(attrs, IPP_TAG_PRINTER, "printer-config-change-date-time", ippTimeToDate(printer->config_time));
+
+  // printer-config-change-time
+  ippAddInteger(attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-config-change-time", (int)(printer->config_time - printer->start_time));
+
+  // printer-contact-col
+  {
+    ipp_t *col = _papplContactExport(&printer->contact);
+    ippAddCollection(attrs, IPP_TAG_PRINTER, "printer-contact-col", col);
+    ippDelete(col);
+  }
+
+  // printer-darkness-configured
+  if (data->darkness_supported > 0)
+    ippAddInteger(attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-darkness-configured", data->darkness_configured);
+
+  // printer-geo-location
+  if (printer->geo_location)
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-geo-location", NULL, printer->geo_location);
+  else
+    ippAddOutOfBand(attrs, IPP_TAG_PRINTER, IPP_TAG_UNKNOWN, "printer-geo-location");
+
+  // printer-input-tray
+  {
+    ipp_attribute_t	*attr = NULL;	// "printer-input-tray" attribute
+    char		value[256];	// Value for current tray
+    pappl_media_col_t	*media;		// Media in the tray
+
+    for (i = 0, media = data->media_ready; i < data->num_source; i ++, media ++)
+    {
+      const char	*type;		// Tray type
+
+      if (!strcmp(data->source[i], "manual"))
+        type = "sheetFeedManual";
+      else if (!strcmp(data->source[i], "by-pass-tray"))
+        type = "sheetFeedAutoNonRemovableTray";
+      else
+        type = "sheetFeedAutoRemovableTray";
+
+      snprintf(value, sizeof(value), "type=%s;mediafeed=%d;mediaxfeed=%d;maxcapacity=%d;level=-2;status=0;name=%s;", type, media->size_length, media->size_width, !strcmp(media->source, "manual") ? 1 : -2, media->source);
+
+      if (attr)
+        ippSetOctetString(attrs, &attr, ippGetCount(attr), value, (int)strlen(value));
+      else
+        attr = ippAddOctetString(attrs, IPP_TAG_PRINTER, "printer-input-tray", value, (int)strlen(value));
+    }
+
+    // The "auto" tray is a dummy entry...
+    strlcpy(value, "type=other;mediafeed=0;mediaxfeed=0;maxcapacity=-2;level=-2;status=0;name=auto;", sizeof(value));
+    ippSetOctetString(attrs, &attr, ippGetCount(attr), value, (int)strlen(value));
+  }
+
+  // printer-location
+  ippAddString(attrs, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-location", NULL, printer->location ? printer->location : "");
+
+  // printer-organization
+  ippAddString(attrs, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organization", NULL, printer->organization ? printer->organization : "");
+
+  // printer-organizational-unit
+  ippAddString(attrs, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organizational-unit", NULL, printer->org_unit ? printer->org_unit : "");
+
+  // printer-resolution-default
+  ippAddResolution(attrs, IPP_TAG_PRINTER, "printer-resolution-default", IPP_RES_PER_INCH, data->x_default, data->y_default);
+
+  // printer-speed-default
+  ippAddInteger(attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-speed-default", data->speed_default);
+
+  // sides-default
+  if (data->sides_default)
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, _papplSidesString(data->sides_default));
+  else
+    ippAddString(attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, "one-sided");
+
+  return (attrs);
+}
+
+
 //
 // 'valid_job_attributes()' - Determine whether the job attributes are valid.
 //
@@ -17,6 +17,7 @@
 
 #  include "dnssd-private.h"
 #  include "printer.h"
+#  include "subscription-private.h"
 #  include "log.h"
 #  include <grp.h>
 #  ifdef __APPLE__
@@ -42,10 +43,26 @@
 #  include "device.h"
 
 
+//
+// Constants...
+//
+
+#  define _PAPPL_BUFFER_ALIGN	64	// Alignment of pooled line/band buffers
+#  define _PAPPL_MAX_BUFFERS	8	// Maximum number of pooled buffers per printer
+#  define _PAPPL_MAX_BUFFER_SIZE	262144	// Maximum size of a pooled buffer
+
+
 //
 // Types and structures...
 //
 
+typedef struct _pappl_buffer_s		// Pooled line/band buffer
+{
+  unsigned char		*data;			// Buffer memory
+  size_t		size;			// Size of buffer in bytes
+  bool			in_use;			// Is the buffer in use?
+} _pappl_buffer_t;
+
 struct _pappl_printer_s			// Printer data
 {
   pthread_rwlock_t	rwlock;			// Reader/writer lock
@@ -72,8 +89,13 @@ struct _pappl_printer_s			// Printer data
   bool			device_in_use;		// Is the device in use?
   char			*driver_name;		// Driver name
   pappl_pr_driver_data_t driver_data;	// Driver data
+  pappl_pr_rwriteblank_cb_t rwriteblank_cb;	// Write blank raster lines callback, if any
   ipp_t			*driver_attrs;		// Driver attributes
   ipp_t			*attrs;			// Other (static) printer attributes
+  size_t		generation;		// Configuration generation counter
+  pthread_rwlock_t	cache_rwlock;		// Reader/writer lock for cached attributes
+  ipp_t			*cache_attrs;		// Cached configuration attributes
+  size_t		cache_generation;	// Generation of cached attributes
   time_t		start_time;		// Startup time
   time_t		config_time;		// "printer-config-change-time" value
   time_t		status_time;		// Last time status was updated
@@ -87,10 +109,22 @@ struct _pappl_printer_s			// Printer data
 			max_completed_jobs;	// Maximum number of completed jobs to retain in history
   cups_array_t		*active_jobs,		// Array of active jobs
 			*all_jobs,		// Array of all jobs
-			*completed_jobs;	// Array of completed jobs
+			*completed_jobs,	// Array of completed jobs
+			*user_jobs;		// Array of all jobs by username
+  pthread_mutex_t	archive_mutex;		// Mutex for job history archive
   int			next_job_id,		// Next "job-id" value
 			impcompleted;		// "printer-impressions-completed" value
   cups_array_t		*links;			// Web navigation links
+  pthread_mutex_t	event_mutex;		// Mutex for events and subscriptions
+  pthread_cond_t	event_cond;		// Condition for new events
+  int			event_waiters;		// Number of "notify-wait" clients waiting for events
+  _pappl_event_rec_t	*events;		// Event ring, if any
+  int			event_seq;		// Last printer event number
+  cups_array_t		*subscriptions;		// Subscriptions, if any
+  int			last_subscription_id;	// Last "notify-subscription-id" value
+  pthread_mutex_t	buffers_mutex;		// Mutex for line/band buffers
+  _pappl_buffer_t	buffers[_PAPPL_MAX_BUFFERS];
+						// Line/band buffer pool
 #  ifdef HAVE_DNSSD
   _pappl_srv_t		dns_sd_ipp_ref,		// DNS-SD IPP service
 			dns_sd_ipps_ref,	// DNS-SD IPPS service
@@ -125,12 +159,15 @@ extern void		*_papplPrinterRunRaw(pappl_printer_t *printer) _PAPPL_PRIVATE;
 
 extern void		*_papplPrinterRunUSB(pappl_printer_t *printer) _PAPPL_PRIVATE;
 
+extern void		*_papplPrinterAllocBuffer(pappl_printer_t *printer, size_t size) _PAPPL_PRIVATE;
+extern char		*_papplPrinterArchiveFilename(pappl_printer_t *printer, char *fname, size_t fnamesize, bool old) _PAPPL_PRIVATE;
 extern void		_papplPrinterCheckJobs(pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterCleanJobs(pappl_printer_t *printer) _PAPPL_PRIVATE;
-extern void		_papplPrinterCopyAttributes(pappl_client_t *client, pappl_printer_t *printer, cups_array_t *ra, const char *format) _PAPPL_PRIVATE;
-extern void		_papplPrinterCopyState(pappl_client_t *client, ipp_t *ipp, pappl_printer_t *printer, cups_array_t *ra) _PAPPL_PRIVATE;
+extern void		_papplPrinterCopyAttributes(pappl_client_t *client, pappl_printer_t *printer, _pappl_ra_t *ra, const char *format) _PAPPL_PRIVATE;
+extern void		_papplPrinterCopyState(pappl_client_t *client, ipp_t *ipp, pappl_printer_t *printer, _pappl_ra_t *ra) _PAPPL_PRIVATE;
 extern void		_papplPrinterCopyXRI(pappl_client_t *client, ipp_t *ipp, pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterDelete(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplPrinterFreeBuffer(pappl_printer_t *printer, void *data) _PAPPL_PRIVATE;
 extern void		_papplPrinterInitDriverData(pappl_pr_driver_data_t *d) _PAPPL_PRIVATE;
 extern void		_papplPrinterProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
 extern bool		_papplPrinterRegisterDNSSDNoLock(pappl_printer_t *printer) _PAPPL_PRIVATE;
@@ -213,10 +213,12 @@ _papplPrinterRunRaw(
 	  cupsArrayRemove(printer->active_jobs, job);
 	  cupsArrayAdd(printer->completed_jobs, job);
 
-	  if (!printer->system->clean_time)
-	    printer->system->clean_time = time(NULL) + 60;
+	  _papplJobScheduleCleanup(job);
+	  _papplPrinterAddEvent(job->printer, job, _PAPPL_EVENT_JOB_COMPLETED | _PAPPL_EVENT_JOB_STATE_CHANGED);
 
 	  pthread_rwlock_unlock(&printer->rwlock);
+
+	  _papplJobRemoveAttributes(job);
         }
       }
     }
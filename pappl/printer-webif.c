@@ -1316,6 +1316,13 @@ _papplPrinterWebSupplies(
   };
 
 
+  if (!printer->driver_data.has_supplies)
+  {
+    // No supplies page for this printer...
+    papplClientRespond(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0, 0);
+    return;
+  }
+
   num_supply = papplPrinterGetSupplies(printer, (int)(sizeof(supply) / sizeof(supply[0])), supply);
 
   papplClientHTMLPrinterHeader(client, printer, "Supplies", 0, NULL, NULL);
@@ -22,6 +22,94 @@
 static int	compare_active_jobs(pappl_job_t *a, pappl_job_t *b);
 static int	compare_all_jobs(pappl_job_t *a, pappl_job_t *b);
 static int	compare_completed_jobs(pappl_job_t *a, pappl_job_t *b);
+static int	compare_user_jobs(pappl_job_t *a, pappl_job_t *b);
+
+
+//
+// '_papplPrinterAllocBuffer()' - Get a line or band buffer from the printer's pool.
+//
+// The returned buffer is aligned to `_PAPPL_BUFFER_ALIGN` bytes and must be
+// released with `_papplPrinterFreeBuffer`.  Pooled buffers only ever grow, so
+// after the first (largest) page they are reused across pages and jobs without
+// further allocations.  Requests larger than `_PAPPL_MAX_BUFFER_SIZE` (e.g.,
+// image scaling or rotation buffers) or made while all pooled buffers are in
+// use get a separate buffer that is freed when released, so the pool only
+// keeps line-sized buffers.
+//
+
+void *					// O - Buffer or `NULL` on error
+_papplPrinterAllocBuffer(
+    pappl_printer_t *printer,		// I - Printer
+    size_t          size)		// I - Minimum size in bytes
+{
+  int			i;		// Looping var
+  _pappl_buffer_t	*buffer,	// Current buffer
+			*fit = NULL,	// Smallest free buffer that fits
+			*grow = NULL;	// Largest free buffer that doesn't
+  void			*data;		// Buffer memory
+
+
+  // Round the size up so that small differences don't cause a reallocation...
+  size = (size + 4095) & ~(size_t)4095;
+
+  if (size > _PAPPL_MAX_BUFFER_SIZE)
+  {
+    // Don't keep large buffers around after the job...
+    if (posix_memalign(&data, _PAPPL_BUFFER_ALIGN, size))
+      return (NULL);
+    else
+      return (data);
+  }
+
+  pthread_mutex_lock(&printer->buffers_mutex);
+
+  for (i = _PAPPL_MAX_BUFFERS, buffer = printer->buffers; i > 0; i --, buffer ++)
+  {
+    if (buffer->in_use)
+      continue;
+
+    if (buffer->size >= size)
+    {
+      if (!fit || buffer->size < fit->size)
+        fit = buffer;
+    }
+    else if (!grow || buffer->size > grow->size)
+    {
+      grow = buffer;
+    }
+  }
+
+  if (!fit && grow)
+  {
+    // Grow a free buffer to the new size...
+    if (posix_memalign(&data, _PAPPL_BUFFER_ALIGN, size))
+    {
+      pthread_mutex_unlock(&printer->buffers_mutex);
+      return (NULL);
+    }
+
+    free(grow->data);
+
+    grow->data = data;
+    grow->size = size;
+    fit        = grow;
+  }
+
+  if (fit)
+  {
+    fit->in_use = true;
+    data        = fit->data;
+  }
+  else if (posix_memalign(&data, _PAPPL_BUFFER_ALIGN, size))
+  {
+    // All buffers are in use and we couldn't allocate a new one...
+    data = NULL;
+  }
+
+  pthread_mutex_unlock(&printer->buffers_mutex);
+
+  return (data);
+}
 
 
 //
@@ -36,12 +124,17 @@ void
 papplPrinterCancelAllJobs(
     pappl_printer_t *printer)		// I - Printer
 {
-  pappl_job_t	*job;			// Job information
+  pappl_job_t	*job,			// Job information
+		**jobs;			// Canceled jobs
+  int		i,			// Looping var
+		num_jobs = 0;		// Number of canceled jobs
 
 
   // Loop through all jobs and cancel them...
   pthread_rwlock_wrlock(&printer->rwlock);
 
+  jobs = (pappl_job_t **)calloc((size_t)cupsArrayCount(printer->active_jobs) + 1, sizeof(pappl_job_t *));
+
   for (job = (pappl_job_t *)cupsArrayFirst(printer->active_jobs); job; job = (pappl_job_t *)cupsArrayNext(printer->active_jobs))
   {
     // Cancel this job...
@@ -58,13 +151,27 @@ papplPrinterCancelAllJobs(
 
       cupsArrayRemove(printer->active_jobs, job);
       cupsArrayAdd(printer->completed_jobs, job);
+
+      _papplJobScheduleCleanup(job);
+      _papplPrinterAddEvent(job->printer, job, _PAPPL_EVENT_JOB_COMPLETED | _PAPPL_EVENT_JOB_STATE_CHANGED);
+
+      if (jobs)
+        jobs[num_jobs ++] = _papplJobRetain(job);
+      else
+        _papplJobRemoveAttributes(job);
     }
   }
 
   pthread_rwlock_unlock(&printer->rwlock);
 
-  if (!printer->system->clean_time)
-    printer->system->clean_time = time(NULL) + 60;
+  // Remove the attributes files after the printer is unlocked...
+  for (i = 0; i < num_jobs; i ++)
+  {
+    _papplJobRemoveAttributes(jobs[i]);
+    _papplJobRelease(jobs[i]);
+  }
+
+  free(jobs);
 }
 
 
@@ -135,6 +242,10 @@ papplPrinterCreate(
     IPP_OP_PAUSE_PRINTER,
     IPP_OP_RESUME_PRINTER,
     IPP_OP_SET_PRINTER_ATTRIBUTES,
+    IPP_OP_CREATE_PRINTER_SUBSCRIPTIONS,
+    IPP_OP_CREATE_JOB_SUBSCRIPTIONS,
+    IPP_OP_CANCEL_SUBSCRIPTION,
+    IPP_OP_GET_NOTIFICATIONS,
     IPP_OP_CANCEL_MY_JOBS,
     IPP_OP_CLOSE_JOB,
     IPP_OP_IDENTIFY_PRINTER
@@ -185,6 +296,13 @@ papplPrinterCreate(
     "fit",
     "none"
   };
+  static const char * const notify_events[] =
+  {					// notify-events-supported values
+    "job-completed",
+    "job-created",
+    "job-state-changed",
+    "printer-state-changed"
+  };
   static const char * const uri_security[] =
   {					// uri-security-supported values
     "none",
@@ -254,6 +372,11 @@ papplPrinterCreate(
 
   // Initialize printer structure and attributes...
   pthread_rwlock_init(&printer->rwlock, NULL);
+  pthread_rwlock_init(&printer->cache_rwlock, NULL);
+  pthread_mutex_init(&printer->event_mutex, NULL);
+  pthread_cond_init(&printer->event_cond, NULL);
+  pthread_mutex_init(&printer->buffers_mutex, NULL);
+  pthread_mutex_init(&printer->archive_mutex, NULL);
 
   printer->system             = system;
   printer->name               = strdup(printer_name);
@@ -270,9 +393,10 @@ papplPrinterCreate(
   printer->state              = IPP_PSTATE_IDLE;
   printer->state_reasons      = PAPPL_PREASON_NONE;
   printer->state_time         = printer->start_time;
-  printer->all_jobs           = cupsArrayNew3((cups_array_func_t)compare_all_jobs, NULL, NULL, 0, NULL, (cups_afree_func_t)_papplJobDelete);
+  printer->all_jobs           = cupsArrayNew3((cups_array_func_t)compare_all_jobs, NULL, NULL, 0, NULL, (cups_afree_func_t)_papplJobRelease);
   printer->active_jobs        = cupsArrayNew((cups_array_func_t)compare_active_jobs, NULL);
   printer->completed_jobs     = cupsArrayNew((cups_array_func_t)compare_completed_jobs, NULL);
+  printer->user_jobs          = cupsArrayNew((cups_array_func_t)compare_user_jobs, NULL);
   printer->next_job_id        = 1;
   printer->max_active_jobs    = (system->options & PAPPL_SOPTIONS_MULTI_QUEUE) ? 0 : 1;
   printer->max_completed_jobs = 100;
@@ -458,6 +582,24 @@ papplPrinterCreate(
   // natural-language-configured
   ippAddString(printer->attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_LANGUAGE), "natural-language-configured", NULL, "en");
 
+  // notify-events-default
+  ippAddString(printer->attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "notify-events-default", NULL, "job-completed");
+
+  // notify-events-supported
+  ippAddStrings(printer->attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "notify-events-supported", (int)(sizeof(notify_events) / sizeof(notify_events[0])), NULL, notify_events);
+
+  // notify-lease-duration-default
+  ippAddInteger(printer->attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "notify-lease-duration-default", _PAPPL_NOTIFY_LEASE);
+
+  // notify-lease-duration-supported
+  ippAddRange(printer->attrs, IPP_TAG_PRINTER, "notify-lease-duration-supported", 0, _PAPPL_NOTIFY_LEASE);
+
+  // notify-max-events-supported
+  ippAddInteger(printer->attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "notify-max-events-supported", _PAPPL_MAX_EVENTS);
+
+  // notify-pull-method-supported
+  ippAddString(printer->attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "notify-pull-method-supported", NULL, "ippget");
+
   // operations-supported
   ippAddIntegers(printer->attrs, IPP_TAG_PRINTER, IPP_TAG_ENUM, "operations-supported", (int)(sizeof(operations) / sizeof(operations[0])), operations);
 
@@ -563,39 +705,17 @@ papplPrinterCreate(
   // Add web pages, if any...
   if (system->options & PAPPL_SOPTIONS_WEB_INTERFACE)
   {
-    snprintf(path, sizeof(path), "%s/", printer->uriname);
-    papplSystemAddResourceCallback(system, path, "text/html", (pappl_resource_cb_t)_papplPrinterWebHome, printer);
-
-    snprintf(path, sizeof(path), "%s/cancel", printer->uriname);
-    papplSystemAddResourceCallback(system, path, "text/html", (pappl_resource_cb_t)_papplPrinterWebCancelJob, printer);
-
-    snprintf(path, sizeof(path), "%s/cancelall", printer->uriname);
-    papplSystemAddResourceCallback(system, path, "text/html", (pappl_resource_cb_t)_papplPrinterWebCancelAllJobs, printer);
-
-    if (system->options & PAPPL_SOPTIONS_MULTI_QUEUE)
-    {
-      snprintf(path, sizeof(path), "%s/delete", printer->uriname);
-      papplSystemAddResourceCallback(system, path, "text/html", (pappl_resource_cb_t)_papplPrinterWebDelete, printer);
-    }
-
-    snprintf(path, sizeof(path), "%s/config", printer->uriname);
-    papplSystemAddResourceCallback(system, path, "text/html", (pappl_resource_cb_t)_papplPrinterWebConfig, printer);
-
-    snprintf(path, sizeof(path), "%s/jobs", printer->uriname);
-    papplSystemAddResourceCallback(system, path, "text/html", (pappl_resource_cb_t)_papplPrinterWebJobs, printer);
-
+    // Printer web pages are routed by _papplSystemFindResource, so only add
+    // the navigation links here...
     snprintf(path, sizeof(path), "%s/media", printer->uriname);
-    papplSystemAddResourceCallback(system, path, "text/html", (pappl_resource_cb_t)_papplPrinterWebMedia, printer);
     papplPrinterAddLink(printer, "Media", path, PAPPL_LOPTIONS_NAVIGATION | PAPPL_LOPTIONS_STATUS);
 
     snprintf(path, sizeof(path), "%s/printing", printer->uriname);
-    papplSystemAddResourceCallback(system, path, "text/html", (pappl_resource_cb_t)_papplPrinterWebDefaults, printer);
     papplPrinterAddLink(printer, "Printing Defaults", path, PAPPL_LOPTIONS_NAVIGATION | PAPPL_LOPTIONS_STATUS);
 
     if (printer->driver_data.has_supplies)
     {
       snprintf(path, sizeof(path), "%s/supplies", printer->uriname);
-      papplSystemAddResourceCallback(system, path, "text/html", (pappl_resource_cb_t)_papplPrinterWebSupplies, printer);
       papplPrinterAddLink(printer, "Supplies", path, PAPPL_LOPTIONS_STATUS);
     }
   }
@@ -616,9 +736,10 @@ _papplPrinterDelete(
     pappl_printer_t *printer)		// I - Printer
 {
   int			i;		// Looping var
-  _pappl_resource_t	*r;		// Current resource
-  char			prefix[1024];	// Prefix for printer resources
-  size_t		prefixlen;	// Length of prefix
+  char			prefix[1024],	// Prefix for printer resources
+			filename[1024];	// Job history archive filename
+  bool			remove_archive = printer->is_deleted;
+					// Remove the job history archive?
 
 
   // Let USB/raw printing threads know to exit
@@ -643,16 +764,11 @@ _papplPrinterDelete(
   _papplPrinterUnregisterDNSSDNoLock(printer);
 
   // Remove printer-specific resources...
+  //
+  // Note: System rwlock is already held when calling cupsArrayRemove for the
+  // system's printer object, so we don't need a separate lock here...
   snprintf(prefix, sizeof(prefix), "%s/", printer->uriname);
-  prefixlen = strlen(prefix);
-
-  for (r = (_pappl_resource_t *)cupsArrayFirst(printer->system->resources); r; r = (_pappl_resource_t *)cupsArrayNext(printer->system->resources))
-  {
-    // Note: System rwlock is already held when calling cupsArrayRemove for the
-    // system's printer object, so we don't need a separate lock here...
-    if (r->cbdata == printer || !strncmp(r->path, prefix, prefixlen))
-      cupsArrayRemove(printer->system->resources, r);
-  }
+  _papplSystemRemoveResourcesNoLock(printer->system, prefix);
 
   // If applicable, call the delete function...
   if (printer->driver_data.delete_cb)
@@ -661,8 +777,21 @@ _papplPrinterDelete(
   // Delete jobs...
   cupsArrayDelete(printer->active_jobs);
   cupsArrayDelete(printer->completed_jobs);
+  cupsArrayDelete(printer->user_jobs);
   cupsArrayDelete(printer->all_jobs);
 
+  // Remove the job history archive when the printer is deleted, but not when
+  // the system is deleted...
+  pthread_mutex_lock(&printer->archive_mutex);
+
+  if (remove_archive && printer->system->directory)
+  {
+    unlink(_papplPrinterArchiveFilename(printer, filename, sizeof(filename), false));
+    unlink(_papplPrinterArchiveFilename(printer, filename, sizeof(filename), true));
+  }
+
+  pthread_mutex_unlock(&printer->archive_mutex);
+
   // Free memory...
   free(printer->name);
   free(printer->dns_sd_name);
@@ -678,6 +807,17 @@ _papplPrinterDelete(
 
   ippDelete(printer->driver_attrs);
   ippDelete(printer->attrs);
+  ippDelete(printer->cache_attrs);
+
+  pthread_rwlock_destroy(&printer->cache_rwlock);
+
+  for (i = 0; i < _PAPPL_MAX_BUFFERS; i ++)
+    free(printer->buffers[i].data);
+
+  pthread_mutex_destroy(&printer->buffers_mutex);
+  pthread_mutex_destroy(&printer->archive_mutex);
+
+  _papplPrinterDeleteSubscriptions(printer);
 
   cupsArrayDelete(printer->links);
 
@@ -699,6 +839,11 @@ papplPrinterDelete(
   pappl_system_t *system = printer->system;
 					// System
 
+
+  // Mark the printer as deleted so that the job history archive is removed
+  // when the printer is freed...
+  printer->is_deleted = true;
+
   // Remove the printer from the system object...
   pthread_rwlock_wrlock(&system->rwlock);
   cupsArrayRemove(system->printers, printer);
@@ -708,6 +853,40 @@ papplPrinterDelete(
 }
 
 
+//
+// '_papplPrinterFreeBuffer()' - Return a line or band buffer to the printer's pool.
+//
+
+void
+_papplPrinterFreeBuffer(
+    pappl_printer_t *printer,		// I - Printer
+    void            *data)		// I - Buffer from `_papplPrinterAllocBuffer`
+{
+  int			i;		// Looping var
+  _pappl_buffer_t	*buffer;	// Current buffer
+
+
+  if (!data)
+    return;
+
+  pthread_mutex_lock(&printer->buffers_mutex);
+
+  for (i = _PAPPL_MAX_BUFFERS, buffer = printer->buffers; i > 0; i --, buffer ++)
+  {
+    if (buffer->data == data)
+    {
+      buffer->in_use = false;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&printer->buffers_mutex);
+
+  if (i == 0)
+    free(data);				// Not a pooled buffer
+}
+
+
 //
 // 'compare_active_jobs()' - Compare two active jobs.
 //
@@ -742,3 +921,23 @@ compare_completed_jobs(pappl_job_t *a,	// I - First job
 {
   return (b->job_id - a->job_id);
 }
+
+
+//
+// 'compare_user_jobs()' - Compare two jobs by username.
+//
+// Jobs for the same user are sorted newest first, like the other job arrays.
+//
+
+static int				// O - Result of comparison
+compare_user_jobs(pappl_job_t *a,	// I - First job
+                  pappl_job_t *b)	// I - Second job
+{
+  int	result;				// Result of comparison
+
+
+  if ((result = strcasecmp(a->username ? a->username : "", b->username ? b->username : "")) == 0)
+    result = b->job_id - a->job_id;
+
+  return (result);
+}
@@ -135,6 +135,16 @@ enum pappl_media_tracking_e		// IPP "media-tracking" bit values
 typedef unsigned short pappl_media_tracking_t;
 					// Bitfield for IPP "media-tracking" values
 
+enum pappl_page_changes_e		// Raster page header change bit values
+{
+  PAPPL_PAGE_CHANGES_NONE = 0x0000,		// Same as the previous page
+  PAPPL_PAGE_CHANGES_SIZE = 0x0001,		// Page dimensions changed
+  PAPPL_PAGE_CHANGES_COLOR = 0x0002,		// Color space or bit depth changed
+  PAPPL_PAGE_CHANGES_RESOLUTION = 0x0004,	// Resolution changed
+  PAPPL_PAGE_CHANGES_OTHER = 0x0008		// Other raster header values changed
+};
+typedef unsigned pappl_page_changes_t;	// Bitfield for raster page header changes
+
 enum pappl_preason_e			// IPP "printer-state-reasons" bit values
 {
   PAPPL_PREASON_NONE = 0x0000,			// 'none'
@@ -280,6 +290,8 @@ typedef bool (*pappl_pr_rstartjob_cb_t)(pappl_job_t *job, pappl_pr_options_t *op
 					// Start a raster job callback
 typedef bool (*pappl_pr_rstartpage_cb_t)(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device, unsigned page);
 					// Start a raster page callback
+typedef bool (*pappl_pr_rwriteblank_cb_t)(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device, unsigned y, unsigned count);
+					// Write blank lines of raster graphics callback
 typedef bool (*pappl_pr_rwriteline_cb_t)(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device, unsigned y, const unsigned char *line);
 					// Write a line of raster graphics callback
 typedef bool (*pappl_pr_status_cb_t)(pappl_printer_t *printer);
@@ -338,6 +350,7 @@ struct pappl_pr_options_s		// Combined print job options
   pappl_sides_t		sides;			// "sides" value
   int			num_vendor;		// Number of vendor options
   cups_option_t		*vendor;		// Vendor options
+  pappl_page_changes_t	page_changes;		// Raster header changes from the previous page
 };
 
 typedef struct pappl_supply_s		// Supply data
@@ -506,6 +519,7 @@ extern bool		papplPrinterSetReadyMedia(pappl_printer_t *printer, int num_ready,
 extern void		papplPrinterSetReasons(pappl_printer_t *printer, pappl_preason_t add, pappl_preason_t remove) _PAPPL_PUBLIC;
 extern void		papplPrinterSetSupplies(pappl_printer_t *printer, int num_supplies, pappl_supply_t *supplies) _PAPPL_PUBLIC;
 extern void		papplPrinterSetUSB(pappl_printer_t *printer, unsigned vendor_id, unsigned product_id, pappl_uoptions_t options, const char *storagefile) _PAPPL_PUBLIC;
+extern void		papplPrinterSetWriteBlankCallback(pappl_printer_t *printer, pappl_pr_rwriteblank_cb_t cb) _PAPPL_PUBLIC;
 
 //
 // C++ magic...
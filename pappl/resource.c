@@ -21,9 +21,110 @@
 //
 
 static void		add_resource(pappl_system_t *system, _pappl_resource_t *r);
+static _pappl_resource_t *add_resource_array(cups_array_t **resources, _pappl_resource_t *r);
 static int		compare_resources(_pappl_resource_t *a, _pappl_resource_t *b);
 static _pappl_resource_t *copy_resource(_pappl_resource_t *r);
+static pappl_printer_t	*find_printer(pappl_system_t *system, const char *uriname, size_t urinamelen);
 static void		free_resource(_pappl_resource_t *r);
+static unsigned		hash_path(const char *path, size_t pathlen);
+
+
+//
+// '_papplResourceOpenFile()' - Open the file for a file resource.
+//
+// The file descriptor is cached with the resource and reopened when the file
+// is replaced or modified, in which case the resource's length and
+// modification time are also updated.  The returned file descriptor is a
+// duplicate that must be closed by the caller, so that the cached descriptor
+// can be replaced while other clients are still sending the old file.
+//
+
+int					// O - File descriptor or `-1` on error
+_papplResourceOpenFile(
+    _pappl_resource_t *r)		// I - Resource
+{
+  int		fd = -1;		// File descriptor
+  struct stat	fileinfo;		// File information
+
+
+  if (!r || !r->filename)
+    return (-1);
+
+  pthread_mutex_lock(&r->fd_mutex);
+
+  if (stat(r->filename, &fileinfo))
+  {
+    // File has been removed...
+    if (r->fd >= 0)
+    {
+      close(r->fd);
+      r->fd = -1;
+    }
+  }
+  else
+  {
+    if (r->fd >= 0 && (fileinfo.st_dev != r->fd_dev || fileinfo.st_ino != r->fd_ino || fileinfo.st_mtime != r->last_modified || (size_t)fileinfo.st_size != r->length))
+    {
+      // File has changed, reopen it...
+      close(r->fd);
+      r->fd = -1;
+    }
+
+    if (r->fd < 0 && (r->fd = open(r->filename, O_RDONLY | O_CLOEXEC)) >= 0 && !fstat(r->fd, &fileinfo))
+    {
+      r->fd_dev        = fileinfo.st_dev;
+      r->fd_ino        = fileinfo.st_ino;
+      r->last_modified = fileinfo.st_mtime;
+      r->length        = (size_t)fileinfo.st_size;
+    }
+
+    if (r->fd >= 0)
+      fd = fcntl(r->fd, F_DUPFD_CLOEXEC, 0);
+  }
+
+  pthread_mutex_unlock(&r->fd_mutex);
+
+  return (fd);
+}
+
+
+//
+// '_papplSystemAddPrinterResourceCallback()' - Add a dynamic resource for all
+//                                              printers.
+//
+// This function adds a resource pattern that is matched against the path
+// following each printer's URI name, for example "/" or "/jobs".  The callback
+// is called with the client pointer and matching printer.  Resources added
+// with @link papplSystemAddResourceCallback@ take precedence over these
+// patterns.
+//
+
+void
+_papplSystemAddPrinterResourceCallback(
+    pappl_system_t      *system,	// I - System object
+    const char          *subpath,	// I - Resource path relative to the printer
+    const char          *format,	// I - MIME media type for content such as "text/html"
+    pappl_resource_cb_t cb)		// I - Callback function
+{
+  _pappl_resource_t	r;		// New resource
+
+
+  if (!system || !subpath || subpath[0] != '/' || !format || !cb)
+    return;
+
+  memset(&r, 0, sizeof(r));
+
+  r.path   = (char *)subpath;
+  r.format = (char *)format;
+  r.cb     = cb;
+
+  pthread_rwlock_wrlock(&system->rwlock);
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Adding printer resource for '%s'.", subpath);
+  add_resource_array(&system->printer_resources, &r);
+
+  pthread_rwlock_unlock(&system->rwlock);
+}
 
 
 //
@@ -338,29 +439,77 @@ papplSystemAddStringsFile(
 //
 // '_papplSystemFindResource()' - Find a resource at a path.
 //
+// Resources are hashed without any trailing slash so that a request for
+// "/path" also finds a resource registered as "/path/" with a single lookup.
+// If no resource is registered at the path, the printer resource patterns are
+// checked using the printer whose URI name matches the start of the path.
+//
 
 _pappl_resource_t *			// O - Resource object
 _papplSystemFindResource(
     pappl_system_t *system,		// I - System object
-    const char     *path)		// I - Resource path
+    const char     *path,		// I - Resource path
+    void           **cbdata)		// O - Callback data
 {
-  _pappl_resource_t	key,		// Search key
-			*match;		// Matching resource, if any
-  char			altpath[1024];	// Alternate path
+  _pappl_resource_t	*r,		// Current resource
+			*match = NULL,	// Matching resource, if any
+			*altmatch = NULL;
+					// Matching "path/" resource, if any
+  size_t		pathlen;	// Length of path
 
 
-  if (!system || !system->resources || !path)
+  if (cbdata)
+    *cbdata = NULL;
+
+  if (!system || !path)
     return (NULL);
 
-  key.path = (char *)path;
+  pathlen = strlen(path);
 
   pthread_rwlock_rdlock(&system->rwlock);
 
-  if ((match = (_pappl_resource_t *)cupsArrayFind(system->resources, &key)) == NULL)
+  for (r = system->resource_hash[hash_path(path, pathlen)]; r; r = r->next)
   {
-    snprintf(altpath, sizeof(altpath), "%s/", path);
-    key.path = altpath;
-    match = (_pappl_resource_t *)cupsArrayFind(system->resources, &key);
+    if (!strcmp(r->path, path))
+    {
+      match = r;
+      break;
+    }
+    else if (!altmatch && !strncmp(r->path, path, pathlen) && r->path[pathlen] == '/' && !r->path[pathlen + 1])
+    {
+      altmatch = r;
+    }
+  }
+
+  if (!match)
+    match = altmatch;
+
+  if (match)
+  {
+    if (cbdata)
+      *cbdata = match->cbdata;
+  }
+  else if (system->printer_resources && path[0] == '/')
+  {
+    // Look for a printer resource, either "/uriname/subpath" or "/uriname"
+    // for the printer's home page...
+    _pappl_resource_t	key;		// Search key
+    pappl_printer_t	*printer = NULL;// Matching printer
+    const char		*subpath;	// Resource path relative to the printer
+
+    subpath  = strrchr(path, '/');
+    key.path = (char *)subpath;
+
+    if ((match = (_pappl_resource_t *)cupsArrayFind(system->printer_resources, &key)) == NULL || (printer = find_printer(system, path, (size_t)(subpath - path))) == NULL)
+    {
+      key.path = (char *)"/";
+
+      if ((match = (_pappl_resource_t *)cupsArrayFind(system->printer_resources, &key)) != NULL && (printer = find_printer(system, path, pathlen)) == NULL)
+        match = NULL;
+    }
+
+    if (match && cbdata)
+      *cbdata = printer;
   }
 
   pthread_rwlock_unlock(&system->rwlock);
@@ -394,13 +543,82 @@ papplSystemRemoveResource(
   if ((match = (_pappl_resource_t *)cupsArrayFind(system->resources, &key)) != NULL)
   {
     papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Removing resource for '%s'.", path);
-    cupsArrayRemove(system->resources, match);
+    _papplSystemRemoveResourceNoLock(system, match);
   }
 
   pthread_rwlock_unlock(&system->rwlock);
 }
 
 
+//
+// '_papplSystemRemoveResourceNoLock()' - Remove a resource object.
+//
+// The caller must hold the system's write lock.
+//
+
+void
+_papplSystemRemoveResourceNoLock(
+    pappl_system_t    *system,		// I - System object
+    _pappl_resource_t *r)		// I - Resource
+{
+  _pappl_resource_t	**rptr;		// Pointer into hash bucket
+
+
+  for (rptr = system->resource_hash + hash_path(r->path, strlen(r->path)); *rptr; rptr = &((*rptr)->next))
+  {
+    if (*rptr == r)
+    {
+      *rptr = r->next;
+      break;
+    }
+  }
+
+  cupsArrayRemove(system->resources, r);
+}
+
+
+//
+// '_papplSystemRemoveResourcesNoLock()' - Remove all resources under a path.
+//
+// Since the resources array is sorted by path, the matching resources are
+// found with a binary search.  The caller must hold the system's write lock.
+//
+
+void
+_papplSystemRemoveResourcesNoLock(
+    pappl_system_t *system,		// I - System object
+    const char     *prefix)		// I - Path prefix
+{
+  _pappl_resource_t	*r;		// Current resource
+  int			left,		// Left index
+			right,		// Right index
+			current;	// Current index
+  size_t		prefixlen;	// Length of prefix
+
+
+  prefixlen = strlen(prefix);
+
+  // Find the first resource at or after the prefix...
+  for (left = 0, right = cupsArrayCount(system->resources); left < right;)
+  {
+    current = (left + right) / 2;
+    r       = (_pappl_resource_t *)cupsArrayIndex(system->resources, current);
+
+    if (strcmp(r->path, prefix) < 0)
+      left = current + 1;
+    else
+      right = current;
+  }
+
+  // Then remove resources until the prefix no longer matches...
+  while ((r = (_pappl_resource_t *)cupsArrayIndex(system->resources, left)) != NULL && !strncmp(r->path, prefix, prefixlen))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Removing resource for '%s'.", r->path);
+    _papplSystemRemoveResourceNoLock(system, r);
+  }
+}
+
+
 //
 // 'add_resource()' - Add a resource object to a system object.
 //
@@ -415,16 +633,43 @@ add_resource(pappl_system_t    *system,	// I - System object
   {
     papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Adding resource for '%s'.", r->path);
 
-    if (!system->resources)
-      system->resources = cupsArrayNew3((cups_array_func_t)compare_resources, NULL, NULL, 0, (cups_acopy_func_t)copy_resource, (cups_afree_func_t)free_resource);
+    if ((r = add_resource_array(&system->resources, r)) != NULL)
+    {
+      // Add the copy of the resource to the hash table...
+      unsigned bucket = hash_path(r->path, strlen(r->path));
+					// Hash bucket
 
-    cupsArrayAdd(system->resources, r);
+      r->next                       = system->resource_hash[bucket];
+      system->resource_hash[bucket] = r;
+    }
   }
 
   pthread_rwlock_unlock(&system->rwlock);
 }
 
 
+//
+// 'add_resource_array()' - Add a copy of a resource to an array.
+//
+
+static _pappl_resource_t *		// O - Copy of resource or `NULL` on error
+add_resource_array(
+    cups_array_t      **resources,	// IO - Resources array
+    _pappl_resource_t *r)		// I  - Resource
+{
+  if (cupsArrayFind(*resources, r))
+    return (NULL);
+
+  if (!*resources)
+    *resources = cupsArrayNew3((cups_array_func_t)compare_resources, NULL, NULL, 0, (cups_acopy_func_t)copy_resource, (cups_afree_func_t)free_resource);
+
+  if (!cupsArrayAdd(*resources, r))
+    return (NULL);
+
+  return ((_pappl_resource_t *)cupsArrayFind(*resources, r));
+}
+
+
 //
 // 'compare_resources()' - Compare the path of two resources.
 //
@@ -456,6 +701,9 @@ copy_resource(_pappl_resource_t *r)	// I - Resource to copy
     newr->length        = r->length;
     newr->cb            = r->cb;
     newr->cbdata        = r->cbdata;
+    newr->fd            = -1;
+
+    pthread_mutex_init(&newr->fd_mutex, NULL);
 
     if (r->filename)
       newr->filename = strdup(r->filename);
@@ -473,6 +721,37 @@ copy_resource(_pappl_resource_t *r)	// I - Resource to copy
 }
 
 
+//
+// 'find_printer()' - Find a printer by its URI name.
+//
+// The caller must hold the system's read or write lock.
+//
+
+static pappl_printer_t *		// O - Printer or `NULL` if none
+find_printer(
+    pappl_system_t *system,		// I - System object
+    const char     *uriname,		// I - URI name
+    size_t         urinamelen)		// I - Length of URI name
+{
+  int			i,		// Looping var
+			count;		// Number of printers
+  pappl_printer_t	*printer;	// Current printer
+
+
+  // Note: Cannot use cupsArrayFirst/Next since other threads might be
+  // enumerating the printers array.
+  for (i = 0, count = cupsArrayCount(system->printers); i < count; i ++)
+  {
+    printer = (pappl_printer_t *)cupsArrayIndex(system->printers, i);
+
+    if (!strncmp(printer->uriname, uriname, urinamelen) && !printer->uriname[urinamelen])
+      return (printer);
+  }
+
+  return (NULL);
+}
+
+
 //
 // 'free_resource()' - Free the memory used for a resource.
 //
@@ -485,5 +764,37 @@ free_resource(_pappl_resource_t *r)	// I - Resource
   free(r->filename);
   free(r->language);
 
+  if (r->fd >= 0)
+    close(r->fd);
+
+  pthread_mutex_destroy(&r->fd_mutex);
+
   free(r);
 }
+
+
+//
+// 'hash_path()' - Compute the hash bucket for a resource path.
+//
+// This uses the FNV-1a hash of the path, ignoring any trailing slash.
+//
+
+static unsigned				// O - Hash bucket
+hash_path(const char *path,		// I - Path
+          size_t     pathlen)		// I - Length of path
+{
+  unsigned	hash = 2166136261U;	// Hash value
+
+
+  if (pathlen > 0 && path[pathlen - 1] == '/')
+    pathlen --;
+
+  while (pathlen > 0)
+  {
+    hash ^= (unsigned char)*path++;
+    hash *= 16777619U;
+    pathlen --;
+  }
+
+  return (hash % _PAPPL_RESOURCE_HASH);
+}
@@ -0,0 +1,639 @@
+//
+// Subscription IPP processing for the Printer Application Framework
+//
+// Copyright © 2021 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Local functions...
+//
+
+static int		compare_subscriptions(_pappl_subscription_t *a, _pappl_subscription_t *b);
+static void		copy_event(pappl_client_t *client, _pappl_subscription_t *sub, _pappl_event_rec_t *rec, int seq);
+static void		free_subscription(_pappl_subscription_t *sub);
+static int		get_events(pappl_printer_t *printer, _pappl_subscription_t *sub, int seq, _pappl_event_rec_t **recs, int *first_seq);
+static const char	*get_username(pappl_client_t *client);
+
+static void		ipp_cancel_subscription(pappl_client_t *client);
+static void		ipp_create_subscriptions(pappl_client_t *client);
+static void		ipp_get_notifications(pappl_client_t *client);
+
+
+//
+// '_papplSubscriptionProcessIPP()' - Process an IPP subscription request.
+//
+
+void
+_papplSubscriptionProcessIPP(
+    pappl_client_t *client)		// I - Client
+{
+  switch (ippGetOperation(client->request))
+  {
+    case IPP_OP_CREATE_PRINTER_SUBSCRIPTIONS :
+    case IPP_OP_CREATE_JOB_SUBSCRIPTIONS :
+	ipp_create_subscriptions(client);
+	break;
+
+    case IPP_OP_CANCEL_SUBSCRIPTION :
+	ipp_cancel_subscription(client);
+	break;
+
+    case IPP_OP_GET_NOTIFICATIONS :
+	ipp_get_notifications(client);
+	break;
+
+    default :
+	papplClientRespondIPP(client, IPP_STATUS_ERROR_OPERATION_NOT_SUPPORTED, "Operation not supported.");
+	break;
+  }
+}
+
+
+//
+// 'compare_subscriptions()' - Compare two subscriptions.
+//
+
+static int				// O - Result of comparison
+compare_subscriptions(
+    _pappl_subscription_t *a,		// I - First subscription
+    _pappl_subscription_t *b)		// I - Second subscription
+{
+  return (a->subscription_id - b->subscription_id);
+}
+
+
+//
+// 'copy_event()' - Copy an event to the response.
+//
+
+static void
+copy_event(
+    pappl_client_t        *client,	// I - Client
+    _pappl_subscription_t *sub,		// I - Subscription
+    _pappl_event_rec_t    *rec,		// I - Event record
+    int                   seq)		// I - "notify-sequence-number" value
+{
+  pappl_printer_t	*printer = client->printer;
+					// Printer
+  _pappl_event_t	bit,		// Current event bit
+			events = rec->events & sub->events;
+					// Subscribed events
+  int			num_values;	// Number of values
+  const char		*svalues[32];	// String values
+  char			uri[1024],	// "notify-printer-uri" value
+			text[256];	// "notify-text" value
+
+
+  for (bit = _PAPPL_EVENT_JOB_COMPLETED; bit <= _PAPPL_EVENT_PRINTER_STATE_CHANGED; bit *= 2)
+  {
+    if (events & bit)
+      break;
+  }
+
+  if (rec->job_id)
+    snprintf(text, sizeof(text), "Job #%d %s.", rec->job_id, ippEnumString("job-state", (int)rec->job_state));
+  else
+    snprintf(text, sizeof(text), "Printer %s.", ippEnumString("printer-state", (int)rec->printer_state));
+
+  httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipps", NULL, printer->system->hostname, printer->system->port, printer->resource);
+
+  ippAddSeparator(client->response);
+
+  ippAddString(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_CHARSET), "notify-charset", NULL, "utf-8");
+  ippAddString(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_LANGUAGE), "notify-natural-language", NULL, "en");
+  ippAddString(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_URI, "notify-printer-uri", NULL, uri);
+  ippAddInteger(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "notify-sequence-number", seq);
+  ippAddInteger(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "notify-subscription-id", sub->subscription_id);
+  ippAddString(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "notify-subscribed-event", NULL, _papplSubscriptionEventString(bit));
+  ippAddString(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_TEXT, "notify-text", NULL, text);
+  if (sub->user_data_len > 0)
+    ippAddOctetString(client->response, IPP_TAG_EVENT_NOTIFICATION, "notify-user-data", sub->user_data, sub->user_data_len);
+  ippAddInteger(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "printer-up-time", (int)(rec->time - printer->start_time));
+
+  if (rec->job_id)
+  {
+    pappl_jreason_t	jbit;		// Current job reason bit
+
+    ippAddInteger(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "notify-job-id", rec->job_id);
+    ippAddInteger(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "job-impressions-completed", rec->job_impcompleted);
+    ippAddInteger(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_ENUM, "job-state", (int)rec->job_state);
+
+    for (num_values = 0, jbit = PAPPL_JREASON_ABORTED_BY_SYSTEM; jbit <= PAPPL_JREASON_WARNINGS_DETECTED && num_values < (int)(sizeof(svalues) / sizeof(svalues[0])); jbit *= 2)
+    {
+      if (jbit & rec->job_reasons)
+	svalues[num_values ++] = _papplJobReasonString(jbit);
+    }
+
+    if (num_values > 0)
+      ippAddStrings(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "job-state-reasons", num_values, NULL, svalues);
+    else
+      ippAddString(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "job-state-reasons", NULL, "none");
+  }
+
+  if (!rec->job_id || (events & _PAPPL_EVENT_PRINTER_STATE_CHANGED))
+  {
+    pappl_preason_t	pbit;		// Current printer reason bit
+
+    ippAddBoolean(client->response, IPP_TAG_EVENT_NOTIFICATION, "printer-is-accepting-jobs", !printer->system->shutdown_time);
+    ippAddInteger(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_ENUM, "printer-state", (int)rec->printer_state);
+
+    for (num_values = 0, pbit = PAPPL_PREASON_OTHER; pbit <= PAPPL_PREASON_TONER_LOW && num_values < (int)(sizeof(svalues) / sizeof(svalues[0])); pbit *= 2)
+    {
+      if (pbit & rec->printer_reasons)
+	svalues[num_values ++] = _papplPrinterReasonString(pbit);
+    }
+
+    if (num_values > 0)
+      ippAddStrings(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", num_values, NULL, svalues);
+    else
+      ippAddString(client->response, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "none");
+  }
+}
+
+
+//
+// 'free_subscription()' - Free a subscription.
+//
+
+static void
+free_subscription(
+    _pappl_subscription_t *sub)		// I - Subscription
+{
+  free(sub->username);
+  free(sub);
+}
+
+
+//
+// 'get_events()' - Get the events to report for a subscription.
+//
+// The events for the subscription that are still in the printer's event ring
+// are returned in order.  The last one has the subscription's last sequence
+// number, and "first_seq" is set to the sequence number of the first one.
+// The caller must hold the printer's event mutex.
+//
+
+static int				// O - Number of events
+get_events(
+    pappl_printer_t       *printer,	// I - Printer
+    _pappl_subscription_t *sub,		// I - Subscription
+    int                   seq,		// I - Requested sequence number or `0` for all
+    _pappl_event_rec_t    **recs,	// I - Events array (`_PAPPL_MAX_EVENTS` elements)
+    int                   *first_seq)	// O - Sequence number of first event
+{
+  int			num_recs = 0,	// Number of events
+			skip;		// Events to skip
+  int			num;		// Current printer event number
+  _pappl_event_rec_t	*rec;		// Current event
+
+
+  if ((num = sub->first_event) <= printer->event_seq - _PAPPL_MAX_EVENTS)
+    num = printer->event_seq - _PAPPL_MAX_EVENTS + 1;
+
+  for (; num <= printer->event_seq; num ++)
+  {
+    rec = printer->events + (num % _PAPPL_MAX_EVENTS);
+
+    if (_PAPPL_SUBSCRIPTION_MATCHES(sub, rec))
+      recs[num_recs ++] = rec;
+  }
+
+  *first_seq = sub->last_seq - num_recs + 1;
+
+  if ((skip = seq - *first_seq) > 0)
+  {
+    // Skip events the client has already seen...
+    if (skip > num_recs)
+      skip = num_recs;
+
+    num_recs   -= skip;
+    *first_seq += skip;
+
+    memmove(recs, recs + skip, (size_t)num_recs * sizeof(_pappl_event_rec_t *));
+  }
+
+  return (num_recs);
+}
+
+
+//
+// 'get_username()' - Get the requesting user name.
+//
+
+static const char *			// O - Username
+get_username(pappl_client_t *client)	// I - Client
+{
+  ipp_attribute_t	*attr;		// "requesting-user-name" attribute
+
+
+  if (client->username[0])
+    return (client->username);
+  else if ((attr = ippFindAttribute(client->request, "requesting-user-name", IPP_TAG_NAME)) != NULL)
+    return (ippGetString(attr, 0, NULL));
+  else
+    return ("anonymous");
+}
+
+
+//
+// 'ipp_cancel_subscription()' - Cancel a subscription.
+//
+
+static void
+ipp_cancel_subscription(
+    pappl_client_t *client)		// I - Client
+{
+  pappl_printer_t	*printer = client->printer;
+					// Printer
+  _pappl_subscription_t	key,		// Search key
+			*sub;		// Subscription
+  bool			is_owner;	// Is the client the owner?
+  http_status_t		auth_status;	// Authorization status
+
+
+  if ((key.subscription_id = ippGetInteger(ippFindAttribute(client->request, "notify-subscription-id", IPP_TAG_INTEGER), 0)) <= 0)
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_BAD_REQUEST, "Missing \"notify-subscription-id\" attribute.");
+    return;
+  }
+
+  pthread_mutex_lock(&printer->event_mutex);
+  if ((sub = (_pappl_subscription_t *)cupsArrayFind(printer->subscriptions, &key)) != NULL)
+    is_owner = !strcmp(sub->username, get_username(client));
+  else
+    is_owner = false;
+  pthread_mutex_unlock(&printer->event_mutex);
+
+  if (!sub)
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_NOT_FOUND, "Subscription #%d does not exist.", key.subscription_id);
+    return;
+  }
+
+  // Only the owner or an administrator can cancel a subscription...
+  if (!is_owner && (auth_status = papplClientIsAuthorized(client)) != HTTP_STATUS_CONTINUE)
+  {
+    papplClientRespond(client, auth_status, NULL, NULL, 0, 0);
+    return;
+  }
+
+  pthread_mutex_lock(&printer->event_mutex);
+  if ((sub = (_pappl_subscription_t *)cupsArrayFind(printer->subscriptions, &key)) != NULL)
+    cupsArrayRemove(printer->subscriptions, sub);
+  pthread_mutex_unlock(&printer->event_mutex);
+
+  papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
+}
+
+
+//
+// 'ipp_create_subscriptions()' - Create printer or job subscriptions.
+//
+
+static void
+ipp_create_subscriptions(
+    pappl_client_t *client)		// I - Client
+{
+  pappl_printer_t	*printer = client->printer;
+					// Printer
+  bool			is_job = ippGetOperation(client->request) == IPP_OP_CREATE_JOB_SUBSCRIPTIONS;
+					// Create-Job-Subscriptions?
+  ipp_attribute_t	*attr;		// Current attribute
+  const char		*name,		// Attribute name
+			*username = get_username(client);
+					// Owner
+  int			i,		// Looping var
+			num_subs = 0,	// Number of subscription groups
+			ok_subs = 0;	// Number of created subscriptions
+  time_t		curtime = time(NULL);
+					// Current time
+
+
+  // Skip to the first subscription group...
+  for (attr = ippFirstAttribute(client->request); attr && ippGetGroupTag(attr) != IPP_TAG_SUBSCRIPTION; attr = ippNextAttribute(client->request));
+
+  if (!attr)
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_BAD_REQUEST, "No subscription attributes in request.");
+    return;
+  }
+
+  papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
+
+  while (attr)
+  {
+    ipp_status_t	status = IPP_STATUS_OK;
+					// Status for this subscription
+    bool		have_method = false;
+					// Have "notify-pull-method"?
+    _pappl_event_t	events = _PAPPL_EVENT_NONE;
+					// "notify-events" values
+    int			job_id = 0,	// "notify-job-id" value
+			sub_id = 0,	// "notify-subscription-id" value
+			lease = _PAPPL_NOTIFY_LEASE,
+					// "notify-lease-duration" value
+			user_data_len = 0;
+					// Length of "notify-user-data" value
+    const void		*user_data = NULL;
+					// "notify-user-data" value
+    _pappl_subscription_t *sub;		// New subscription
+
+    // Collect the attributes in this group...
+    for (; attr && ippGetGroupTag(attr) == IPP_TAG_SUBSCRIPTION && (name = ippGetName(attr)) != NULL; attr = ippNextAttribute(client->request))
+    {
+      if (!strcmp(name, "notify-recipient-uri"))
+      {
+        // Only "ippget" (pull) delivery is supported...
+        status = IPP_STATUS_ERROR_URI_SCHEME;
+      }
+      else if (!strcmp(name, "notify-pull-method"))
+      {
+        if (ippGetValueTag(attr) != IPP_TAG_KEYWORD || ippGetCount(attr) != 1 || strcmp(ippGetString(attr, 0, NULL), "ippget"))
+          status = IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES;
+	else
+	  have_method = true;
+      }
+      else if (!strcmp(name, "notify-events"))
+      {
+        if (ippGetValueTag(attr) != IPP_TAG_KEYWORD)
+        {
+          status = IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES;
+	  continue;
+	}
+
+        for (i = 0; i < ippGetCount(attr); i ++)
+          events |= _papplSubscriptionEventValue(ippGetString(attr, i, NULL));
+
+        if (!events)
+          status = IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES;
+      }
+      else if (!strcmp(name, "notify-job-id"))
+      {
+        if (ippGetValueTag(attr) != IPP_TAG_INTEGER || ippGetCount(attr) != 1 || (job_id = ippGetInteger(attr, 0)) <= 0)
+          status = IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES;
+      }
+      else if (!strcmp(name, "notify-lease-duration"))
+      {
+        if (ippGetValueTag(attr) != IPP_TAG_INTEGER || ippGetCount(attr) != 1 || (lease = ippGetInteger(attr, 0)) < 0)
+          status = IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES;
+	else if (lease == 0 || lease > _PAPPL_NOTIFY_LEASE)
+	  lease = _PAPPL_NOTIFY_LEASE;
+      }
+      else if (!strcmp(name, "notify-user-data"))
+      {
+        if (ippGetValueTag(attr) != IPP_TAG_STRING || ippGetCount(attr) != 1 || (user_data = ippGetOctetString(attr, 0, &user_data_len)) == NULL || user_data_len > 63)
+          status = IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES;
+      }
+    }
+
+    // Validate the subscription...
+    if (status == IPP_STATUS_OK && !have_method)
+      status = IPP_STATUS_ERROR_BAD_REQUEST;
+
+    if (status == IPP_STATUS_OK && is_job)
+    {
+      pappl_job_t *job;			// Job
+
+      if (!job_id)
+        status = IPP_STATUS_ERROR_BAD_REQUEST;
+      else if ((job = papplPrinterFindJob(printer, job_id)) == NULL)
+        status = IPP_STATUS_ERROR_NOT_FOUND;
+      else if (papplJobGetState(job) >= IPP_JSTATE_CANCELED)
+        status = IPP_STATUS_ERROR_NOT_POSSIBLE;
+    }
+    else if (!is_job)
+      job_id = 0;
+
+    if (!events)
+      events = is_job ? _PAPPL_EVENT_JOB_COMPLETED : _PAPPL_EVENT_PRINTER_STATE_CHANGED;
+
+    // Create the subscription...
+    sub = NULL;
+
+    if (status == IPP_STATUS_OK)
+    {
+      pthread_mutex_lock(&printer->event_mutex);
+
+      _papplPrinterExpireSubscriptions(printer, curtime);
+
+      if (!printer->subscriptions)
+        printer->subscriptions = cupsArrayNew3((cups_array_func_t)compare_subscriptions, NULL, NULL, 0, NULL, (cups_afree_func_t)free_subscription);
+      if (!printer->events)
+        printer->events = calloc(_PAPPL_MAX_EVENTS, sizeof(_pappl_event_rec_t));
+
+      if (!printer->subscriptions || !printer->events)
+      {
+        status = IPP_STATUS_ERROR_INTERNAL;
+      }
+      else if (cupsArrayCount(printer->subscriptions) >= _PAPPL_MAX_SUBSCRIPTIONS)
+      {
+        status = IPP_STATUS_ERROR_TOO_MANY_SUBSCRIPTIONS;
+      }
+      else if ((sub = calloc(1, sizeof(_pappl_subscription_t))) == NULL || (sub->username = strdup(username)) == NULL)
+      {
+        free(sub);
+        sub    = NULL;
+        status = IPP_STATUS_ERROR_INTERNAL;
+      }
+      else
+      {
+        sub->subscription_id = sub_id = ++ printer->last_subscription_id;
+        sub->events          = events;
+        sub->job_id          = job_id;
+        sub->lease           = job_id ? 0 : lease;
+        sub->expire          = job_id ? 0 : curtime + lease;
+        sub->first_event     = printer->event_seq + 1;
+
+        if (user_data_len > 0)
+        {
+          memcpy(sub->user_data, user_data, (size_t)user_data_len);
+          sub->user_data_len = user_data_len;
+	}
+
+        cupsArrayAdd(printer->subscriptions, sub);
+
+        papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Created subscription #%d for '%s'.", sub->subscription_id, username);
+      }
+
+      pthread_mutex_unlock(&printer->event_mutex);
+    }
+
+    // Report the result for this group...
+    if (num_subs > 0)
+      ippAddSeparator(client->response);
+
+    num_subs ++;
+
+    if (status == IPP_STATUS_OK)
+    {
+      ok_subs ++;
+
+      if (!job_id)
+        ippAddInteger(client->response, IPP_TAG_SUBSCRIPTION, IPP_TAG_INTEGER, "notify-lease-duration", lease);
+      ippAddInteger(client->response, IPP_TAG_SUBSCRIPTION, IPP_TAG_INTEGER, "notify-subscription-id", sub_id);
+    }
+    else
+    {
+      ippAddInteger(client->response, IPP_TAG_SUBSCRIPTION, IPP_TAG_ENUM, "notify-status-code", (int)status);
+    }
+
+    // Skip to the next subscription group...
+    while (attr && ippGetGroupTag(attr) != IPP_TAG_SUBSCRIPTION)
+      attr = ippNextAttribute(client->request);
+  }
+
+  if (ok_subs == 0)
+    ippSetStatusCode(client->response, IPP_STATUS_ERROR_IGNORED_ALL_SUBSCRIPTIONS);
+  else if (ok_subs < num_subs)
+    ippSetStatusCode(client->response, IPP_STATUS_OK_IGNORED_SUBSCRIPTIONS);
+}
+
+
+//
+// 'ipp_get_notifications()' - Get event notifications.
+//
+// When "notify-wait" is true and no events are available, the request is held
+// until an event arrives or `_PAPPL_NOTIFY_WAIT` seconds have elapsed.
+//
+
+static void
+ipp_get_notifications(
+    pappl_client_t *client)		// I - Client
+{
+  pappl_printer_t	*printer = client->printer;
+					// Printer
+  ipp_attribute_t	*sub_ids,	// "notify-subscription-ids" attribute
+			*sub_seqs;	// "notify-sequence-numbers" attribute
+  bool			notify_wait;	// "notify-wait" value
+  const char		*username = get_username(client);
+					// Requesting user
+  bool			is_authorized = false;
+					// Is the client an administrator?
+  int			i, j,		// Looping vars
+			count,		// Number of subscriptions
+			seq,		// Current sequence number
+			num_events,	// Number of pending events
+			num_recs;	// Number of events for subscription
+  ipp_status_t		status;		// Request status
+  _pappl_subscription_t	key,		// Search key
+			*sub;		// Current subscription
+  _pappl_event_rec_t	*recs[_PAPPL_MAX_EVENTS];
+					// Events for subscription
+  struct timespec	timeout;	// Timeout for "notify-wait"
+  http_status_t		auth_status;	// Authorization status
+
+
+  if ((sub_ids = ippFindAttribute(client->request, "notify-subscription-ids", IPP_TAG_INTEGER)) == NULL)
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_BAD_REQUEST, "Missing \"notify-subscription-ids\" attribute.");
+    return;
+  }
+
+  count       = ippGetCount(sub_ids);
+  sub_seqs    = ippFindAttribute(client->request, "notify-sequence-numbers", IPP_TAG_INTEGER);
+  notify_wait = ippGetBoolean(ippFindAttribute(client->request, "notify-wait", IPP_TAG_BOOLEAN), 0);
+
+  timeout.tv_sec  = time(NULL) + _PAPPL_NOTIFY_WAIT;
+  timeout.tv_nsec = 0;
+
+  pthread_mutex_lock(&printer->event_mutex);
+
+  for (;;)
+  {
+    // Validate the subscriptions and count the pending events...
+    _papplPrinterExpireSubscriptions(printer, time(NULL));
+
+    for (i = 0, num_events = 0, status = IPP_STATUS_OK; i < count; i ++)
+    {
+      key.subscription_id = ippGetInteger(sub_ids, i);
+
+      if ((sub = (_pappl_subscription_t *)cupsArrayFind(printer->subscriptions, &key)) == NULL)
+      {
+        status = IPP_STATUS_ERROR_NOT_FOUND;
+        break;
+      }
+      else if (!is_authorized && strcmp(sub->username, username))
+      {
+        status = IPP_STATUS_ERROR_NOT_AUTHORIZED;
+        break;
+      }
+
+      num_events += get_events(printer, sub, ippGetInteger(sub_seqs, i), recs, &seq);
+    }
+
+    if (status == IPP_STATUS_ERROR_NOT_AUTHORIZED)
+    {
+      // Only the owner or an administrator can get notifications...
+      pthread_mutex_unlock(&printer->event_mutex);
+
+      if ((auth_status = papplClientIsAuthorized(client)) != HTTP_STATUS_CONTINUE)
+      {
+	papplClientRespond(client, auth_status, NULL, NULL, 0, 0);
+	return;
+      }
+
+      is_authorized = true;
+
+      pthread_mutex_lock(&printer->event_mutex);
+      continue;
+    }
+
+    if (status != IPP_STATUS_OK || num_events > 0 || !notify_wait || printer->is_deleted)
+      break;
+
+    // Wait for new events...
+    printer->event_waiters ++;
+
+    if (pthread_cond_timedwait(&printer->event_cond, &printer->event_mutex, &timeout))
+      notify_wait = false;
+
+    printer->event_waiters --;
+
+    if (!printer->events || printer->is_deleted)
+    {
+      // Printer is being deleted, let the deleting thread know we are done
+      // with it and return now...
+      pthread_cond_broadcast(&printer->event_cond);
+      pthread_mutex_unlock(&printer->event_mutex);
+
+      papplClientRespondIPP(client, IPP_STATUS_ERROR_NOT_FOUND, "Printer has been deleted.");
+      return;
+    }
+  }
+
+  if (status != IPP_STATUS_OK)
+  {
+    pthread_mutex_unlock(&printer->event_mutex);
+    papplClientRespondIPP(client, status, "Subscription #%d does not exist.", key.subscription_id);
+    return;
+  }
+
+  // Return the events...
+  papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
+
+  ippAddInteger(client->response, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-get-interval", _PAPPL_NOTIFY_INTERVAL);
+  ippAddInteger(client->response, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "printer-up-time", (int)(time(NULL) - printer->start_time));
+
+  for (i = 0; i < count; i ++)
+  {
+    key.subscription_id = ippGetInteger(sub_ids, i);
+
+    if ((sub = (_pappl_subscription_t *)cupsArrayFind(printer->subscriptions, &key)) == NULL)
+      continue;
+
+    for (j = 0, num_recs = get_events(printer, sub, ippGetInteger(sub_seqs, i), recs, &seq); j < num_recs; j ++, seq ++)
+      copy_event(client, sub, recs[j], seq);
+  }
+
+  pthread_mutex_unlock(&printer->event_mutex);
+}
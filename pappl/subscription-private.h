@@ -0,0 +1,95 @@
+//
+// Private subscription header file for the Printer Application Framework
+//
+// Copyright © 2021 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+#ifndef _PAPPL_SUBSCRIPTION_PRIVATE_H_
+#  define _PAPPL_SUBSCRIPTION_PRIVATE_H_
+
+//
+// Include necessary headers...
+//
+
+#  include "base-private.h"
+#  include "job.h"
+
+
+//
+// Constants...
+//
+
+#  define _PAPPL_MAX_EVENTS	256	// Size of the per-printer event ring
+#  define _PAPPL_MAX_SUBSCRIPTIONS 100	// Maximum number of subscriptions per printer
+#  define _PAPPL_NOTIFY_INTERVAL 30	// "notify-get-interval" value in seconds
+#  define _PAPPL_NOTIFY_LEASE	86400	// Default/maximum "notify-lease-duration" value
+#  define _PAPPL_NOTIFY_WAIT	30	// Maximum time to hold a "notify-wait" request
+
+
+//
+// Macros...
+//
+
+#  define _PAPPL_SUBSCRIPTION_MATCHES(sub,rec) (((rec)->events & (sub)->events) && (!(sub)->job_id || (sub)->job_id == (rec)->job_id))
+
+
+//
+// Types and structures...
+//
+
+enum _pappl_event_e			// IPP "notify-events" bit values
+{
+  _PAPPL_EVENT_NONE = 0x0000,		// No events
+  _PAPPL_EVENT_JOB_COMPLETED = 0x0001,	// 'job-completed'
+  _PAPPL_EVENT_JOB_CREATED = 0x0002,	// 'job-created'
+  _PAPPL_EVENT_JOB_STATE_CHANGED = 0x0004,
+					// 'job-state-changed'
+  _PAPPL_EVENT_PRINTER_STATE_CHANGED = 0x0008
+					// 'printer-state-changed'
+};
+typedef unsigned _pappl_event_t;	// Bitfield for IPP "notify-events" values
+
+typedef struct _pappl_event_rec_s	// Event record in a printer's event ring
+{
+  _pappl_event_t	events;			// Event(s) that occurred
+  time_t		time;			// Time of event
+  ipp_pstate_t		printer_state;		// "printer-state" value
+  pappl_preason_t	printer_reasons;	// "printer-state-reasons" values
+  int			job_id;			// "job-id" value or 0 for printer events
+  ipp_jstate_t		job_state;		// "job-state" value
+  pappl_jreason_t	job_reasons;		// "job-state-reasons" values
+  int			job_impcompleted;	// "job-impressions-completed" value
+} _pappl_event_rec_t;
+
+typedef struct _pappl_subscription_s	// Subscription data
+{
+  int			subscription_id;	// "notify-subscription-id" value
+  _pappl_event_t	events;			// "notify-events" values
+  int			job_id;			// "notify-job-id" value or 0 for printer subscriptions
+  char			*username;		// "notify-subscriber-user-name" value
+  int			lease;			// "notify-lease-duration" value
+  time_t		expire;			// Expiration time or 0 for none
+  int			first_event;		// First printer event number for this subscription
+  int			last_seq;		// Last "notify-sequence-number" value
+  unsigned char		user_data[63];		// "notify-user-data" value
+  int			user_data_len;		// Length of "notify-user-data" value
+} _pappl_subscription_t;
+
+
+//
+// Functions...
+//
+
+extern void		_papplPrinterAddEvent(pappl_printer_t *printer, pappl_job_t *job, _pappl_event_t events) _PAPPL_PRIVATE;
+extern void		_papplPrinterDeleteSubscriptions(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplPrinterExpireSubscriptions(pappl_printer_t *printer, time_t curtime) _PAPPL_PRIVATE;
+
+extern const char	*_papplSubscriptionEventString(_pappl_event_t value) _PAPPL_PRIVATE;
+extern _pappl_event_t	_papplSubscriptionEventValue(const char *value) _PAPPL_PRIVATE;
+extern void		_papplSubscriptionProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
+
+
+#endif // !_PAPPL_SUBSCRIPTION_PRIVATE_H_
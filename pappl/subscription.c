@@ -0,0 +1,177 @@
+//
+// Subscription and event functions for the Printer Application Framework
+//
+// Copyright © 2021 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Local globals...
+//
+
+static const char * const pappl_events[] =
+{
+  "job-completed",
+  "job-created",
+  "job-state-changed",
+  "printer-state-changed"
+};
+
+
+//
+// '_papplPrinterAddEvent()' - Add an event to a printer's event ring.
+//
+// Events are only recorded while the printer has subscriptions.  The printer
+// and job state are sampled without locking so that this function can be
+// called while holding the job and/or printer locks.
+//
+// Each subscription numbers the events it receives, starting at 1, so the
+// "notify-sequence-number" values seen by a subscriber have no gaps.
+//
+
+void
+_papplPrinterAddEvent(
+    pappl_printer_t *printer,		// I - Printer
+    pappl_job_t     *job,		// I - Job or `NULL` for printer events
+    _pappl_event_t  events)		// I - Event(s)
+{
+  _pappl_event_rec_t	*rec;		// Event record
+  _pappl_subscription_t	*sub;		// Current subscription
+  time_t		curtime;	// Current time
+
+
+  if (!printer || !printer->subscriptions)
+    return;
+
+  pthread_mutex_lock(&printer->event_mutex);
+
+  curtime = time(NULL);
+
+  _papplPrinterExpireSubscriptions(printer, curtime);
+
+  if (printer->events && cupsArrayCount(printer->subscriptions) > 0)
+  {
+    // Record the event...
+    printer->event_seq ++;
+
+    rec = printer->events + (printer->event_seq % _PAPPL_MAX_EVENTS);
+
+    memset(rec, 0, sizeof(_pappl_event_rec_t));
+
+    rec->events          = events;
+    rec->time            = curtime;
+    rec->printer_state   = printer->state;
+    rec->printer_reasons = printer->state_reasons;
+
+    if (job)
+    {
+      rec->job_id           = job->job_id;
+      rec->job_state        = job->state;
+      rec->job_reasons      = job->state_reasons;
+      rec->job_impcompleted = job->impcompleted;
+    }
+
+    for (sub = (_pappl_subscription_t *)cupsArrayFirst(printer->subscriptions); sub; sub = (_pappl_subscription_t *)cupsArrayNext(printer->subscriptions))
+    {
+      if (_PAPPL_SUBSCRIPTION_MATCHES(sub, rec))
+        sub->last_seq ++;
+
+      // Job subscriptions end once the job is done, but keep them around
+      // long enough for clients to collect the final events...
+      if (job && sub->job_id == job->job_id && (events & _PAPPL_EVENT_JOB_COMPLETED))
+        sub->expire = curtime + 2 * _PAPPL_NOTIFY_INTERVAL;
+    }
+
+    pthread_cond_broadcast(&printer->event_cond);
+  }
+
+  pthread_mutex_unlock(&printer->event_mutex);
+}
+
+
+//
+// '_papplPrinterDeleteSubscriptions()' - Free the subscriptions and events for a printer.
+//
+
+void
+_papplPrinterDeleteSubscriptions(
+    pappl_printer_t *printer)		// I - Printer
+{
+  pthread_mutex_lock(&printer->event_mutex);
+
+  cupsArrayDelete(printer->subscriptions);
+  printer->subscriptions = NULL;
+
+  free(printer->events);
+  printer->events = NULL;
+
+  // Wake up any "notify-wait" clients and wait for them to finish with the
+  // printer before destroying anything...
+  pthread_cond_broadcast(&printer->event_cond);
+
+  while (printer->event_waiters > 0)
+    pthread_cond_wait(&printer->event_cond, &printer->event_mutex);
+
+  pthread_mutex_unlock(&printer->event_mutex);
+
+  pthread_cond_destroy(&printer->event_cond);
+  pthread_mutex_destroy(&printer->event_mutex);
+}
+
+
+//
+// '_papplPrinterExpireSubscriptions()' - Remove expired subscriptions.
+//
+// The caller must hold the printer's event mutex.
+//
+
+void
+_papplPrinterExpireSubscriptions(
+    pappl_printer_t *printer,		// I - Printer
+    time_t          curtime)		// I - Current time
+{
+  _pappl_subscription_t	*sub;		// Current subscription
+
+
+  for (sub = (_pappl_subscription_t *)cupsArrayFirst(printer->subscriptions); sub; sub = (_pappl_subscription_t *)cupsArrayNext(printer->subscriptions))
+  {
+    if (sub->expire && sub->expire <= curtime)
+      cupsArrayRemove(printer->subscriptions, sub);
+  }
+}
+
+
+//
+// '_papplSubscriptionEventString()' - Return the keyword value associated with the IPP "notify-events" bit value.
+//
+
+const char *				// O - IPP "notify-events" keyword value
+_papplSubscriptionEventString(
+    _pappl_event_t value)		// I - IPP "notify-events" bit value
+{
+  if (value == _PAPPL_EVENT_NONE)
+    return ("none");
+  else
+    return (_PAPPL_LOOKUP_STRING(value, pappl_events));
+}
+
+
+//
+// '_papplSubscriptionEventValue()' - Return the bit value associated with the IPP "notify-events" keyword value.
+//
+
+_pappl_event_t				// O - IPP "notify-events" bit value
+_papplSubscriptionEventValue(
+    const char *value)			// I - IPP "notify-events" keyword value
+{
+  return ((_pappl_event_t)_PAPPL_LOOKUP_VALUE(value, pappl_events));
+}
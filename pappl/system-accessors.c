@@ -199,12 +199,14 @@ _papplSystemExportVersions(
     pappl_system_t *system,		// I - System
     ipp_t          *ipp,		// I - IPP message
     ipp_tag_t      group_tag,		// I - Group (`IPP_TAG_PRINTER` or `IPP_TAG_SYSTEM`)
-    cups_array_t   *ra)			// I - Requested attributes or `NULL` for all
+    _pappl_ra_t    *ra)			// I - Requested attributes or `NULL` for all
 {
   int		i;			// Looping var
   ipp_attribute_t *attr;		// Attribute
   char		name[128];		// Attribute name
   const char	*name_prefix = (group_tag == IPP_TAG_PRINTER) ? "printer" : "system";
+  _pappl_attr_id_t first_id = (group_tag == IPP_TAG_PRINTER) ? _PAPPL_ATTR_PRINTER_FIRMWARE_NAME : _PAPPL_ATTR_SYSTEM_FIRMWARE_NAME;
+					// First "xxx-firmware-yyy" attribute ID
   const char	*values[20];		// String values
   char		cups_sversion[32];	// String version of libcups
 #ifdef HAVE_LIBJPEG
@@ -215,7 +217,7 @@ _papplSystemExportVersions(
 
   // "xxx-firmware-name"
   snprintf(name, sizeof(name), "%s-firmware-name", name_prefix);
-  if (!ra || cupsArrayFind(ra, name))
+  if (_PAPPL_REQUESTED(ra, first_id))
   {
     for (i = 0; i < system->num_versions; i ++)
       values[i] = system->versions[i].name;
@@ -237,7 +239,7 @@ _papplSystemExportVersions(
 
   // "xxx-firmware-patches"
   snprintf(name, sizeof(name), "%s-firmware-patches", name_prefix);
-  if (!ra || cupsArrayFind(ra, name))
+  if (_PAPPL_REQUESTED(ra, first_id + 1))
   {
     for (i = 0; i < system->num_versions; i ++)
       values[i] = system->versions[i].patches;
@@ -259,7 +261,7 @@ _papplSystemExportVersions(
 
   // "xxx-firmware-string-version"
   snprintf(name, sizeof(name), "%s-firmware-string-version", name_prefix);
-  if (!ra || cupsArrayFind(ra, name))
+  if (_PAPPL_REQUESTED(ra, first_id + 2))
   {
     for (i = 0; i < system->num_versions; i ++)
       values[i] = system->versions[i].sversion;
@@ -283,7 +285,7 @@ _papplSystemExportVersions(
 
   // "xxx-firmware-version"
   snprintf(name, sizeof(name), "%s-firmware-version", name_prefix);
-  if (!ra || cupsArrayFind(ra, name))
+  if (_PAPPL_REQUESTED(ra, first_id + 3))
   {
     for (i = 0, attr = NULL; i < system->num_versions; i ++)
     {
@@ -1212,6 +1214,9 @@ papplSystemSetAdminGroup(
     else
       system->admin_gid = (gid_t)-1;
 
+    // Cached authorization decisions depend on the admin group...
+    _papplSystemFlushAuthCache(system);
+
     system->config_time = time(NULL);
     system->config_changes ++;
 
@@ -1812,6 +1817,39 @@ papplSystemSetSaveCallback(
 }
 
 
+//
+// 'papplSystemSetSaveDelay()' - Set the delays for saving the system state.
+//
+// This function sets how long the system waits before calling the save
+// callback after a configuration or job change.  The "delay" argument
+// specifies the number of seconds without further changes before saving, so
+// that bursts of changes are written once.  The "max_delay" argument specifies
+// the maximum number of seconds that a save is deferred after the first unsaved
+// change.  The defaults are 2 and 10 seconds, respectively.
+//
+// Saves are performed by a background thread, and any pending changes are
+// saved immediately when @link papplSystemShutdown@ is called.
+//
+// @since PAPPL 1.1@
+//
+
+void
+papplSystemSetSaveDelay(
+    pappl_system_t *system,		// I - System
+    int            delay,		// I - Seconds to wait for more changes
+    int            max_delay)		// I - Maximum seconds to defer a save
+{
+  if (system && delay >= 0 && max_delay >= delay)
+  {
+    pthread_mutex_lock(&system->config_mutex);
+    system->save_delay     = delay;
+    system->save_max_delay = max_delay;
+    pthread_cond_broadcast(&system->config_cond);
+    pthread_mutex_unlock(&system->config_mutex);
+  }
+}
+
+
 //
 // 'papplSystemSetUUID()' - Set the system UUID.
 //
@@ -14,13 +14,80 @@
 #include "pappl-private.h"
 
 
+//
+// Constants...
+//
+
+#define _PAPPL_SNAPSHOT_MAGIC	"PAPPLSNP"
+					// Snapshot file magic
+#define _PAPPL_SNAPSHOT_VERSION	1	// Snapshot format version
+#define _PAPPL_SNAPSHOT_ORDER	0x01020304
+					// Snapshot byte order marker
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_reader_s		// State file reader
+{
+  cups_file_t		*fp;			// Text state file, if any
+  const char		*ptr,			// Current position in mapped snapshot
+			*end;			// End of mapped configuration text
+} _pappl_reader_t;
+
+typedef struct _pappl_snaphdr_s		// Snapshot file header
+{
+  char			magic[8];		// "PAPPLSNP"
+  uint32_t		version,		// Format version
+			byteorder;		// Byte order marker
+  uint64_t		config_offset,		// Offset of configuration text
+			config_length,		// Length of configuration text
+			jobs_offset,		// Offset of job records
+			num_jobs,		// Number of job records
+			strings_offset,		// Offset of string pool
+			strings_length;		// Length of string pool
+} _pappl_snaphdr_t;
+
+typedef struct _pappl_snapjob_s		// Snapshot job record
+{
+  int32_t		printer_id,		// "printer-id" value
+			job_id,			// "job-id" value
+			state,			// "job-state" value
+			state_reasons,		// "job-state-reasons" bits
+			impressions,		// "job-impressions" value
+			impcompleted;		// "job-impressions-completed" value
+  int64_t		created,		// "time-at-creation" value
+			processing,		// "time-at-processing" value
+			completed;		// "time-at-completed" value
+  uint32_t		name,			// Offset of "job-name" string
+			username,		// Offset of "job-originating-user-name" string
+			format,			// Offset of "document-format" string
+			filename;		// Offset of document filename or `0` for none
+} _pappl_snapjob_t;
+
+typedef struct _pappl_strpool_s		// Snapshot string pool
+{
+  char			*data;			// String data
+  size_t		length,			// Bytes used
+			alloc;			// Bytes allocated
+} _pappl_strpool_t;
+
+
 //
 // Local functions...
 //
 
+static void	add_job(pappl_system_t *system, pappl_printer_t *printer, pappl_job_t *job);
+static bool	copy_jobs(pappl_printer_t *printer, cups_array_t *recs, _pappl_strpool_t *pool);
+static bool	is_snapshot(const char *filename);
+static bool	load_config(pappl_system_t *system, _pappl_reader_t *r, const char *filename);
+static bool	load_snapshot(pappl_system_t *system, const char *filename);
 static void	parse_contact(char *value, pappl_contact_t *contact);
 static void	parse_media_col(char *value, pappl_media_col_t *media);
-static char	*read_line(cups_file_t *fp, char *line, size_t linesize, char **value, int *linenum);
+static char	*read_line(_pappl_reader_t *r, char *line, size_t linesize, char **value, int *linenum);
+static bool	strpool_add(_pappl_strpool_t *pool, const char *s, uint32_t *offset);
+static bool	write_config(pappl_system_t *system, cups_file_t *fp, bool jobs);
 static void	write_contact(cups_file_t *fp, pappl_contact_t *contact);
 static void	write_media_col(cups_file_t *fp, const char *name, pappl_media_col_t *media);
 static void	write_options(cups_file_t *fp, const char *name, int num_options, cups_option_t *options);
@@ -30,8 +97,9 @@ static void	write_options(cups_file_t *fp, const char *name, int num_options, cu
 // 'papplSystemLoadState()' - Load the previous system state.
 //
 // This function loads the previous system state from a file created by the
-// @link papplSystemSaveState@ function.  The system state contains all of the
-// system object values, the list of printers, and the jobs for each printer.
+// @link papplSystemSaveState@ or @link papplSystemSaveSnapshot@ functions.
+// The system state contains all of the system object values, the list of
+// printers, and the jobs for each printer.
 //
 // When loading a printer definition, if the printer cannot be created (e.g.,
 // because the driver name is no longer valid) then that printer and all of its
@@ -40,6 +108,12 @@ static void	write_options(cups_file_t *fp, const char *name, int num_options, cu
 // name, including the use its auto-add callback to find a compatible new
 // driver.
 //
+// The Job Template attributes of active jobs are not read from the spool
+// directory until the job is queried or printed.
+//
+// Only one binary snapshot can be loaded for a system since its job names and
+// formats are used directly from the mapped file.
+//
 // > Note: This function must be called prior to @link papplSystemRun@.
 //
 
@@ -48,12 +122,8 @@ papplSystemLoadState(
     pappl_system_t *system,		// I - System
     const char     *filename)		// I - File to load
 {
-  int			i;		// Looping var
-  cups_file_t		*fp;		// Output file
-  int			linenum;	// Line number
-  char			line[2048],	// Line from file
-			*ptr,		// Pointer into line/value
-			*value;		// Value from line
+  _pappl_reader_t	r;		// State file reader
+  bool			ret;		// Return value
 
 
   // Range check input...
@@ -67,8 +137,14 @@ papplSystemLoadState(
     return (false);
   }
 
+  // Use the binary loader for snapshots...
+  if (is_snapshot(filename))
+    return (load_snapshot(system, filename));
+
   // Open the state file...
-  if ((fp = cupsFileOpen(filename, "r")) == NULL)
+  memset(&r, 0, sizeof(r));
+
+  if ((r.fp = cupsFileOpen(filename, "r")) == NULL)
   {
     if (errno != ENOENT)
       papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to open system state file '%s': %s", filename, cupsLastErrorString());
@@ -79,8 +155,349 @@ papplSystemLoadState(
   // Read lines from the state file...
   papplLog(system, PAPPL_LOGLEVEL_INFO, "Loading system state from '%s'.", filename);
 
+  ret = load_config(system, &r, filename);
+
+  cupsFileClose(r.fp);
+
+  return (ret);
+}
+
+
+//
+// 'papplSystemSaveState()' - Save the current system state.
+//
+// This function saves the current system state to a file.  It is typically
+// used with the @link papplSystemSetSaveCallback@ function to periodically
+// save the state:
+//
+// ```
+// |papplSystemSetSaveCallback(system, (pappl_save_cb_t)papplSystemSaveState,
+// |    (void *)filename);
+// ```
+//
+// The state is written to a temporary file and then renamed over the previous
+// state file, so the system is only locked while the state is formatted.
+//
+
+bool					// O - `true` on success, `false` on failure
+papplSystemSaveState(
+    pappl_system_t *system,		// I - System
+    const char     *filename)		// I - File to save
+{
+  cups_file_t		*fp;		// Output file
+  char			tempname[1024];	// Temporary filename
+  bool			ret;		// Return value
+
+
+  snprintf(tempname, sizeof(tempname), "%s.N", filename);
+
+  if ((fp = cupsFileOpen(tempname, "w")) == NULL)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create system state file '%s': %s", tempname, cupsLastErrorString());
+    return (false);
+  }
+
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Saving system state to '%s'.", filename);
+
+  pthread_rwlock_rdlock(&system->rwlock);
+  ret = write_config(system, fp, true);
+  pthread_rwlock_unlock(&system->rwlock);
+
+  // Flush the state to disk and replace the old file...
+  if (ret)
+    ret = !cupsFileFlush(fp) && !fsync(cupsFileNumber(fp));
+
+  if (cupsFileClose(fp))
+    ret = false;
+
+  if (ret && rename(tempname, filename))
+    ret = false;
+
+  if (!ret)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to write system state file '%s': %s", filename, strerror(errno));
+    unlink(tempname);
+  }
+
+  return (ret);
+}
+
+
+//
+// 'papplSystemSaveSnapshot()' - Save the current system state as a binary snapshot.
+//
+// This function saves the current system state to a versioned binary snapshot
+// file that @link papplSystemLoadState@ maps into memory at startup.  Job
+// records are stored as fixed-size binary records rather than text, so loading
+// a snapshot does not need to parse every job in the history.  Like
+// @link papplSystemSaveState@, it is typically used with the
+// @link papplSystemSetSaveCallback@ function:
+//
+// ```
+// |papplSystemSetSaveCallback(system, (pappl_save_cb_t)papplSystemSaveSnapshot,
+// |    (void *)filename);
+// ```
+//
+// The snapshot is written to a temporary file and then renamed over the
+// previous snapshot.
+//
+// @since PAPPL 1.1@
+//
+
+bool					// O - `true` on success, `false` on failure
+papplSystemSaveSnapshot(
+    pappl_system_t *system,		// I - System
+    const char     *filename)		// I - File to save
+{
+  int			fd;		// File descriptor
+  cups_file_t		*fp;		// Configuration text output
+  char			tempname[1024];	// Temporary filename
+  _pappl_snaphdr_t	hdr;		// Snapshot header
+  cups_array_t		*recs;		// Job records
+  _pappl_snapjob_t	*rec;		// Current job record
+  _pappl_strpool_t	pool;		// String pool
+  pappl_printer_t	*printer;	// Current printer
+  off_t			offset;		// Current file offset
+  bool			ret = false,	// Return value
+			error = false;	// Error collecting job records?
+  static const char	zeros[8] = { 0 };
+					// Alignment padding
+
+
+  if (!system || !filename)
+    return (false);
+
+  snprintf(tempname, sizeof(tempname), "%s.N", filename);
+
+  if ((fd = open(tempname, O_RDWR | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600)) < 0)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create system state snapshot '%s': %s", tempname, strerror(errno));
+    return (false);
+  }
+
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Saving system state snapshot to '%s'.", filename);
+
+  memset(&hdr, 0, sizeof(hdr));
+  memset(&pool, 0, sizeof(pool));
+  memcpy(hdr.magic, _PAPPL_SNAPSHOT_MAGIC, sizeof(hdr.magic));
+  hdr.version       = _PAPPL_SNAPSHOT_VERSION;
+  hdr.byteorder     = _PAPPL_SNAPSHOT_ORDER;
+  hdr.config_offset = sizeof(hdr);
+
+  recs = cupsArrayNew3(NULL, NULL, NULL, 0, NULL, (cups_afree_func_t)free);
+
+  // Offset 0 is the empty string...
+  if (!recs || !strpool_add(&pool, "", NULL))
+    goto done;
+
+  // Write the (placeholder) header and configuration text...
+  if (write(fd, &hdr, sizeof(hdr)) != (ssize_t)sizeof(hdr) || (fp = cupsFileOpenFd(dup(fd), "w")) == NULL)
+    goto done;
+
+  pthread_rwlock_rdlock(&system->rwlock);
+
+  if (!write_config(system, fp, false))
+    error = true;
+
+  // Collect the job records...
+  for (printer = (pappl_printer_t *)cupsArrayFirst(system->printers); printer && !error; printer = (pappl_printer_t *)cupsArrayNext(system->printers))
+  {
+    if (!printer->is_deleted && !copy_jobs(printer, recs, &pool))
+      error = true;
+  }
+
+  pthread_rwlock_unlock(&system->rwlock);
+
+  if (cupsFileClose(fp) || error)
+    goto done;
+
+  // Write the job records (aligned) and string pool...
+  if ((offset = lseek(fd, 0, SEEK_END)) < 0)
+    goto done;
+
+  hdr.config_length = (uint64_t)offset - hdr.config_offset;
+
+  if ((offset & 7) && write(fd, zeros, (size_t)(8 - (offset & 7))) < 0)
+    goto done;
+
+  hdr.jobs_offset = (uint64_t)((offset + 7) & ~7);
+  hdr.num_jobs    = (uint64_t)cupsArrayCount(recs);
+
+  for (rec = (_pappl_snapjob_t *)cupsArrayFirst(recs); rec; rec = (_pappl_snapjob_t *)cupsArrayNext(recs))
+  {
+    if (write(fd, rec, sizeof(_pappl_snapjob_t)) != (ssize_t)sizeof(_pappl_snapjob_t))
+      goto done;
+  }
+
+  hdr.strings_offset = hdr.jobs_offset + hdr.num_jobs * sizeof(_pappl_snapjob_t);
+  hdr.strings_length = pool.length;
+
+  if (write(fd, pool.data, pool.length) != (ssize_t)pool.length)
+    goto done;
+
+  // Update the header and replace the old snapshot...
+  if (pwrite(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) || fsync(fd))
+    goto done;
+
+  ret = true;
+
+  done:
+
+  close(fd);
+
+  if (ret && rename(tempname, filename))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to replace system state snapshot '%s': %s", filename, strerror(errno));
+    ret = false;
+  }
+
+  if (!ret)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to write system state snapshot '%s'.", tempname);
+    unlink(tempname);
+  }
+
+  cupsArrayDelete(recs);
+  free(pool.data);
+
+  return (ret);
+}
+
+
+//
+// 'add_job()' - Add a loaded job to the printer's job arrays.
+//
+
+static void
+add_job(pappl_system_t  *system,	// I - System
+        pappl_printer_t *printer,	// I - Printer
+        pappl_job_t     *job)		// I - Job
+{
+  struct stat	jobbuf;			// Job file buffer
+
+
+  (void)system;
+
+  if (job->state < IPP_JSTATE_STOPPED)
+  {
+    if (!job->filename || stat(job->filename, &jobbuf))
+    {
+      // If file removed, then set job state to aborted...
+      job->state = IPP_JSTATE_ABORTED;
+
+      _papplJobRemoveAttributes(job);
+    }
+    else
+    {
+      // Defer loading the job attributes from the spool directory until they
+      // are needed, then add the job to printer active jobs array...
+      job->attrs_deferred = true;
+
+      cupsArrayAdd(printer->active_jobs, job);
+    }
+  }
+  else
+  {
+    // Add job to printer completed jobs...
+    cupsArrayAdd(printer->completed_jobs, job);
+
+    _papplJobScheduleCleanup(job);
+  }
+}
+
+
+//
+// 'copy_jobs()' - Copy a printer's job records.
+//
+// The printer is read-locked only while the records and strings are copied;
+// the caller formats and writes them after the lock is released.
+//
+
+static bool				// O - `true` on success, `false` on failure
+copy_jobs(pappl_printer_t  *printer,	// I - Printer
+          cups_array_t     *recs,	// I - Job records
+          _pappl_strpool_t *pool)	// I - String pool
+{
+  bool			ret = true;	// Return value
+  pappl_job_t		*job;		// Current job
+  _pappl_snapjob_t	*rec;		// Current job record
+
+
+  pthread_rwlock_rdlock(&printer->rwlock);
+
+  for (job = (pappl_job_t *)cupsArrayFirst(printer->all_jobs); job; job = (pappl_job_t *)cupsArrayNext(printer->all_jobs))
+  {
+    if ((rec = calloc(1, sizeof(_pappl_snapjob_t))) == NULL)
+    {
+      ret = false;
+      break;
+    }
+
+    rec->printer_id    = printer->printer_id;
+    rec->job_id        = job->job_id;
+    rec->state         = (int32_t)job->state;
+    rec->state_reasons = (int32_t)job->state_reasons;
+    rec->impressions   = job->impressions;
+    rec->impcompleted  = job->impcompleted;
+    rec->created       = (int64_t)job->created;
+    rec->processing    = (int64_t)job->processing;
+    rec->completed     = (int64_t)job->completed;
+
+    cupsArrayAdd(recs, rec);
+
+    if (!strpool_add(pool, job->name, &rec->name) || !strpool_add(pool, job->username, &rec->username) || !strpool_add(pool, job->format, &rec->format) || (job->filename && !strpool_add(pool, job->filename, &rec->filename)))
+    {
+      ret = false;
+      break;
+    }
+  }
+
+  pthread_rwlock_unlock(&printer->rwlock);
+
+  return (ret);
+}
+
+
+//
+// 'is_snapshot()' - Determine whether a state file is a binary snapshot.
+//
+
+static bool				// O - `true` if snapshot, `false` otherwise
+is_snapshot(const char *filename)	// I - State file
+{
+  int	fd;				// File descriptor
+  char	magic[8];			// File magic
+  bool	ret = false;			// Return value
+
+
+  if ((fd = open(filename, O_RDONLY | O_CLOEXEC)) >= 0)
+  {
+    ret = read(fd, magic, sizeof(magic)) == (ssize_t)sizeof(magic) && !memcmp(magic, _PAPPL_SNAPSHOT_MAGIC, sizeof(magic));
+    close(fd);
+  }
+
+  return (ret);
+}
+
+
+//
+// 'load_config()' - Load system and printer values from a state file.
+//
+
+static bool				// O - `true` on success, `false` on failure
+load_config(pappl_system_t  *system,	// I - System
+            _pappl_reader_t *r,		// I - State file reader
+            const char      *filename)	// I - State filename
+{
+  int			i;		// Looping var
+  int			linenum;	// Line number
+  char			line[2048],	// Line from file
+			*ptr,		// Pointer into line/value
+			*value;		// Value from line
+
+
   linenum = 0;
-  while (read_line(fp, line, sizeof(line), &value, &linenum))
+  while (read_line(r, line, sizeof(line), &value, &linenum))
   {
     if (!strcasecmp(line, "DNSSDName"))
       papplSystemSetDNSSDName(system, value);
@@ -146,7 +563,7 @@ papplSystemLoadState(
 	  papplLog(system, PAPPL_LOGLEVEL_ERROR, "Dropping printer '%s' and its job history because an error occurred: %s", printer_name, strerror(errno));
       }
 
-      while (read_line(fp, line, sizeof(line), &value, &linenum))
+      while (read_line(r, line, sizeof(line), &value, &linenum))
       {
         if (!strcasecmp(line, "</Printer>"))
           break;
@@ -269,7 +686,6 @@ papplSystemLoadState(
 	{
 	  // Read printer job
 	  pappl_job_t	*job;		// Current Job
-	  struct stat	jobbuf;		// Job file buffer
 	  const char	*job_name,	// Job name
 			*job_id,	// Job ID
 			*job_username,	// Job username
@@ -314,39 +730,8 @@ papplSystemLoadState(
 	  if ((job_value = cupsGetOption("imcompleted", num_options, options)) != NULL)
 	    job->impcompleted = (int)strtol(job_value, NULL, 10);
 
-	  // Add the job to printer completed jobs array...
-	  if (job->state < IPP_JSTATE_STOPPED)
-	  {
-	    // Load the file attributes from the spool directory...
-	    int		attr_fd;	// Attribute file descriptor
-	    char	job_attr_filename[256];
-					// Attribute filename
-
-	    if ((attr_fd = papplJobOpenFile(job, job_attr_filename, sizeof(job_attr_filename), system->directory, "ipp", "r")) < 0)
-	    {
-	      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to open file for job attributes: '%s'.", job_attr_filename);
-	      continue;
-	    }
-
-	    ippReadFile(attr_fd, job->attrs);
-	    close(attr_fd);
-
-	    if (!job->filename || stat(job->filename, &jobbuf))
-	    {
-	      // If file removed, then set job state to aborted...
-	      job->state = IPP_JSTATE_ABORTED;
-	    }
-	    else
-	    {
-	      // Add the job to printer active jobs array...
-	      cupsArrayAdd(printer->active_jobs, job);
-	    }
-	  }
-	  else
-	  {
-	    // Add job to printer completed jobs...
-	    cupsArrayAdd(printer->completed_jobs, job);
-	  }
+	  // Add the job to the printer's active or completed jobs...
+	  add_job(system, printer, job);
 	}
 	else
 	  papplLog(system, PAPPL_LOGLEVEL_WARN, "Unknown printer directive '%s' on line %d of '%s'.", line, linenum, filename);
@@ -363,213 +748,132 @@ papplSystemLoadState(
     }
   }
 
-  cupsFileClose(fp);
-
   return (true);
 }
 
 
 //
-// 'papplSystemSaveState()' - Save the current system state.
-//
-// This function saves the current system state to a file.  It is typically
-// used with the @link papplSystemSetSaveCallback@ function to periodically
-// save the state:
+// 'load_snapshot()' - Load a binary state snapshot.
 //
-// ```
-// |papplSystemSetSaveCallback(system, (pappl_save_cb_t)papplSystemSaveState,
-// |    (void *)filename);
-// ```
+// The configuration text is parsed directly from the mapped file and the jobs
+// are created from copies of the fixed-size job records.  The job name and
+// format strings still point into the mapped string pool, so the mapping is
+// kept until the system is deleted and only one snapshot can be loaded.
 //
 
-bool					// O - `true` on success, `false` on failure
-papplSystemSaveState(
-    pappl_system_t *system,		// I - System
-    const char     *filename)		// I - File to save
+static bool				// O - `true` on success, `false` on failure
+load_snapshot(pappl_system_t *system,	// I - System
+              const char     *filename)	// I - Snapshot filename
 {
-  int			i;		// Looping var
-  cups_file_t		*fp;		// Output file
-  pappl_printer_t	*printer;	// Current printer
-  pappl_job_t		*job;		// Current Job
+  int			fd;		// File descriptor
+  struct stat		fileinfo;	// File information
+  void			*data;		// Mapped snapshot
+  const _pappl_snaphdr_t *hdr;		// Snapshot header
+  const _pappl_snapjob_t *rec;		// Current job record
+  const char		*strings;	// String pool
+  _pappl_reader_t	r;		// Configuration reader
+  uint64_t		i;		// Looping var
+  pappl_printer_t	*printer = NULL;// Current printer
+  pappl_job_t		*job;		// Current job
+
+
+  // Only load one snapshot since jobs reference the mapped string pool...
+  if (system->snapshot)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to load system state snapshot '%s': A snapshot has already been loaded.", filename);
+    return (false);
+  }
 
+  // Map the snapshot...
+  if ((fd = open(filename, O_RDONLY | O_CLOEXEC)) < 0)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to open system state snapshot '%s': %s", filename, strerror(errno));
+    return (false);
+  }
 
-  if ((fp = cupsFileOpen(filename, "w")) == NULL)
+  if (fstat(fd, &fileinfo) || (size_t)fileinfo.st_size < sizeof(_pappl_snaphdr_t))
   {
-    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create system state file '%s': %s", filename, cupsLastErrorString());
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Bad system state snapshot '%s'.", filename);
+    close(fd);
     return (false);
   }
 
-  papplLog(system, PAPPL_LOGLEVEL_INFO, "Saving system state to '%s'.", filename);
+  data = mmap(NULL, (size_t)fileinfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
 
-  pthread_rwlock_rdlock(&system->rwlock);
+  if (data == MAP_FAILED)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to map system state snapshot '%s': %s", filename, strerror(errno));
+    return (false);
+  }
 
-  if (system->dns_sd_name)
-    cupsFilePutConf(fp, "DNSSDName", system->dns_sd_name);
-  if (system->location)
-    cupsFilePutConf(fp, "Location", system->location);
-  if (system->geo_location)
-    cupsFilePutConf(fp, "Geolocation", system->geo_location);
-  if (system->organization)
-    cupsFilePutConf(fp, "Organization", system->organization);
-  if (system->org_unit)
-    cupsFilePutConf(fp, "OrganizationalUnit", system->org_unit);
-  write_contact(fp, &system->contact);
-  if (system->admin_group)
-    cupsFilePutConf(fp, "AdminGroup", system->admin_group);
-  if (system->default_print_group)
-    cupsFilePutConf(fp, "DefaultPrintGroup", system->default_print_group);
-  if (system->password_hash[0])
-    cupsFilePutConf(fp, "Password", system->password_hash);
-  cupsFilePrintf(fp, "DefaultPrinterID %d\n", system->default_printer_id);
-  cupsFilePrintf(fp, "NextPrinterID %d\n", system->next_printer_id);
-  cupsFilePutConf(fp, "UUID", system->uuid);
+  // Validate the header...
+  hdr = (const _pappl_snaphdr_t *)data;
 
-  for (printer = (pappl_printer_t *)cupsArrayFirst(system->printers); printer; printer = (pappl_printer_t *)cupsArrayNext(system->printers))
+  if (hdr->version != _PAPPL_SNAPSHOT_VERSION || hdr->byteorder != _PAPPL_SNAPSHOT_ORDER || hdr->config_offset > (uint64_t)fileinfo.st_size || hdr->config_length > ((uint64_t)fileinfo.st_size - hdr->config_offset) || hdr->jobs_offset > (uint64_t)fileinfo.st_size || hdr->num_jobs > (((uint64_t)fileinfo.st_size - hdr->jobs_offset) / sizeof(_pappl_snapjob_t)) || (hdr->jobs_offset % sizeof(uint64_t)) != 0 || hdr->strings_offset > (uint64_t)fileinfo.st_size || hdr->strings_length > ((uint64_t)fileinfo.st_size - hdr->strings_offset) || hdr->strings_length == 0 || ((const char *)data)[hdr->strings_offset + hdr->strings_length - 1])
   {
-    int			num_options = 0;// Number of options
-    cups_option_t	*options = NULL;// Options
-
-    if (printer->is_deleted)
-      continue;
-
-    num_options = cupsAddIntegerOption("id", printer->printer_id, num_options, &options);
-    num_options = cupsAddOption("name", printer->name, num_options, &options);
-    num_options = cupsAddOption("did", printer->device_id ? printer->device_id : "", num_options, &options);
-    num_options = cupsAddOption("uri", printer->device_uri, num_options, &options);
-    num_options = cupsAddOption("driver", printer->driver_name, num_options, &options);
-
-    write_options(fp, "<Printer", num_options, options);
-    cupsFreeOptions(num_options, options);
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unsupported or corrupt system state snapshot '%s'.", filename);
+    munmap(data, (size_t)fileinfo.st_size);
+    return (false);
+  }
 
-    if (printer->dns_sd_name)
-      cupsFilePutConf(fp, "DNSSDName", printer->dns_sd_name);
-    if (printer->location)
-      cupsFilePutConf(fp, "Location", printer->location);
-    if (printer->geo_location)
-      cupsFilePutConf(fp, "Geolocation", printer->geo_location);
-    if (printer->organization)
-      cupsFilePutConf(fp, "Organization", printer->organization);
-    if (printer->org_unit)
-      cupsFilePutConf(fp, "OrganizationalUnit", printer->org_unit);
-    write_contact(fp, &printer->contact);
-    if (printer->print_group)
-      cupsFilePutConf(fp, "PrintGroup", printer->print_group);
-    cupsFilePrintf(fp, "MaxActiveJobs %d\n", printer->max_active_jobs);
-    cupsFilePrintf(fp, "MaxCompletedJobs %d\n", printer->max_completed_jobs);
-    cupsFilePrintf(fp, "NextJobId %d\n", printer->next_job_id);
-    cupsFilePrintf(fp, "ImpressionsCompleted %d\n", printer->impcompleted);
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Loading system state snapshot from '%s'.", filename);
 
-    if (printer->driver_data.identify_default)
-      cupsFilePutConf(fp, "identify-actions-default", _papplIdentifyActionsString(printer->driver_data.identify_default));
+  // Load the system and printer values...
+  r.fp  = NULL;
+  r.ptr = (const char *)data + hdr->config_offset;
+  r.end = r.ptr + hdr->config_length;
 
-    if (printer->driver_data.mode_configured)
-      cupsFilePutConf(fp, "label-mode-configured", _papplLabelModeString(printer->driver_data.mode_configured));
-    if (printer->driver_data.tear_offset_configured)
-      cupsFilePrintf(fp, "label-tear-offset-configured %d\n", printer->driver_data.tear_offset_configured);
+  if (!load_config(system, &r, filename))
+  {
+    munmap(data, (size_t)fileinfo.st_size);
+    return (false);
+  }
 
-    write_media_col(fp, "media-col-default", &printer->driver_data.media_default);
+  // Then add the jobs, using the strings in the mapped string pool...
+  strings = (const char *)data + hdr->strings_offset;
 
-    for (i = 0; i < printer->driver_data.num_source; i ++)
+  for (i = 0, rec = (const _pappl_snapjob_t *)((const char *)data + hdr->jobs_offset); i < hdr->num_jobs; i ++, rec ++)
+  {
+    if (rec->name >= hdr->strings_length || rec->username >= hdr->strings_length || rec->format >= hdr->strings_length || rec->filename >= hdr->strings_length || rec->job_id <= 0)
     {
-      if (printer->driver_data.media_ready[i].size_name[0])
-      {
-        char	name[128];		// Attribute name
-
-        snprintf(name, sizeof(name), "media-col-ready%d", i);
-        write_media_col(fp, name, printer->driver_data.media_ready + i);
-      }
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Bad job record %u in '%s'.", (unsigned)i, filename);
+      continue;
     }
-    if (printer->driver_data.orient_default)
-      cupsFilePutConf(fp, "orientation-requested-default", ippEnumString("orientation-requested", (int)printer->driver_data.orient_default));
-    if (printer->driver_data.bin_default && printer->driver_data.num_bin > 0)
-      cupsFilePutConf(fp, "output-bin-default", printer->driver_data.bin[printer->driver_data.bin_default]);
-    if (printer->driver_data.color_default)
-      cupsFilePutConf(fp, "print-color-mode-default", _papplColorModeString(printer->driver_data.color_default));
-    if (printer->driver_data.content_default)
-      cupsFilePutConf(fp, "print-content-optimize-default", _papplContentString(printer->driver_data.content_default));
-    if (printer->driver_data.darkness_default)
-      cupsFilePrintf(fp, "print-darkness-default %d\n", printer->driver_data.darkness_default);
-    if (printer->driver_data.quality_default)
-      cupsFilePutConf(fp, "print-quality-default", ippEnumString("print-quality", (int)printer->driver_data.quality_default));
-    if (printer->driver_data.scaling_default)
-      cupsFilePutConf(fp, "print-scaling-default", _papplScalingString(printer->driver_data.scaling_default));
-    if (printer->driver_data.darkness_configured)
-      cupsFilePrintf(fp, "printer-darkness-configured %d\n", printer->driver_data.darkness_configured);
-    if (printer->driver_data.sides_default)
-      cupsFilePutConf(fp, "sides-default", _papplSidesString(printer->driver_data.sides_default));
-    if (printer->driver_data.x_default)
-      cupsFilePrintf(fp, "printer-resolution-default %dx%ddpi\n", printer->driver_data.x_default, printer->driver_data.y_default);
-    for (i = 0; i < printer->driver_data.num_vendor; i ++)
-    {
-      char	defname[128],		// xxx-default name
-	      	defvalue[1024];		// xxx-default value
-
-      snprintf(defname, sizeof(defname), "%s-default", printer->driver_data.vendor[i]);
-      ippAttributeString(ippFindAttribute(printer->driver_attrs, defname, IPP_TAG_ZERO), defvalue, sizeof(defvalue));
 
-      cupsFilePutConf(fp, defname, defvalue);
+    if (!printer || printer->printer_id != rec->printer_id)
+    {
+      if ((printer = papplSystemFindPrinter(system, NULL, rec->printer_id, NULL)) == NULL)
+        continue;			// Printer was dropped
     }
 
-    for (job = (pappl_job_t *)cupsArrayFirst(printer->all_jobs); job; job = (pappl_job_t *)cupsArrayNext(printer->all_jobs))
+    if ((job = _papplJobCreate(printer, rec->job_id, strings + rec->username, strings + rec->format, strings + rec->name, NULL)) == NULL)
     {
-      // Add basic job attributes...
-      num_options = 0;
-      num_options = cupsAddIntegerOption("id", job->job_id, num_options, &options);
-      num_options = cupsAddOption("name", job->name, num_options, &options);
-      num_options = cupsAddOption("username", job->username, num_options, &options);
-      num_options = cupsAddOption("format", job->format, num_options, &options);
-
-      if (job->filename)
-        num_options = cupsAddOption("filename", job->filename, num_options, &options);
-      if (job->state)
-        num_options = cupsAddIntegerOption("state", (int)job->state, num_options, &options);
-      if (job->state_reasons)
-        num_options = cupsAddIntegerOption("state_reasons", (int)job->state_reasons, num_options, &options);
-      if (job->created)
-        num_options = cupsAddIntegerOption("created", (int)job->created, num_options, &options);
-      if (job->processing)
-        num_options = cupsAddIntegerOption("processing", (int)job->processing, num_options, &options);
-      if (job->completed)
-        num_options = cupsAddIntegerOption("completed", (int)job->completed, num_options, &options);
-      if (job->impressions)
-        num_options = cupsAddIntegerOption("impressions", job->impressions, num_options, &options);
-      if (job->impcompleted)
-        num_options = cupsAddIntegerOption("imcompleted", job->impcompleted, num_options, &options);
-
-      if (job->attrs)
-      {
-	int	attr_fd;		// Attribute file descriptor
-	char	job_attr_filename[1024];// Attribute filename
-
-        // Save job attributes to file in spool directory...
-        if (job->state < IPP_JSTATE_STOPPED)
-        {
-          if ((attr_fd = papplJobOpenFile(job, job_attr_filename, sizeof(job_attr_filename), system->directory, "ipp", "w")) < 0)
-          {
-            papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create file for job attributes: '%s'.", job_attr_filename);
-            continue;
-          }
-
-          ippWriteFile(attr_fd, job->attrs);
-          close(attr_fd);
-        }
-        else
-        {
-          // If job completed or aborted, remove job-attributes file...
-          papplJobOpenFile(job, job_attr_filename, sizeof(job_attr_filename), system->directory, "ipp", "x");
-        }
-      }
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Error creating job %s for printer %s", strings + rec->name, printer->name);
+      continue;
+    }
 
-      write_options(fp, "Job", num_options, options);
-      cupsFreeOptions(num_options, options);
+    if (rec->filename && (job->filename = strdup(strings + rec->filename)) == NULL)
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Error creating job %s for printer %s", strings + rec->name, printer->name);
+      continue;
     }
 
-    cupsFilePuts(fp, "</Printer>\n");
-  }
+    job->state         = (ipp_jstate_t)rec->state;
+    job->state_reasons = (pappl_jreason_t)rec->state_reasons;
+    job->created       = (time_t)rec->created;
+    job->processing    = (time_t)rec->processing;
+    job->completed     = (time_t)rec->completed;
+    job->impressions   = rec->impressions;
+    job->impcompleted  = rec->impcompleted;
 
-  pthread_rwlock_unlock(&system->rwlock);
+    add_job(system, printer, job);
+  }
 
-  cupsFileClose(fp);
+  // Keep the mapping until papplSystemDelete since the jobs reference the
+  // string pool...
+  system->snapshot      = data;
+  system->snapshot_size = (size_t)fileinfo.st_size;
 
   return (true);
 }
@@ -659,24 +963,45 @@ parse_media_col(
 //
 // This function is like `cupsFileGetConf`, except that it doesn't support
 // comments since the state files are not meant to be edited or maintained by
-// humans.
+// humans.  Lines are read from the text state file or, for snapshots, directly
+// from the mapped configuration text.
 //
 
 static char *				// O  - Line or `NULL` on EOF
-read_line(cups_file_t *fp,		// I  - File
-          char        *line,		// I  - Line buffer
-          size_t      linesize,		// I  - Size of line buffer
-          char        **value,		// O  - Value portion of line
-          int         *linenum)		// IO - Current line number
+read_line(_pappl_reader_t *r,		// I  - State file reader
+          char            *line,	// I  - Line buffer
+          size_t          linesize,	// I  - Size of line buffer
+          char            **value,	// O  - Value portion of line
+          int             *linenum)	// IO - Current line number
 {
-  char	*ptr;				// Pointer into line
+  char	*ptr,				// Pointer into line
+	*end;				// End of line buffer
 
 
   // Try reading a line from the file...
   *value = NULL;
 
-  if (!cupsFileGets(fp, line, linesize))
-    return (NULL);
+  if (r->fp)
+  {
+    if (!cupsFileGets(r->fp, line, linesize))
+      return (NULL);
+  }
+  else
+  {
+    if (r->ptr >= r->end)
+      return (NULL);
+
+    for (ptr = line, end = line + linesize - 1; r->ptr < r->end && *(r->ptr) != '\n'; r->ptr ++)
+    {
+      if (ptr < end)
+        *ptr++ = *(r->ptr);
+    }
+
+    *ptr = '\0';
+
+    if (r->ptr < r->end)
+      r->ptr ++;			// Skip newline
+  }
 
   // Got it, bump the line number...
   (*linenum) ++;
@@ -696,6 +1021,234 @@ read_line(cups_file_t *fp,		// I  - File
 }
 
 
+//
+// 'strpool_add()' - Add a string to a snapshot string pool.
+//
+
+static bool				// O - `true` on success, `false` on error
+strpool_add(_pappl_strpool_t *pool,	// I - String pool
+            const char       *s,	// I - String
+            uint32_t         *offset)	// O - Offset of string
+{
+  size_t	len = strlen(s ? s : "") + 1;
+					// Length of string with nul
+
+
+  if ((pool->length + len) > 0xffffffff)
+    return (false);			// Offsets are 32-bit
+
+  if ((pool->length + len) > pool->alloc)
+  {
+    size_t	alloc = pool->alloc ? 2 * pool->alloc : 4096;
+					// New allocation size
+    char	*data;			// New string data
+
+    while (alloc < (pool->length + len))
+      alloc *= 2;
+
+    if ((data = realloc(pool->data, alloc)) == NULL)
+      return (false);
+
+    pool->data  = data;
+    pool->alloc = alloc;
+  }
+
+  if (offset)
+    *offset = (uint32_t)pool->length;
+
+  memcpy(pool->data + pool->length, s ? s : "", len);
+  pool->length += len;
+
+  return (true);
+}
+
+
+//
+// 'write_config()' - Write the system and printer values to a state file.
+//
+// The system must be locked by the caller.  Each printer's job records are
+// copied with @code copy_jobs@ and written after the printer is unlocked.
+//
+
+static bool				// O - `true` on success, `false` on failure
+write_config(pappl_system_t *system,	// I - System
+             cups_file_t    *fp,	// I - File
+             bool           jobs)	// I - Write "Job" lines?
+{
+  int			i;		// Looping var
+  bool			ret = true;	// Return value
+  pappl_printer_t	*printer;	// Current printer
+  cups_array_t		*recs = NULL;	// Job records
+  _pappl_snapjob_t	*rec;		// Current job record
+  _pappl_strpool_t	pool;		// String pool
+
+
+  if (system->dns_sd_name)
+    cupsFilePutConf(fp, "DNSSDName", system->dns_sd_name);
+  if (system->location)
+    cupsFilePutConf(fp, "Location", system->location);
+  if (system->geo_location)
+    cupsFilePutConf(fp, "Geolocation", system->geo_location);
+  if (system->organization)
+    cupsFilePutConf(fp, "Organization", system->organization);
+  if (system->org_unit)
+    cupsFilePutConf(fp, "OrganizationalUnit", system->org_unit);
+  write_contact(fp, &system->contact);
+  if (system->admin_group)
+    cupsFilePutConf(fp, "AdminGroup", system->admin_group);
+  if (system->default_print_group)
+    cupsFilePutConf(fp, "DefaultPrintGroup", system->default_print_group);
+  if (system->password_hash[0])
+    cupsFilePutConf(fp, "Password", system->password_hash);
+  cupsFilePrintf(fp, "DefaultPrinterID %d\n", system->default_printer_id);
+  cupsFilePrintf(fp, "NextPrinterID %d\n", system->next_printer_id);
+  cupsFilePutConf(fp, "UUID", system->uuid);
+
+  memset(&pool, 0, sizeof(pool));
+
+  if (jobs)
+  {
+    // Offset 0 is the empty string...
+    if ((recs = cupsArrayNew3(NULL, NULL, NULL, 0, NULL, (cups_afree_func_t)free)) == NULL || !strpool_add(&pool, "", NULL))
+      ret = false;
+  }
+
+  for (printer = (pappl_printer_t *)cupsArrayFirst(system->printers); printer && ret; printer = (pappl_printer_t *)cupsArrayNext(system->printers))
+  {
+    int			num_options = 0;// Number of options
+    cups_option_t	*options = NULL;// Options
+
+    if (printer->is_deleted)
+      continue;
+
+    num_options = cupsAddIntegerOption("id", printer->printer_id, num_options, &options);
+    num_options = cupsAddOption("name", printer->name, num_options, &options);
+    num_options = cupsAddOption("did", printer->device_id ? printer->device_id : "", num_options, &options);
+    num_options = cupsAddOption("uri", printer->device_uri, num_options, &options);
+    num_options = cupsAddOption("driver", printer->driver_name, num_options, &options);
+
+    write_options(fp, "<Printer", num_options, options);
+    cupsFreeOptions(num_options, options);
+
+    if (printer->dns_sd_name)
+      cupsFilePutConf(fp, "DNSSDName", printer->dns_sd_name);
+    if (printer->location)
+      cupsFilePutConf(fp, "Location", printer->location);
+    if (printer->geo_location)
+      cupsFilePutConf(fp, "Geolocation", printer->geo_location);
+    if (printer->organization)
+      cupsFilePutConf(fp, "Organization", printer->organization);
+    if (printer->org_unit)
+      cupsFilePutConf(fp, "OrganizationalUnit", printer->org_unit);
+    write_contact(fp, &printer->contact);
+    if (printer->print_group)
+      cupsFilePutConf(fp, "PrintGroup", printer->print_group);
+    cupsFilePrintf(fp, "MaxActiveJobs %d\n", printer->max_active_jobs);
+    cupsFilePrintf(fp, "MaxCompletedJobs %d\n", printer->max_completed_jobs);
+    cupsFilePrintf(fp, "NextJobId %d\n", printer->next_job_id);
+    cupsFilePrintf(fp, "ImpressionsCompleted %d\n", printer->impcompleted);
+
+    if (printer->driver_data.identify_default)
+      cupsFilePutConf(fp, "identify-actions-default", _papplIdentifyActionsString(printer->driver_data.identify_default));
+
+    if (printer->driver_data.mode_configured)
+      cupsFilePutConf(fp, "label-mode-configured", _papplLabelModeString(printer->driver_data.mode_configured));
+    if (printer->driver_data.tear_offset_configured)
+      cupsFilePrintf(fp, "label-tear-offset-configured %d\n", printer->driver_data.tear_offset_configured);
+
+    write_media_col(fp, "media-col-default", &printer->driver_data.media_default);
+
+    for (i = 0; i < printer->driver_data.num_source; i ++)
+    {
+      if (printer->driver_data.media_ready[i].size_name[0])
+      {
+        char	name[128];		// Attribute name
+
+        snprintf(name, sizeof(name), "media-col-ready%d", i);
+        write_media_col(fp, name, printer->driver_data.media_ready + i);
+      }
+    }
+    if (printer->driver_data.orient_default)
+      cupsFilePutConf(fp, "orientation-requested-default", ippEnumString("orientation-requested", (int)printer->driver_data.orient_default));
+    if (printer->driver_data.bin_default && printer->driver_data.num_bin > 0)
+      cupsFilePutConf(fp, "output-bin-default", printer->driver_data.bin[printer->driver_data.bin_default]);
+    if (printer->driver_data.color_default)
+      cupsFilePutConf(fp, "print-color-mode-default", _papplColorModeString(printer->driver_data.color_default));
+    if (printer->driver_data.content_default)
+      cupsFilePutConf(fp, "print-content-optimize-default", _papplContentString(printer->driver_data.content_default));
+    if (printer->driver_data.darkness_default)
+      cupsFilePrintf(fp, "print-darkness-default %d\n", printer->driver_data.darkness_default);
+    if (printer->driver_data.quality_default)
+      cupsFilePutConf(fp, "print-quality-default", ippEnumString("print-quality", (int)printer->driver_data.quality_default));
+    if (printer->driver_data.scaling_default)
+      cupsFilePutConf(fp, "print-scaling-default", _papplScalingString(printer->driver_data.scaling_default));
+    if (printer->driver_data.darkness_configured)
+      cupsFilePrintf(fp, "printer-darkness-configured %d\n", printer->driver_data.darkness_configured);
+    if (printer->driver_data.sides_default)
+      cupsFilePutConf(fp, "sides-default", _papplSidesString(printer->driver_data.sides_default));
+    if (printer->driver_data.x_default)
+      cupsFilePrintf(fp, "printer-resolution-default %dx%ddpi\n", printer->driver_data.x_default, printer->driver_data.y_default);
+    for (i = 0; i < printer->driver_data.num_vendor; i ++)
+    {
+      char	defname[128],		// xxx-default name
+	      	defvalue[1024];		// xxx-default value
+
+      snprintf(defname, sizeof(defname), "%s-default", printer->driver_data.vendor[i]);
+      ippAttributeString(ippFindAttribute(printer->driver_attrs, defname, IPP_TAG_ZERO), defvalue, sizeof(defvalue));
+
+      cupsFilePutConf(fp, defname, defvalue);
+    }
+
+    if (jobs)
+    {
+      // Copy the job records under the printer lock, then write them...
+      cupsArrayClear(recs);
+      pool.length = 1;
+
+      if (!copy_jobs(printer, recs, &pool))
+        ret = false;
+
+      for (rec = (_pappl_snapjob_t *)cupsArrayFirst(recs); rec && ret; rec = (_pappl_snapjob_t *)cupsArrayNext(recs))
+      {
+        // Add basic job attributes...
+        num_options = 0;
+        num_options = cupsAddIntegerOption("id", rec->job_id, num_options, &options);
+        num_options = cupsAddOption("name", pool.data + rec->name, num_options, &options);
+        num_options = cupsAddOption("username", pool.data + rec->username, num_options, &options);
+        num_options = cupsAddOption("format", pool.data + rec->format, num_options, &options);
+
+        if (rec->filename)
+          num_options = cupsAddOption("filename", pool.data + rec->filename, num_options, &options);
+        if (rec->state)
+          num_options = cupsAddIntegerOption("state", rec->state, num_options, &options);
+        if (rec->state_reasons)
+          num_options = cupsAddIntegerOption("state_reasons", rec->state_reasons, num_options, &options);
+        if (rec->created)
+          num_options = cupsAddIntegerOption("created", (int)rec->created, num_options, &options);
+        if (rec->processing)
+          num_options = cupsAddIntegerOption("processing", (int)rec->processing, num_options, &options);
+        if (rec->completed)
+          num_options = cupsAddIntegerOption("completed", (int)rec->completed, num_options, &options);
+        if (rec->impressions)
+          num_options = cupsAddIntegerOption("impressions", rec->impressions, num_options, &options);
+        if (rec->impcompleted)
+          num_options = cupsAddIntegerOption("imcompleted", rec->impcompleted, num_options, &options);
+
+        write_options(fp, "Job", num_options, options);
+        cupsFreeOptions(num_options, options);
+      }
+    }
+
+    cupsFilePuts(fp, "</Printer>\n");
+  }
+
+  cupsArrayDelete(recs);
+  free(pool.data);
+
+  return (ret);
+}
+
+
 //
 // 'write_contact()' - Write an "xxx-contact" value.
 //
@@ -18,19 +18,42 @@
 #  include "dnssd-private.h"
 #  include "system.h"
 #  include <grp.h>
+#  include <sys/mman.h>
 
 
 //
 // Constants...
 //
 
+#  define _PAPPL_AUTH_CACHE_TTL	300	// Lifetime of cached credentials in seconds
+#  define _PAPPL_HOSTNAME_TTL	3600	// Lifetime of cached client hostnames in seconds
+#  define _PAPPL_MAX_AUTH_CACHE	32	// Maximum number of cached credentials
+#  define _PAPPL_MAX_HOSTNAMES	64	// Maximum number of cached client hostnames
 #  define _PAPPL_MAX_LISTENERS	32	// Maximum number of listener sockets
+#  define _PAPPL_RESOURCE_HASH	512	// Number of resource hash buckets
+#  define _PAPPL_TIMER_SLOTS	64	// Number of slots in each level of the job timer wheel
 
 
 //
 // Types and structures...
 //
 
+typedef struct _pappl_authcache_s	// Cached Basic authentication result
+{
+  unsigned char		hash[32];		// Salted SHA2-256 hash of "username:password"
+  char			username[256];		// Authenticated username
+  http_status_t		status;			// Authorization result
+  time_t		expire;			// Expiration time
+} _pappl_authcache_t;
+
+typedef struct _pappl_hostname_s	// Cached client hostname
+{
+  http_addr_t		addr;			// Client address
+  char			name[256];		// Hostname or "" while the lookup is pending
+  time_t		expire;			// Expiration time or 0 if unused
+  size_t		used;			// Use counter for LRU replacement
+} _pappl_hostname_t;
+
 typedef struct _pappl_mime_filter_s	// MIME filter
 {
   const char		*src,			// Source MIME media type
@@ -41,6 +64,7 @@ typedef struct _pappl_mime_filter_s	// MIME filter
 
 typedef struct _pappl_resource_s	// Resource
 {
+  struct _pappl_resource_s *next;		// Next resource in hash bucket
   char			*path,			// Path
 			*format,		// Content type (MIME media type)
 			*filename,		// Filename
@@ -50,8 +74,20 @@ typedef struct _pappl_resource_s	// Resource
   size_t		length;			// Length of file/data
   pappl_resource_cb_t	cb;			// Dynamic callback
   void			*cbdata;		// Callback data
+  pthread_mutex_t	fd_mutex;		// Mutex for cached file descriptor
+  int			fd;			// Cached file descriptor or -1
+  dev_t			fd_dev;			// Device of cached file
+  ino_t			fd_ino;			// Inode of cached file
 } _pappl_resource_t;
 
+typedef struct _pappl_timer_s		// Job expiration timer
+{
+  struct _pappl_timer_s	*next;			// Next timer in slot
+  time_t		expire;			// Expiration time
+  int			printer_id,		// Printer ID
+			job_id;			// Job ID
+} _pappl_timer_t;
+
 struct _pappl_system_s			// System data
 {
   pthread_rwlock_t	rwlock;			// Reader/writer lock
@@ -59,11 +95,16 @@ struct _pappl_system_s			// System data
   bool			is_running;		// Is the system running?
   time_t		start_time,		// Startup time
 			config_time,		// Time of last config change
-			clean_time,		// Next clean time
 			shutdown_time;		// Shutdown requested?
   pthread_mutex_t	config_mutex;		// Mutex for configuration changes
+  pthread_cond_t	config_cond;		// Condition for configuration changes
   size_t		config_changes,		// Number of configuration changes
 			save_changes;		// Number of saved changes
+  int			save_delay,		// Seconds to wait for more changes before saving
+			save_max_delay;		// Maximum seconds to defer a save
+  pthread_t		save_thread;		// Background save thread
+  bool			save_active,		// Is the save thread running?
+			save_now;		// Save pending changes immediately?
   char			*uuid,			// "system-uuid" value
 			*name,			// "system-name" value
 			*dns_sd_name,		// "system-dns-sd-name" value
@@ -88,6 +129,16 @@ struct _pappl_system_s			// System data
   char			*auth_service;		// PAM authorization service, if any
   char			*admin_group;		// PAM administrative group, if any
   gid_t			admin_gid;		// PAM administrative group ID
+  pthread_mutex_t	auth_mutex;		// Mutex for credential cache
+  unsigned char		auth_salt[16];		// Salt for credential cache hashes
+  _pappl_authcache_t	auth_cache[_PAPPL_MAX_AUTH_CACHE];
+						// Credential cache
+  pthread_mutex_t	hostnames_mutex;	// Mutex for client hostname cache
+  pthread_cond_t	hostnames_cond;		// Condition for finished hostname lookups
+  int			hostnames_lookups;	// Number of hostname lookups in progress
+  _pappl_hostname_t	hostnames[_PAPPL_MAX_HOSTNAMES];
+						// Client hostname cache
+  size_t		hostnames_used;		// Client hostname use counter
   char			*default_print_group;	// Default PAM printing group, if any
   char			session_key[65];	// Session key
   pthread_rwlock_t	session_rwlock;		// Reader/writer lock for the session key
@@ -97,6 +148,9 @@ struct _pappl_system_s			// System data
 						// Listener sockets
   cups_array_t		*links;			// Web navigation links
   cups_array_t		*resources;		// Array of resources
+  cups_array_t		*printer_resources;	// Array of printer resource patterns
+  _pappl_resource_t	*resource_hash[_PAPPL_RESOURCE_HASH];
+						// Hash table of resources
   cups_array_t		*filters;		// Array of filters
   int			next_client;		// Next client number
   cups_array_t		*printers;		// Array of printers
@@ -131,6 +185,12 @@ struct _pappl_system_s			// System data
   pappl_wifi_join_cb_t	wifi_join_cb;		// Wi-Fi join callback
   pappl_wifi_status_cb_t wifi_status_cb;	// Wi-Fi status callback
   void			*wifi_cbdata;		// Wi-Fi callback data
+  pthread_mutex_t	timer_mutex;		// Mutex for job expiration timers
+  time_t		timer_time;		// Next job timer wheel time to process
+  _pappl_timer_t	*timers[2][_PAPPL_TIMER_SLOTS];
+					// Job timer wheel (1 and 64 second slots)
+  void			*snapshot;		// Mapped state snapshot, if any
+  size_t		snapshot_size;		// Size of mapped state snapshot
 };
 
 
@@ -138,15 +198,21 @@ struct _pappl_system_s			// System data
 // Functions...
 //
 
+extern int		_papplResourceOpenFile(_pappl_resource_t *r) _PAPPL_PRIVATE;
+
 extern void		_papplSystemAddPrinter(pappl_system_t *system, pappl_printer_t *printer, int printer_id) _PAPPL_PRIVATE;
 extern void		_papplSystemAddPrinterIcons(pappl_system_t *system, pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplSystemAddPrinterResourceCallback(pappl_system_t *system, const char *subpath, const char *format, pappl_resource_cb_t cb) _PAPPL_PRIVATE;
 extern void		_papplSystemCleanJobs(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemConfigChanged(pappl_system_t *system) _PAPPL_PRIVATE;
-extern void		_papplSystemExportVersions(pappl_system_t *system, ipp_t *ipp, ipp_tag_t group_tag, cups_array_t *ra);
+extern void		_papplSystemExportVersions(pappl_system_t *system, ipp_t *ipp, ipp_tag_t group_tag, _pappl_ra_t *ra);
 extern _pappl_mime_filter_t *_papplSystemFindMIMEFilter(pappl_system_t *system, const char *srctype, const char *dsttype) _PAPPL_PRIVATE;
-extern _pappl_resource_t *_papplSystemFindResource(pappl_system_t *system, const char *path) _PAPPL_PRIVATE;
+extern _pappl_resource_t *_papplSystemFindResource(pappl_system_t *system, const char *path, void **cbdata) _PAPPL_PRIVATE;
+extern void		_papplSystemFlushAuthCache(pappl_system_t *system) _PAPPL_PRIVATE;
 extern char		*_papplSystemMakeUUID(pappl_system_t *system, const char *printer_name, int job_id, char *buffer, size_t bufsize) _PAPPL_PRIVATE;
 extern void		_papplSystemProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
+extern void		_papplSystemRemoveResourceNoLock(pappl_system_t *system, _pappl_resource_t *r) _PAPPL_PRIVATE;
+extern void		_papplSystemRemoveResourcesNoLock(pappl_system_t *system, const char *prefix) _PAPPL_PRIVATE;
 extern bool		_papplSystemRegisterDNSSDNoLock(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemUnregisterDNSSDNoLock(pappl_system_t *system) _PAPPL_PRIVATE;
 
@@ -30,6 +30,7 @@ static bool	restart_logging = false;// Restart logging?
 //
 
 static void	make_attributes(pappl_system_t *system);
+static void	*save_system(pappl_system_t *system);
 static void	sighup_handler(int sig);
 static void	sigterm_handler(int sig);
 
@@ -88,7 +89,10 @@ _papplSystemConfigChanged(
   pthread_mutex_lock(&system->config_mutex);
 
   if (system->is_running)
+  {
     system->config_changes ++;
+    pthread_cond_broadcast(&system->config_cond);
+  }
 
   pthread_mutex_unlock(&system->config_mutex);
 }
@@ -158,6 +162,7 @@ papplSystemCreate(
 {
   pappl_system_t	*system;	// System object
   const char		*tmpdir;	// Temporary directory
+  size_t		i;		// Looping var
 
 
   if (!name)
@@ -171,6 +176,11 @@ papplSystemCreate(
   pthread_rwlock_init(&system->rwlock, NULL);
   pthread_rwlock_init(&system->session_rwlock, NULL);
   pthread_mutex_init(&system->config_mutex, NULL);
+  pthread_cond_init(&system->config_cond, NULL);
+  pthread_mutex_init(&system->timer_mutex, NULL);
+  pthread_mutex_init(&system->auth_mutex, NULL);
+  pthread_mutex_init(&system->hostnames_mutex, NULL);
+  pthread_cond_init(&system->hostnames_cond, NULL);
 
   system->options         = options;
   system->start_time      = time(NULL);
@@ -188,6 +198,15 @@ papplSystemCreate(
   system->tls_only        = tls_only;
   system->admin_gid       = (gid_t)-1;
   system->auth_service    = auth_service ? strdup(auth_service) : NULL;
+  system->save_delay      = 2;
+  system->save_max_delay  = 10;
+
+  for (i = 0; i < sizeof(system->auth_salt); i += 4)
+  {
+    unsigned rval = _papplGetRand();	// Random salt value
+
+    memcpy(system->auth_salt + i, &rval, 4);
+  }
 
   if (!system->name || !system->dns_sd_name || (spooldir && !system->directory) || (logfile && !system->logfile) || (subtypes && !system->subtypes) || (auth_service && !system->auth_service))
     goto fatal;
@@ -281,6 +300,13 @@ papplSystemDelete(
   if (!system || system->is_running)
     return;
 
+  // Wait for any client hostname lookups to finish since they update the
+  // hostname cache after the client is gone...
+  pthread_mutex_lock(&system->hostnames_mutex);
+  while (system->hostnames_lookups > 0)
+    pthread_cond_wait(&system->hostnames_cond, &system->hostnames_mutex);
+  pthread_mutex_unlock(&system->hostnames_mutex);
+
   _papplSystemUnregisterDNSSDNoLock(system);
 
   cupsArrayDelete(system->printers);
@@ -306,10 +332,31 @@ papplSystemDelete(
   cupsArrayDelete(system->filters);
   cupsArrayDelete(system->links);
   cupsArrayDelete(system->resources);
+  cupsArrayDelete(system->printer_resources);
+
+  for (i = 0; i < (int)(sizeof(system->timers) / sizeof(system->timers[0][0])); i ++)
+  {
+    _pappl_timer_t	*timer,		// Current timer
+			*next;		// Next timer
+
+    for (timer = system->timers[i / _PAPPL_TIMER_SLOTS][i % _PAPPL_TIMER_SLOTS]; timer; timer = next)
+    {
+      next = timer->next;
+      free(timer);
+    }
+  }
+
+  if (system->snapshot)
+    munmap(system->snapshot, system->snapshot_size);
 
   pthread_rwlock_destroy(&system->rwlock);
   pthread_rwlock_destroy(&system->session_rwlock);
   pthread_mutex_destroy(&system->config_mutex);
+  pthread_cond_destroy(&system->config_cond);
+  pthread_mutex_destroy(&system->timer_mutex);
+  pthread_mutex_destroy(&system->auth_mutex);
+  pthread_mutex_destroy(&system->hostnames_mutex);
+  pthread_cond_destroy(&system->hostnames_cond);
 
   free(system);
 }
@@ -372,6 +419,8 @@ papplSystemRun(pappl_system_t *system)	// I - System
 					// Server: header value
   int			dns_sd_host_changes;
 					// Current number of host name changes
+  size_t		signalled_changes = 0;
+					// Last change count sent to save thread
   pappl_printer_t	*printer;	// Current printer
   pappl_printer_t	*usb_printer = NULL;
 					// USB printer
@@ -438,6 +487,18 @@ papplSystemRun(pappl_system_t *system)	// I - System
       papplSystemAddLink(system, "Create TLS Certificate Request", "/tls-new-csr", PAPPL_LOPTIONS_OTHER | PAPPL_LOPTIONS_HTTPS_REQUIRED);
     }
 #endif // HAVE_GNUTLS
+
+    // Printer web pages are matched using each printer's URI name...
+    _papplSystemAddPrinterResourceCallback(system, "/", "text/html", (pappl_resource_cb_t)_papplPrinterWebHome);
+    _papplSystemAddPrinterResourceCallback(system, "/cancel", "text/html", (pappl_resource_cb_t)_papplPrinterWebCancelJob);
+    _papplSystemAddPrinterResourceCallback(system, "/cancelall", "text/html", (pappl_resource_cb_t)_papplPrinterWebCancelAllJobs);
+    if (system->options & PAPPL_SOPTIONS_MULTI_QUEUE)
+      _papplSystemAddPrinterResourceCallback(system, "/delete", "text/html", (pappl_resource_cb_t)_papplPrinterWebDelete);
+    _papplSystemAddPrinterResourceCallback(system, "/config", "text/html", (pappl_resource_cb_t)_papplPrinterWebConfig);
+    _papplSystemAddPrinterResourceCallback(system, "/jobs", "text/html", (pappl_resource_cb_t)_papplPrinterWebJobs);
+    _papplSystemAddPrinterResourceCallback(system, "/media", "text/html", (pappl_resource_cb_t)_papplPrinterWebMedia);
+    _papplSystemAddPrinterResourceCallback(system, "/printing", "text/html", (pappl_resource_cb_t)_papplPrinterWebDefaults);
+    _papplSystemAddPrinterResourceCallback(system, "/supplies", "text/html", (pappl_resource_cb_t)_papplPrinterWebSupplies);
   }
 
   // Catch important signals...
@@ -487,6 +548,19 @@ papplSystemRun(pappl_system_t *system)	// I - System
   if (system->dns_sd_name)
     _papplSystemRegisterDNSSDNoLock(system);
 
+  // Start the background save thread as needed...
+  if (system->save_cb)
+  {
+    system->save_active = true;
+
+    if (pthread_create(&system->save_thread, NULL, (void *(*)(void *))save_system, system))
+    {
+      // Unable to create save thread, save from the main loop instead...
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create save thread: %s", strerror(errno));
+      system->save_active = false;
+    }
+  }
+
   // Start up printers...
   for (printer = (pappl_printer_t *)cupsArrayFirst(system->printers); printer; printer = (pappl_printer_t *)cupsArrayNext(system->printers))
   {
@@ -601,7 +675,21 @@ papplSystemRun(pappl_system_t *system)	// I - System
       pthread_rwlock_unlock(&system->rwlock);
     }
 
-    if (system->config_changes > system->save_changes)
+    if (system->save_active)
+    {
+      // Wake the save thread for changes that were made without signalling
+      // and for shutdown requests...
+      pthread_mutex_lock(&system->config_mutex);
+
+      if (system->config_changes > system->save_changes && (system->config_changes != signalled_changes || system->shutdown_time || sigterm_time))
+      {
+        signalled_changes = system->config_changes;
+        pthread_cond_broadcast(&system->config_cond);
+      }
+
+      pthread_mutex_unlock(&system->config_mutex);
+    }
+    else if (system->config_changes > system->save_changes)
     {
       pthread_mutex_lock(&system->config_mutex);
 
@@ -642,9 +730,8 @@ papplSystemRun(pappl_system_t *system)	// I - System
         break;
     }
 
-    // Clean out old jobs...
-    if (system->clean_time && time(NULL) >= system->clean_time)
-      papplSystemCleanJobs(system);
+    // Expire old jobs...
+    _papplSystemCleanJobs(system);
   }
 
   papplLog(system, PAPPL_LOGLEVEL_INFO, "Shutting down system.");
@@ -662,6 +749,17 @@ papplSystemRun(pappl_system_t *system)	// I - System
       _papplPrinterUnregisterDNSSDNoLock(printer);
   }
 
+  if (system->save_active)
+  {
+    // Stop the background save thread...
+    pthread_mutex_lock(&system->config_mutex);
+    system->save_active = false;
+    pthread_cond_broadcast(&system->config_cond);
+    pthread_mutex_unlock(&system->config_mutex);
+
+    pthread_join(system->save_thread, NULL);
+  }
+
   if (system->save_changes < system->config_changes && system->save_cb)
   {
     // Save the configuration...
@@ -682,7 +780,8 @@ papplSystemRun(pappl_system_t *system)	// I - System
 // 'papplSystemShutdown()' - Shutdown the system.
 //
 // This function tells the system to perform an orderly shutdown of all printers
-// and to terminate the main loop.
+// and to terminate the main loop.  Any pending configuration changes are saved
+// immediately.
 //
 
 void
@@ -690,7 +789,14 @@ papplSystemShutdown(
     pappl_system_t *system)		// I - System
 {
   if (system && !system->shutdown_time)
+  {
     system->shutdown_time = time(NULL);
+
+    pthread_mutex_lock(&system->config_mutex);
+    system->save_now = true;
+    pthread_cond_broadcast(&system->config_cond);
+    pthread_mutex_unlock(&system->config_mutex);
+  }
 }
 
 
@@ -776,6 +882,85 @@ make_attributes(pappl_system_t *system)	// I - System
 }
 
 
+//
+// 'save_system()' - Save configuration changes in the background.
+//
+// Bursts of changes are coalesced into a single save once no new changes have
+// been made for "save_delay" seconds, but a save is never deferred more than
+// "save_max_delay" seconds after the first unsaved change.
+//
+
+static void *				// O - Thread exit status
+save_system(pappl_system_t *system)	// I - System
+{
+  size_t		seen_changes = 0,
+					// Last change count seen
+			changes;	// Change count being saved
+  time_t		curtime,	// Current time
+			first_time = 0,	// Time of first unsaved change
+			last_time = 0;	// Time of last change
+  struct timespec	timeout;	// Wait timeout
+
+
+  pthread_mutex_lock(&system->config_mutex);
+
+  while (system->save_active)
+  {
+    curtime = time(NULL);
+
+    if (system->config_changes > system->save_changes)
+    {
+      // Some changes are made without signalling, so track them here...
+      if (system->config_changes != seen_changes)
+      {
+        seen_changes = system->config_changes;
+        last_time    = curtime;
+
+        if (!first_time)
+          first_time = curtime;
+      }
+
+      if (system->save_now || system->shutdown_time || sigterm_time || curtime >= (last_time + system->save_delay) || curtime >= (first_time + system->save_max_delay))
+      {
+        // Save the configuration without holding the mutex...
+        changes          = system->config_changes;
+        system->save_now = false;
+
+        pthread_mutex_unlock(&system->config_mutex);
+
+        (system->save_cb)(system, system->save_cbdata);
+
+        pthread_mutex_lock(&system->config_mutex);
+
+        system->save_changes = changes;
+        first_time           = 0;
+        continue;
+      }
+
+      // Wait until the save is due or more changes are made...
+      timeout.tv_sec  = last_time + system->save_delay;
+      timeout.tv_nsec = 0;
+
+      if (timeout.tv_sec > (first_time + system->save_max_delay))
+        timeout.tv_sec = first_time + system->save_max_delay;
+
+      pthread_cond_timedwait(&system->config_cond, &system->config_mutex, &timeout);
+    }
+    else
+    {
+      // Nothing to save, wait for the next change...
+      system->save_now = false;
+
+      pthread_cond_wait(&system->config_cond, &system->config_mutex);
+    }
+  }
+
+  pthread_mutex_unlock(&system->config_mutex);
+
+  return (NULL);
+}
+
+
 //
 // 'sighup_handler()' - SIGHUP handler
 //
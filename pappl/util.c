@@ -17,11 +17,24 @@
 #endif // HAVE_SYS_RANDOM_H
 
 
+//
+// Local globals...
+//
+
+static const char * const attr_names[] =
+{					// Attribute names for IDs (sorted)
+#define _PAPPL_ATTR(id,name) name,
+  _PAPPL_ATTRS
+#undef _PAPPL_ATTR
+};
+
+
 //
 // Local functions...
 //
 
-static int	filter_cb(_pappl_ipp_filter_t *filter, ipp_t *dst, ipp_attribute_t *attr);
+static int		filter_cb(_pappl_ipp_filter_t *filter, ipp_t *dst, ipp_attribute_t *attr);
+static _pappl_ra_t	*make_requested(cups_array_t *names);
 
 
 //
@@ -60,7 +73,7 @@ void
 _papplCopyAttributes(
     ipp_t        *to,			// I - Destination request
     ipp_t        *from,			// I - Source request
-    cups_array_t *ra,			// I - Requested attributes
+    _pappl_ra_t  *ra,			// I - Requested attributes or `NULL` for all
     ipp_tag_t    group_tag,		// I - Group to copy
     int          quickcopy)		// I - Do a quick copy?
 {
@@ -74,6 +87,78 @@ _papplCopyAttributes(
 }
 
 
+//
+// '_papplCreateRequested()' - Compile the "requested-attributes" in a request.
+//
+// "ra" is set to `NULL` when all attributes are requested.  `false` is
+// returned if the requested attributes cannot be allocated.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplCreateRequested(
+    ipp_t       *request,		// I - IPP request
+    _pappl_ra_t **ra)			// O - Requested attributes or `NULL` for all
+{
+  cups_array_t	*names;			// Requested attribute names
+
+
+  // ippCreateRequestedArray expands the group keywords for us...
+  if ((names = ippCreateRequestedArray(request)) == NULL)
+  {
+    *ra = NULL;
+    return (true);
+  }
+
+  return ((*ra = make_requested(names)) != NULL);
+}
+
+
+//
+// '_papplCreateRequestedNames()' - Compile a list of attribute names.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplCreateRequestedNames(
+    size_t            num_names,	// I - Number of names
+    const char * const *names,		// I - Names
+    _pappl_ra_t       **ra)		// O - Requested attributes
+{
+  cups_array_t	*array;			// Requested attribute names
+
+
+  if ((array = cupsArrayNew((cups_array_func_t)strcmp, NULL)) == NULL)
+  {
+    *ra = NULL;
+    return (false);
+  }
+
+  while (num_names > 0)
+  {
+    cupsArrayAdd(array, (void *)*names);
+
+    names ++;
+    num_names --;
+  }
+
+  return ((*ra = make_requested(array)) != NULL);
+}
+
+
+//
+// '_papplDeleteRequested()' - Free compiled "requested-attributes" values.
+//
+
+void
+_papplDeleteRequested(_pappl_ra_t *ra)	// I - Requested attributes
+{
+  if (ra)
+  {
+    cupsArrayDelete(ra->names);
+    free(ra);
+  }
+}
+
+
 //
 // '_papplGetRand()' - Return the best 32-bit random number we can.
 //
@@ -133,8 +218,50 @@ filter_cb(_pappl_ipp_filter_t *filter,	// I - Filter parameters
   ipp_tag_t group = ippGetGroupTag(attr);
   const char *name = ippGetName(attr);
 
-  if ((filter->group_tag != IPP_TAG_ZERO && group != filter->group_tag && group != IPP_TAG_ZERO) || !name || (!strcmp(name, "media-col-database") && !cupsArrayFind(filter->ra, (void *)name)))
+  if ((filter->group_tag != IPP_TAG_ZERO && group != filter->group_tag && group != IPP_TAG_ZERO) || !name || ((!filter->ra || !_PAPPL_REQUESTED(filter->ra, _PAPPL_ATTR_MEDIA_COL_DATABASE)) && !strcmp(name, "media-col-database")))
     return (0);
 
-  return (!filter->ra || cupsArrayFind(filter->ra, (void *)name) != NULL);
+  return (!filter->ra || cupsArrayFind(filter->ra->names, (void *)name) != NULL);
+}
+
+
+//
+// 'make_requested()' - Build the attribute ID bitset for the requested names.
+//
+// Both the names array and the attribute ID table are sorted, so a single
+// merge pass finds all of the matches.
+//
+
+static _pappl_ra_t *			// O - Requested attributes or `NULL` on error
+make_requested(cups_array_t *names)	// I - Requested attribute names
+{
+  _pappl_ra_t	*ra;			// Requested attributes
+  const char	*name;			// Current name
+  size_t	id;			// Current attribute ID
+  int		diff;			// Comparison result
+
+
+  if ((ra = calloc(1, sizeof(_pappl_ra_t))) == NULL)
+  {
+    cupsArrayDelete(names);
+    return (NULL);
+  }
+
+  ra->names = names;
+
+  for (name = (const char *)cupsArrayFirst(names), id = 0; name && id < _PAPPL_ATTR_MAX;)
+  {
+    if ((diff = strcmp(name, attr_names[id])) == 0)
+    {
+      ra->ids[id / 8] |= 1 << (id & 7);
+      name = (const char *)cupsArrayNext(names);
+      id ++;
+    }
+    else if (diff < 0)
+      name = (const char *)cupsArrayNext(names);
+    else
+      id ++;
+  }
+
+  return (ra);
 }
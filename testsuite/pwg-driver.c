@@ -26,6 +26,7 @@ typedef struct pwg_s
 {
   cups_raster_t	*ras;			// PWG raster file
   size_t	colorants[4];		// Color usage
+  unsigned	lines;			// Lines written for the current page
 } pwg_job_data_t;
 
 
@@ -85,6 +86,7 @@ static bool	pwg_rendjob(pappl_job_t *job, pappl_pr_options_t *options, pappl_dev
 static bool	pwg_rendpage(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device, unsigned page);
 static bool	pwg_rstartjob(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device);
 static bool	pwg_rstartpage(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device, unsigned page);
+static bool	pwg_rwriteblank(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device, unsigned y, unsigned count);
 static bool	pwg_rwriteline(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device, unsigned y, const unsigned char *line);
 static bool	pwg_status(pappl_printer_t *printer);
 static const char *pwg_testpage(pappl_printer_t *printer, char *buffer, size_t bufsize);
@@ -441,6 +443,21 @@ pwg_callback(
 }
 
 
+//
+// 'pwg_create()' - Printer creation callback.
+//
+
+void
+pwg_create(
+    pappl_printer_t *printer,		// I - Printer
+    void            *data)		// I - Callback data (not used)
+{
+  (void)data;
+
+  papplPrinterSetWriteBlankCallback(printer, pwg_rwriteblank);
+}
+
+
 //
 // 'pwg_identify()' - Identify the printer.
 //
@@ -543,7 +560,12 @@ pwg_rendpage(
 
 
   (void)device;
-  (void)page;
+
+  if (pwg->lines != options->header.cupsHeight && !papplJobIsCanceled(job))
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Page %u has %u lines, expected %u.", page, pwg->lines, options->header.cupsHeight);
+    return (false);
+  }
 
   if (papplPrinterGetSupplies(printer, 5, supplies) == 5)
   {
@@ -638,11 +660,53 @@ pwg_rstartpage(
   (void)page;
 
   memset(pwg->colorants, 0, sizeof(pwg->colorants));
+  pwg->lines = 0;
 
   return (cupsRasterWriteHeader2(pwg->ras, &options->header) != 0);
 }
 
 
+//
+// 'pwg_rwriteblank()' - Write blank raster lines.
+//
+
+static bool				// O - `true` on success, `false` on failure
+pwg_rwriteblank(
+    pappl_job_t        *job,		// I - Job
+    pappl_pr_options_t *options,	// I - Job options
+    pappl_device_t     *device,		// I - Print device (unused)
+    unsigned           y,		// I - First line number
+    unsigned           count)		// I - Number of lines
+{
+  pwg_job_data_t	*pwg = (pwg_job_data_t *)papplJobGetData(job);
+					// PWG driver data
+  unsigned char		*line;		// Blank line
+  bool			ret = true;	// Return value
+
+
+  (void)device;
+  (void)y;
+
+  if ((line = malloc(options->header.cupsBytesPerLine)) == NULL)
+    return (false);
+
+  if (options->header.cupsColorSpace == CUPS_CSPACE_K || options->header.cupsColorSpace == CUPS_CSPACE_CMYK)
+    memset(line, 0x00, options->header.cupsBytesPerLine);
+  else
+    memset(line, 0xff, options->header.cupsBytesPerLine);
+
+  for (; count > 0 && ret; count --)
+  {
+    ret = cupsRasterWritePixels(pwg->ras, line, options->header.cupsBytesPerLine) != 0;
+    pwg->lines ++;
+  }
+
+  free(line);
+
+  return (ret);
+}
+
+
 //
 // 'pwg_rwriteline()' - Write a raster line.
 //
@@ -663,6 +727,8 @@ pwg_rwriteline(
   (void)device;
   (void)y;
 
+  pwg->lines ++;
+
   // Add the colorant usage for this line (for simulation purposes - normally
   // this is tracked by the printer/ink cartridge...)
   lineend = line + options->header.cupsBytesPerLine;
@@ -36,6 +36,7 @@
 //   jpeg                 JPEG image tests
 //   png                  PNG image tests
 //   pwg-raster           PWG Raster tests
+//   snapshot             System state snapshot tests
 //
 
 //
@@ -43,6 +44,7 @@
 //
 
 #include <pappl/base-private.h>
+#include <pappl/job-private.h>		// For aging jobs in the Get-Jobs tests
 #include <cups/dir.h>
 #include "testpappl.h"
 #include <stdlib.h>
@@ -70,7 +72,8 @@ typedef struct _pappl_testdata_s	// Test data
 typedef struct _pappl_testprinter_s	// Printer test data
 {
   bool			pass;		// Pass/fail
-  int			count;		// Number of printers
+  int			count,		// Number of printers
+			jobs;		// Number of jobs
 } _pappl_testprinter_t;
 
 
@@ -81,6 +84,8 @@ typedef struct _pappl_testprinter_s	// Printer test data
 static http_t	*connect_to_printer(pappl_system_t *system, char *uri, size_t urisize);
 static void	device_error_cb(const char *message, void *err_data);
 static bool	device_list_cb(const char *device_info, const char *device_uri, const char *device_id, void *data);
+static int	find_event(ipp_t *response, const char *event, int job_id);
+static int	get_jobs(http_t *http, const char *username, const char *which_jobs, bool my_jobs, int first_index, int limit, int num_ids, const int *ids, int *jobs, int max_jobs);
 static const char *make_raster_file(ipp_t *response, bool grayscale, char *tempname, size_t tempsize);
 static void	*run_tests(_pappl_testdata_t *testdata);
 static bool	test_api(pappl_system_t *system);
@@ -91,6 +96,8 @@ static bool	test_client(pappl_system_t *system);
 static bool	test_image_files(pappl_system_t *system, const char *prompt, const char *format, int num_files, const char * const *files);
 #endif // HAVE_LIBJPEG || HAVE_LIBPNG
 static bool	test_pwg_raster(pappl_system_t *system);
+static bool	test_snapshot(pappl_system_t *system);
+static bool	test_snapshot_cb(pappl_printer_t *printer, _pappl_testprinter_t *tp);
 static int	usage(int status);
 
 
@@ -303,6 +310,7 @@ main(int  argc,				// I - Number of command-line arguments
 		cupsArrayAdd(testdata.names, "jpeg");
 		cupsArrayAdd(testdata.names, "png");
 		cupsArrayAdd(testdata.names, "pwg-raster");
+		cupsArrayAdd(testdata.names, "snapshot");
 	      }
 	      else
 	      {
@@ -336,7 +344,7 @@ main(int  argc,				// I - Number of command-line arguments
   // Initialize the system and any printers...
   system = papplSystemCreate(soptions, name ? name : "Test System", port, "_print,_universal", spool, log, level, auth, tls_only);
   papplSystemAddListeners(system, NULL);
-  papplSystemSetPrinterDrivers(system, (int)(sizeof(pwg_drivers) / sizeof(pwg_drivers[0])), pwg_drivers, pwg_autoadd, /* create_cb */NULL, pwg_callback, "testpappl");
+  papplSystemSetPrinterDrivers(system, (int)(sizeof(pwg_drivers) / sizeof(pwg_drivers[0])), pwg_drivers, pwg_autoadd, pwg_create, pwg_callback, "testpappl");
   papplSystemAddLink(system, "Configuration", "/config", true);
   papplSystemSetFooterHTML(system,
                            "Copyright &copy; 2020-2021 by Michael R Sweet. "
@@ -486,6 +494,106 @@ device_list_cb(const char *device_info,	// I - Device description
 }
 
 
+//
+// 'find_event()' - Find an event notification in a Get-Notifications response.
+//
+
+static int				// O - "notify-sequence-number" value or `0` if not found
+find_event(ipp_t      *response,	// I - Get-Notifications response
+           const char *event,		// I - "notify-subscribed-event" value
+           int        job_id)		// I - "notify-job-id" value
+{
+  ipp_attribute_t	*attr;		// Current attribute
+  const char		*name;		// Attribute name
+  const char		*ev_event = NULL;// "notify-subscribed-event" value
+  int			ev_job_id = 0,	// "notify-job-id" value
+			ev_seq = 0;	// "notify-sequence-number" value
+
+
+  for (attr = ippFirstAttribute(response); attr; attr = ippNextAttribute(response))
+  {
+    if ((name = ippGetName(attr)) == NULL)
+    {
+      // End of an event notification group...
+      if (ev_event && !strcmp(ev_event, event) && ev_job_id == job_id)
+        return (ev_seq);
+
+      ev_event  = NULL;
+      ev_job_id = 0;
+      ev_seq    = 0;
+    }
+    else if (ippGetGroupTag(attr) != IPP_TAG_EVENT_NOTIFICATION)
+      continue;
+    else if (!strcmp(name, "notify-subscribed-event"))
+      ev_event = ippGetString(attr, 0, NULL);
+    else if (!strcmp(name, "notify-job-id"))
+      ev_job_id = ippGetInteger(attr, 0);
+    else if (!strcmp(name, "notify-sequence-number"))
+      ev_seq = ippGetInteger(attr, 0);
+  }
+
+  if (ev_event && !strcmp(ev_event, event) && ev_job_id == job_id)
+    return (ev_seq);
+  else
+    return (0);
+}
+
+
+//
+// 'get_jobs()' - Send a Get-Jobs request and return the "job-id" values.
+//
+
+static int				// O - Number of jobs or `-1` on error
+get_jobs(http_t     *http,		// I - HTTP connection
+         const char *username,		// I - "requesting-user-name" value
+         const char *which_jobs,	// I - "which-jobs" value
+         bool       my_jobs,		// I - "my-jobs" value
+         int        first_index,	// I - "first-index" value or `-1` for none
+         int        limit,		// I - "limit" value or `0` for none
+         int        num_ids,		// I - Number of "job-ids" values
+         const int  *ids,		// I - "job-ids" values
+         int        *jobs,		// O - "job-id" values
+         int        max_jobs)		// I - Size of "job-id" array
+{
+  ipp_t			*request,	// Get-Jobs request
+			*response;	// Get-Jobs response
+  ipp_attribute_t	*attr;		// "job-id" attribute
+  int			num_jobs = 0;	// Number of jobs
+
+
+  request = ippNewRequest(IPP_OP_GET_JOBS);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, username);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD, "which-jobs", NULL, which_jobs);
+  if (my_jobs)
+    ippAddBoolean(request, IPP_TAG_OPERATION, "my-jobs", 1);
+  if (first_index >= 0)
+    ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "first-index", first_index);
+  if (limit > 0)
+    ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "limit", limit);
+  if (num_ids > 0)
+    ippAddIntegers(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-ids", num_ids, ids);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD, "requested-attributes", NULL, "job-id");
+
+  response = cupsDoRequest(http, request, "/ipp/print");
+
+  for (attr = ippFindAttribute(response, "job-id", IPP_TAG_INTEGER); attr; attr = ippFindNextAttribute(response, "job-id", IPP_TAG_INTEGER))
+  {
+    if (num_jobs < max_jobs)
+      jobs[num_jobs] = ippGetInteger(attr, 0);
+
+    num_jobs ++;
+  }
+
+  ippDelete(response);
+
+  if (cupsLastError() != IPP_STATUS_OK)
+    return (-1);
+  else
+    return (num_jobs);
+}
+
+
 //
 // 'make_raster_file()' - Create a temporary PWG raster file.
 //
@@ -821,6 +929,13 @@ run_tests(_pappl_testdata_t *testdata)	// I - Testing data
       else
         puts("PASS");
     }
+    else if (!strcmp(name, "snapshot"))
+    {
+      if (!test_snapshot(testdata->system))
+        ret = (void *)1;
+      else
+        puts("PASS");
+    }
     else
     {
       puts("UNKNOWN TEST");
@@ -895,6 +1010,12 @@ test_api(pappl_system_t *system)	// I - System
     { "Great Barrier Reef",           "geo:-16.7546653,143.8322946" },
     { "Science North",                "geo:46.4707,-80.9961" }
   };
+  static const char * const attr_names[] =
+  {					// Requested attribute names for IDs
+#define _PAPPL_ATTR(id,name) name,
+    _PAPPL_ATTRS
+#undef _PAPPL_ATTR
+  };
   static const char * const set_loglevels[] =
   {					// Log level constants
     "UNSPEC",
@@ -1665,6 +1786,50 @@ test_api(pappl_system_t *system)	// I - System
     }
   }
 
+  // _papplCreateRequestedNames
+  fputs("api: _papplCreateRequestedNames: ", stdout);
+
+  for (i = 0; i <= _PAPPL_ATTR_MAX; i ++)
+  {
+    _pappl_ra_t	*ra;			// Requested attributes
+
+    if (i > 0 && i < _PAPPL_ATTR_MAX && strcmp(attr_names[i - 1], attr_names[i]) >= 0)
+    {
+      printf("FAIL ('%s' is not sorted after '%s')\n", attr_names[i], attr_names[i - 1]);
+      pass = false;
+      break;
+    }
+
+    // Request each attribute by itself and then all of them at once...
+    if (!_papplCreateRequestedNames(i < _PAPPL_ATTR_MAX ? 1 : _PAPPL_ATTR_MAX, i < _PAPPL_ATTR_MAX ? attr_names + i : attr_names, &ra))
+    {
+      puts("FAIL (unable to allocate requested attributes)");
+      pass = false;
+      break;
+    }
+
+    for (j = 0; j < _PAPPL_ATTR_MAX; j ++)
+    {
+      if ((_PAPPL_REQUESTED(ra, j) != 0) != (i == j || i == _PAPPL_ATTR_MAX))
+        break;
+    }
+
+    _papplDeleteRequested(ra);
+
+    if (j < _PAPPL_ATTR_MAX)
+    {
+      if (i < _PAPPL_ATTR_MAX)
+        printf("FAIL (wrong attribute ID for '%s')\n", attr_names[i]);
+      else
+        printf("FAIL (attribute ID for '%s' not set)\n", attr_names[j]);
+      pass = false;
+      break;
+    }
+  }
+
+  if (i > _PAPPL_ATTR_MAX)
+    puts("PASS");
+
   // papplSystemIteratePrinters
   fputs("api: papplSystemIteratePrinters: ", stdout);
 
@@ -2106,11 +2271,28 @@ test_api_printer_cb(
 static bool				// O - `true` on success, `false` on failure
 test_client(pappl_system_t *system)	// I - System
 {
-  http_t	*http;			// HTTP connection
+  http_t	*http,			// HTTP connection
+		*http2;			// Second HTTP connection
   char		uri[1024];		// "printer-uri" value
   ipp_t		*request,		// Request
 		*response;		// Response
-  int		i;			// Looping var
+  ipp_attribute_t *attr;		// Current attribute
+  http_status_t	status;			// HTTP status
+  int		i, j,			// Looping vars
+		sub_id,			// "notify-subscription-id" value
+		psub_id,		// "notify-subscription-id" value for printer events
+		job_id,			// "job-id" value
+		seq,			// Last "notify-sequence-number" value
+		created_seq,		// "job-created" sequence number
+		completed_seq;		// "job-completed" sequence number
+  time_t	start;			// Start time of request
+  pappl_printer_t *printer;		// Printer
+  pappl_job_t	*job;			// Job
+  int		max_completed,		// Maximum number of completed jobs
+		job_ids[4],		// Jobs for Get-Jobs tests
+		ids[2],			// "job-ids" values
+		jobs[10],		// Jobs returned by Get-Jobs
+		num_jobs;		// Number of jobs returned by Get-Jobs
   static const char * const pattrs[] =	// Printer attributes
   {
     "printer-contact-col",
@@ -2135,6 +2317,28 @@ test_client(pappl_system_t *system)	// I - System
     "system-uuid",
     "system-xri-supported"
   };
+  static const char * const events[] =	// "notify-events" values
+  {
+    "job-completed",
+    "job-created"
+  };
+  static const struct
+  {
+    const char	*name;			// Test name
+    const char	*which_jobs;		// "which-jobs" value
+    bool	my_jobs;		// "my-jobs" value
+    int		first_index,		// "first-index" value or `-1` for none
+		limit,			// "limit" value
+		expect[4];		// Expected jobs (index into job_ids) or `-1`
+  }		get_jobs_tests[] =	// Get-Jobs tests
+  {
+    { "limit=4", "all", false, -1, 4, { 3, 2, 1, 0 } },
+    { "first-index=2,limit=2", "all", false, 2, 2, { 2, 1, -1, -1 } },
+    { "first-index=3,limit=2", "all", false, 3, 2, { 1, 0, -1, -1 } },
+    { "completed,first-index=2,limit=1", "completed", false, 2, 1, { 1, -1, -1, -1 } },
+    { "my-jobs,limit=2", "all", true, -1, 2, { 3, 2, -1, -1 } },
+    { "my-jobs,first-index=2,limit=2", "all", true, 2, 2, { 2, 1, -1, -1 } }
+  };
 
 
   // Connect to system...
@@ -2272,6 +2476,476 @@ test_client(pappl_system_t *system)	// I - System
     ippDelete(response);
   }
 
+  // Test HEAD on / - HTML pages must get a response without a body...
+  fputs("\nclient: HEAD / ", stdout);
+
+  httpClearFields(http);
+  httpSetTimeout(http, 10.0, NULL, NULL);
+
+  if (httpHead(http, "/"))
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+
+  while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE);
+
+  if (status != HTTP_STATUS_OK)
+  {
+    printf("FAIL (Got '%s', expected '200 OK')\n", httpStatus(status));
+    httpClose(http);
+    return (false);
+  }
+  else if (strcmp(httpGetField(http, HTTP_FIELD_CONTENT_TYPE), "text/html"))
+  {
+    printf("FAIL (Got Content-Type '%s', expected 'text/html')\n", httpGetField(http, HTTP_FIELD_CONTENT_TYPE));
+    httpClose(http);
+    return (false);
+  }
+
+  // Test Create-Printer-Subscriptions on /ipp/print
+  fputs("\nclient: Create-Printer-Subscriptions=/ipp/print ", stdout);
+
+  request = ippNewRequest(IPP_OP_CREATE_PRINTER_SUBSCRIPTIONS);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+  ippAddString(request, IPP_TAG_SUBSCRIPTION, IPP_TAG_KEYWORD, "notify-pull-method", NULL, "ippget");
+  ippAddStrings(request, IPP_TAG_SUBSCRIPTION, IPP_TAG_KEYWORD, "notify-events", (int)(sizeof(events) / sizeof(events[0])), NULL, events);
+
+  response = cupsDoRequest(http, request, "/ipp/print");
+  sub_id   = ippGetInteger(ippFindAttribute(response, "notify-subscription-id", IPP_TAG_INTEGER), 0);
+
+  ippDelete(response);
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+  else if (sub_id <= 0)
+  {
+    puts("FAIL (Missing 'notify-subscription-id' attribute in response)");
+    httpClose(http);
+    return (false);
+  }
+
+  // Add a second subscription for printer events, which must not affect the
+  // sequence numbers of the first subscription...
+  request = ippNewRequest(IPP_OP_CREATE_PRINTER_SUBSCRIPTIONS);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+  ippAddString(request, IPP_TAG_SUBSCRIPTION, IPP_TAG_KEYWORD, "notify-pull-method", NULL, "ippget");
+  ippAddString(request, IPP_TAG_SUBSCRIPTION, IPP_TAG_KEYWORD, "notify-events", NULL, "printer-state-changed");
+
+  response = cupsDoRequest(http, request, "/ipp/print");
+  psub_id  = ippGetInteger(ippFindAttribute(response, "notify-subscription-id", IPP_TAG_INTEGER), 0);
+
+  ippDelete(response);
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+  else if (psub_id <= 0 || psub_id == sub_id)
+  {
+    printf("FAIL (Got 'notify-subscription-id' %d for second subscription)\n", psub_id);
+    httpClose(http);
+    return (false);
+  }
+
+  // Test Get-Notifications on /ipp/print
+  fputs("\nclient: Get-Notifications=/ipp/print ", stdout);
+
+  request = ippNewRequest(IPP_OP_GET_NOTIFICATIONS);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-subscription-ids", sub_id);
+
+  response = cupsDoRequest(http, request, "/ipp/print");
+
+  for (seq = 0, attr = ippFindAttribute(response, "notify-sequence-number", IPP_TAG_INTEGER); attr; attr = ippFindNextAttribute(response, "notify-sequence-number", IPP_TAG_INTEGER))
+  {
+    if (ippGetInteger(attr, 0) > seq)
+      seq = ippGetInteger(attr, 0);
+  }
+
+  ippDelete(response);
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+
+  // Test Get-Notifications with "notify-wait" on /ipp/print - the request
+  // needs to return as soon as the "job-created" event from a second
+  // connection is recorded, not when the wait times out...
+  fputs("\nclient: Get-Notifications(notify-wait)=/ipp/print ", stdout);
+
+  request = ippNewRequest(IPP_OP_GET_NOTIFICATIONS);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-subscription-ids", sub_id);
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-sequence-numbers", seq + 1);
+  ippAddBoolean(request, IPP_TAG_OPERATION, "notify-wait", 1);
+
+  start = time(NULL);
+
+  if (cupsSendRequest(http, request, "/ipp/print", 0) != HTTP_STATUS_CONTINUE)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    ippDelete(request);
+    httpClose(http);
+    return (false);
+  }
+
+  if ((http2 = connect_to_printer(system, uri, sizeof(uri))) == NULL)
+  {
+    printf("FAIL (Unable to connect: %s)\n", cupsLastErrorString());
+    ippDelete(request);
+    httpClose(http);
+    return (false);
+  }
+
+  ippDelete(request);
+
+  request = ippNewRequest(IPP_OP_CREATE_JOB);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, "Notify Test");
+
+  response = cupsDoRequest(http2, request, "/ipp/print");
+  job_id   = ippGetInteger(ippFindAttribute(response, "job-id", IPP_TAG_INTEGER), 0);
+
+  ippDelete(response);
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (Create-Job: %s)\n", cupsLastErrorString());
+    httpClose(http);
+    httpClose(http2);
+    return (false);
+  }
+  else if (job_id <= 0)
+  {
+    puts("FAIL (Missing 'job-id' attribute in Create-Job response)");
+    httpClose(http);
+    httpClose(http2);
+    return (false);
+  }
+
+  response    = cupsGetResponse(http, "/ipp/print");
+  created_seq = find_event(response, "job-created", job_id);
+
+  ippDelete(response);
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    httpClose(http2);
+    return (false);
+  }
+  else if ((time(NULL) - start) >= 10)
+  {
+    printf("FAIL (Took %d seconds to return the event)\n", (int)(time(NULL) - start));
+    httpClose(http);
+    httpClose(http2);
+    return (false);
+  }
+  else if (created_seq <= seq)
+  {
+    printf("FAIL (Got 'notify-sequence-number' %d for 'job-created' event, expected more than %d)\n", created_seq, seq);
+    httpClose(http);
+    httpClose(http2);
+    return (false);
+  }
+
+  // Cancel the job and make sure the "job-completed" event follows the
+  // "job-created" event, with printer events for the second subscription in
+  // between...
+  fputs("\nclient: Get-Notifications(job-completed)=/ipp/print ", stdout);
+
+  printer = papplSystemFindPrinter(system, "/ipp/print", 0, NULL);
+
+  papplPrinterSetReasons(printer, PAPPL_PREASON_OTHER, PAPPL_PREASON_NONE);
+  papplPrinterSetReasons(printer, PAPPL_PREASON_NONE, PAPPL_PREASON_OTHER);
+
+  request = ippNewRequest(IPP_OP_CANCEL_JOB);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-id", job_id);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+
+  ippDelete(cupsDoRequest(http2, request, "/ipp/print"));
+  httpClose(http2);
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (Cancel-Job: %s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+
+  request = ippNewRequest(IPP_OP_GET_NOTIFICATIONS);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-subscription-ids", sub_id);
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-sequence-numbers", created_seq + 1);
+
+  response      = cupsDoRequest(http, request, "/ipp/print");
+  seq           = ippGetInteger(ippFindAttribute(response, "notify-sequence-number", IPP_TAG_INTEGER), 0);
+  completed_seq = find_event(response, "job-completed", job_id);
+
+  ippDelete(response);
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+  else if (seq != created_seq + 1)
+  {
+    printf("FAIL (Got 'notify-sequence-number' %d for first event, expected %d)\n", seq, created_seq + 1);
+    httpClose(http);
+    return (false);
+  }
+  else if (completed_seq != created_seq + 1)
+  {
+    printf("FAIL (Got 'notify-sequence-number' %d for 'job-completed' event, expected %d)\n", completed_seq, created_seq + 1);
+    httpClose(http);
+    return (false);
+  }
+
+  // The printer events have their own sequence numbers starting at 1...
+  fputs("\nclient: Get-Notifications(printer-state-changed)=/ipp/print ", stdout);
+
+  request = ippNewRequest(IPP_OP_GET_NOTIFICATIONS);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-subscription-ids", psub_id);
+
+  response = cupsDoRequest(http, request, "/ipp/print");
+
+  for (seq = 0, attr = ippFindAttribute(response, "notify-sequence-number", IPP_TAG_INTEGER); attr; attr = ippFindNextAttribute(response, "notify-sequence-number", IPP_TAG_INTEGER))
+  {
+    if (ippGetInteger(attr, 0) != seq + 1)
+      break;
+
+    seq ++;
+  }
+
+  ippDelete(response);
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+  else if (attr)
+  {
+    printf("FAIL (Got 'notify-sequence-number' %d, expected %d)\n", ippGetInteger(attr, 0), seq + 1);
+    httpClose(http);
+    return (false);
+  }
+  else if (seq < 2)
+  {
+    printf("FAIL (Got %d 'printer-state-changed' events, expected at least 2)\n", seq);
+    httpClose(http);
+    return (false);
+  }
+
+  // Test Cancel-Subscription on /ipp/print
+  fputs("\nclient: Cancel-Subscription=/ipp/print ", stdout);
+
+  request = ippNewRequest(IPP_OP_CANCEL_SUBSCRIPTION);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-subscription-id", sub_id);
+
+  ippDelete(cupsDoRequest(http, request, "/ipp/print"));
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+
+  request = ippNewRequest(IPP_OP_CANCEL_SUBSCRIPTION);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-subscription-id", psub_id);
+
+  ippDelete(cupsDoRequest(http, request, "/ipp/print"));
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+
+  // Create jobs for the Get-Jobs tests - the three oldest are canceled, and
+  // the two oldest of those are aged and moved to the job history archive so
+  // that the results span active, completed, and archived jobs...
+  fputs("\nclient: Get-Jobs(setup)=/ipp/print ", stdout);
+
+  printer = papplSystemFindPrinter(system, "/ipp/print", 0, NULL);
+
+  for (i = 0; i < 4; i ++)
+  {
+    request = ippNewRequest(IPP_OP_CREATE_JOB);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, "Get-Jobs Test");
+
+    response   = cupsDoRequest(http, request, "/ipp/print");
+    job_ids[i] = ippGetInteger(ippFindAttribute(response, "job-id", IPP_TAG_INTEGER), 0);
+
+    ippDelete(response);
+
+    if (cupsLastError() != IPP_STATUS_OK || job_ids[i] <= 0)
+    {
+      printf("FAIL (Create-Job: %s)\n", cupsLastErrorString());
+      httpClose(http);
+      return (false);
+    }
+
+    if (i == 3)
+      break;
+
+    // Only one job can be active, so cancel each job as we go...
+    request = ippNewRequest(IPP_OP_CANCEL_JOB);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+    ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-id", job_ids[i]);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+
+    ippDelete(cupsDoRequest(http, request, "/ipp/print"));
+
+    if (cupsLastError() != IPP_STATUS_OK)
+    {
+      printf("FAIL (Cancel-Job: %s)\n", cupsLastErrorString());
+      httpClose(http);
+      return (false);
+    }
+  }
+
+  for (i = 1; i < job_ids[2]; i ++)
+  {
+    if ((job = papplPrinterFindJob(printer, i)) != NULL && papplJobGetState(job) >= IPP_JSTATE_CANCELED)
+    {
+      pthread_rwlock_wrlock(&job->rwlock);
+      job->completed -= 120;
+      pthread_rwlock_unlock(&job->rwlock);
+    }
+  }
+
+  max_completed = papplPrinterGetMaxCompletedJobs(printer);
+  papplPrinterSetMaxCompletedJobs(printer, 1);
+  papplSystemCleanJobs(system);
+  papplPrinterSetMaxCompletedJobs(printer, max_completed);
+
+  if (papplPrinterFindJob(printer, job_ids[0]) || papplPrinterFindJob(printer, job_ids[1]) || !papplPrinterFindJob(printer, job_ids[2]))
+  {
+    puts("FAIL (Jobs were not archived)");
+    httpClose(http);
+    return (false);
+  }
+
+  // Test "first-index", "limit", and "my-jobs" across the active, completed,
+  // and archived jobs...
+  for (i = 0; i < (int)(sizeof(get_jobs_tests) / sizeof(get_jobs_tests[0])); i ++)
+  {
+    printf("\nclient: Get-Jobs(%s)=/ipp/print ", get_jobs_tests[i].name);
+
+    if ((num_jobs = get_jobs(http, cupsUser(), get_jobs_tests[i].which_jobs, get_jobs_tests[i].my_jobs, get_jobs_tests[i].first_index, get_jobs_tests[i].limit, 0, NULL, jobs, (int)(sizeof(jobs) / sizeof(jobs[0])))) < 0)
+    {
+      printf("FAIL (%s)\n", cupsLastErrorString());
+      httpClose(http);
+      return (false);
+    }
+
+    for (j = 0; j < 4 && get_jobs_tests[i].expect[j] >= 0; j ++)
+    {
+      if (j >= num_jobs || jobs[j] != job_ids[get_jobs_tests[i].expect[j]])
+        break;
+    }
+
+    if (j != num_jobs || (j < 4 && get_jobs_tests[i].expect[j] >= 0))
+    {
+      printf("FAIL (Got %d jobs starting with job-id %d, expected %d jobs starting with job-id %d)\n", num_jobs, num_jobs > 0 ? jobs[0] : 0, get_jobs_tests[i].limit, job_ids[get_jobs_tests[i].expect[0]]);
+      httpClose(http);
+      return (false);
+    }
+  }
+
+  // Test "job-ids" with an unknown job ID...
+  fputs("\nclient: Get-Jobs(job-ids)=/ipp/print ", stdout);
+
+  ids[0] = job_ids[3];
+  ids[1] = job_ids[3] + 1000;
+
+  if ((num_jobs = get_jobs(http, cupsUser(), "all", false, -1, 0, 2, ids, jobs, (int)(sizeof(jobs) / sizeof(jobs[0])))) < 0)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+  else if (num_jobs != 1 || jobs[0] != job_ids[3])
+  {
+    printf("FAIL (Got %d jobs, expected job-id %d only)\n", num_jobs, job_ids[3]);
+    httpClose(http);
+    return (false);
+  }
+
+  // Test "my-jobs" for a user without any jobs...
+  fputs("\nclient: Get-Jobs(my-jobs,no-jobs)=/ipp/print ", stdout);
+
+  if ((num_jobs = get_jobs(http, "no-such-user", "all", true, -1, 0, 0, NULL, jobs, (int)(sizeof(jobs) / sizeof(jobs[0])))) < 0)
+  {
+    printf("FAIL (%s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+  else if (num_jobs != 0)
+  {
+    printf("FAIL (Got %d jobs, expected 0)\n", num_jobs);
+    httpClose(http);
+    return (false);
+  }
+
+  // Test that "first-index" values less than 1 are rejected...
+  fputs("\nclient: Get-Jobs(first-index=0)=/ipp/print ", stdout);
+
+  if (get_jobs(http, cupsUser(), "all", false, 0, 0, 0, NULL, jobs, (int)(sizeof(jobs) / sizeof(jobs[0]))) >= 0 || cupsLastError() != IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES)
+  {
+    printf("FAIL (Got '%s', expected 'client-error-attributes-or-values-not-supported')\n", ippErrorString(cupsLastError()));
+    httpClose(http);
+    return (false);
+  }
+
+  // Cancel the last job so it doesn't hold up the printer...
+  request = ippNewRequest(IPP_OP_CANCEL_JOB);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-id", job_ids[3]);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsUser());
+
+  ippDelete(cupsDoRequest(http, request, "/ipp/print"));
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    printf("FAIL (Cancel-Job: %s)\n", cupsLastErrorString());
+    httpClose(http);
+    return (false);
+  }
+
   httpClose(http);
 
   return (true);
@@ -2535,6 +3209,12 @@ test_pwg_raster(pappl_system_t *system)	// I - System
     }
     while (job_state < IPP_JSTATE_CANCELED);
 
+    if (job_state != IPP_JSTATE_COMPLETED)
+    {
+      printf("FAIL (Job '%s' did not complete, job-state=%s)\n", job_name, ippEnumString("job-state", (int)job_state));
+      goto done;
+    }
+
     // Cleanup...
     unlink(filename);
   }
@@ -2554,6 +3234,106 @@ test_pwg_raster(pappl_system_t *system)	// I - System
 }
 
 
+//
+// 'test_snapshot()' - Run system state snapshot tests.
+//
+// The running system is saved to a snapshot that is then loaded into a new
+// system object using a separate spool directory.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_snapshot(pappl_system_t *system)	// I - System
+{
+  bool			ret = false;	// Return value
+  pappl_system_t	*snapsys = NULL;// Snapshot system
+  const char		*tmpdir;	// Temporary directory
+  char			filename[1024],	// Snapshot filename
+			spooldir[1024];	// Spool directory for snapshot system
+  _pappl_testprinter_t	saved,		// Saved printers and jobs
+			loaded;		// Loaded printers and jobs
+
+
+  if ((tmpdir = getenv("TMPDIR")) == NULL)
+    tmpdir = "/tmp";
+
+  snprintf(filename, sizeof(filename), "%s/testpappl%d.snapshot", tmpdir, (int)getpid());
+  snprintf(spooldir, sizeof(spooldir), "%s/testpappl%d.d", tmpdir, (int)getpid());
+
+  // Save a snapshot of the running system...
+  memset(&saved, 0, sizeof(saved));
+  papplSystemIteratePrinters(system, (pappl_printer_cb_t)test_snapshot_cb, &saved);
+
+  if (!papplSystemSaveSnapshot(system, filename))
+  {
+    puts("FAIL (unable to save snapshot)");
+    goto done;
+  }
+
+  // Then load it into a new system...
+  if ((snapsys = papplSystemCreate(papplSystemGetOptions(system), "Snapshot Test", 0, NULL, spooldir, NULL, PAPPL_LOGLEVEL_ERROR, NULL, false)) == NULL)
+  {
+    puts("FAIL (unable to create snapshot system)");
+    goto done;
+  }
+
+  papplSystemSetPrinterDrivers(snapsys, (int)(sizeof(pwg_drivers) / sizeof(pwg_drivers[0])), pwg_drivers, pwg_autoadd, pwg_create, pwg_callback, "testpappl");
+
+  if (!papplSystemLoadState(snapsys, filename))
+  {
+    puts("FAIL (unable to load snapshot)");
+    goto done;
+  }
+
+  memset(&loaded, 0, sizeof(loaded));
+  papplSystemIteratePrinters(snapsys, (pappl_printer_cb_t)test_snapshot_cb, &loaded);
+
+  if (loaded.count != saved.count)
+  {
+    printf("FAIL (got %d printers, expected %d)\n", loaded.count, saved.count);
+    goto done;
+  }
+  else if (loaded.jobs != saved.jobs)
+  {
+    printf("FAIL (got %d jobs, expected %d)\n", loaded.jobs, saved.jobs);
+    goto done;
+  }
+
+  // Only one snapshot can be loaded since the jobs use its string pool...
+  if (papplSystemLoadState(snapsys, filename))
+  {
+    puts("FAIL (second snapshot was loaded)");
+    goto done;
+  }
+
+  ret = true;
+
+  done:
+
+  papplSystemDelete(snapsys);
+
+  unlink(filename);
+  rmdir(spooldir);
+
+  return (ret);
+}
+
+
+//
+// 'test_snapshot_cb()' - Count the printers and jobs in a system.
+//
+
+static bool				// O - `true` to continue
+test_snapshot_cb(
+    pappl_printer_t      *printer,	// I - Printer
+    _pappl_testprinter_t *tp)		// I - Printer test data
+{
+  tp->count ++;
+  tp->jobs += papplPrinterGetNumberOfJobs(printer);
+
+  return (true);
+}
+
+
 //
 // 'usage()' - Show usage.
 //
@@ -2587,6 +3367,7 @@ usage(int status)			// I - Exit status
   puts("  jpeg                 JPEG image tests");
   puts("  png                  PNG image tests");
   puts("  pwg-raster           PWG Raster tests");
+  puts("  snapshot             System state snapshot tests");
 
   return (status);
 }
@@ -47,6 +47,7 @@ pappl_pr_driver_t pwg_drivers[11] =
 
 extern const char *pwg_autoadd(const char *device_info, const char *device_uri, const char *device_id, void *data);
 extern bool	pwg_callback(pappl_system_t *system, const char *driver_name, const char *device_uri, const char *device_id, pappl_pr_driver_data_t *driver_data, ipp_t **driver_attrs, void *data);
+extern void	pwg_create(pappl_printer_t *printer, void *data);
 
 
 #endif // !_TESTPAPPL_H_